@@ -59,6 +59,7 @@
 #define DXC_PART_INPUT_SIGNATURE          DXC_FOURCC('I', 'S', 'G', '1')
 #define DXC_PART_OUTPUT_SIGNATURE         DXC_FOURCC('O', 'S', 'G', '1')
 #define DXC_PART_PATCH_CONSTANT_SIGNATURE DXC_FOURCC('P', 'S', 'G', '1')
+#define DXC_PART_PIPELINE_STATE_VALIDATION DXC_FOURCC('P', 'S', 'V', '0')
 
 #define DXC_ARG_DEBUG                          L"-Zi"
 #define DXC_ARG_SKIP_VALIDATION                L"-Vd"
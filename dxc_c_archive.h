@@ -0,0 +1,576 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_archive.h                                                           //
+// Packed, memory-mappable shader archive indexed by shader hash             //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_ARCHIVE_C__
+#define __DXC_ARCHIVE_C__
+
+#include "dxc_c.h"
+#include "dxc_c_container.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX. An archive packs many DXIL containers into one file,
+// keyed by DxcShaderHash.HashDigest. The index is a bucketed hash table
+// (bucket offsets followed by entries sorted by bucket), so a lookup touches
+// one bucket of, on average, a single entry. Opening an archive is one mmap;
+// every view returned afterwards borrows from that mapping.
+//
+// By default each container is stored contiguously, so DxcArchive_GetContainer
+// returns it without copying, and byte-identical containers are stored once.
+// With DedupParts every part is stored once across the whole archive (shared
+// root signatures, signatures, ...); containers are then rebuilt on demand
+// with DxcArchive_CopyContainer.
+
+#define DXC_ARCHIVE_MAGIC   DXC_FOURCC('D', 'X', 'A', 'R')
+#define DXC_ARCHIVE_VERSION 1
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcArchiveHeader {
+    UINT32 Magic;
+    UINT32 Version;
+    UINT32 ShaderCount;
+    UINT32 BucketCount;     // Power of two
+    UINT32 PartCount;
+    UINT32 Reserved;
+    UINT64 BucketsOffset;   // UINT32[BucketCount + 1]
+    UINT64 EntriesOffset;   // DxcArchiveEntry[ShaderCount]
+    UINT64 PartsOffset;     // DxcArchivePart[PartCount]
+    UINT64 FileSize;
+} DxcArchiveHeader;
+
+typedef struct DxcArchiveEntry {
+    BYTE   Key[16];             // DxcShaderHash.HashDigest
+    BYTE   ContainerDigest[16]; // Copied from the container header
+    UINT64 ContainerOffset;     // 0 when the container is not stored contiguously
+    UINT32 ContainerSize;
+    UINT32 FirstPart;
+    UINT32 PartCount;
+    UINT16 MajorVersion;
+    UINT16 MinorVersion;
+} DxcArchiveEntry;
+
+typedef struct DxcArchivePart {
+    UINT32 FourCC;
+    UINT32 Size;
+    UINT64 Offset;
+} DxcArchivePart;
+
+typedef struct DxcArchive {
+    const BYTE             *pBase;
+    SIZE_T                  Size;
+    const DxcArchiveHeader *pHeader;
+    const UINT32           *pBuckets;
+    const DxcArchiveEntry  *pEntries;
+    const DxcArchivePart   *pParts;
+} DxcArchive;
+
+typedef struct DxcArchiveWriterBlob {
+    DxcHash Hash;
+    UINT64  Offset;
+    UINT32  Size;
+    UINT32  Used;
+} DxcArchiveWriterBlob;
+
+typedef struct DxcArchiveWriter {
+    BOOL                  DedupParts;
+    BYTE                 *pData;     // Blob payloads, offsets relative to the data section
+    UINT64                DataSize;
+    UINT64                DataCapacity;
+    DxcArchiveEntry      *pEntries;
+    UINT32                EntryCount;
+    UINT32                EntryCapacity;
+    DxcArchivePart       *pParts;
+    UINT32                PartCount;
+    UINT32                PartCapacity;
+    DxcArchiveWriterBlob *pBlobs;    // Open addressing, power of two capacity
+    UINT32                BlobCount;
+    UINT32                BlobCapacity;
+    UINT32               *pKeySlots;  // Entry index + 1, open addressing over Key
+    UINT32                KeyCapacity;
+} DxcArchiveWriter;
+
+// --- Internals --------------------------------------------------------------
+static inline UINT32 DxcArchive_Bucket(const BYTE key[16], UINT32 bucketCount) {
+    UINT32 value;
+    memcpy(&value, key, sizeof(value));
+    return value & (bucketCount - 1);
+}
+
+static inline BOOL DxcArchiveWriter_Reserve(void **ppData, UINT64 *pCapacity, UINT64 required, SIZE_T elementSize) {
+    if (required <= *pCapacity) {
+        return 1;
+    }
+    UINT64 capacity = *pCapacity ? *pCapacity : 16;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    void *data = realloc(*ppData, (SIZE_T)(capacity * elementSize));
+    if (!data) {
+        return 0;
+    }
+    *ppData = data;
+    *pCapacity = capacity;
+    return 1;
+}
+
+// Stores a payload once and returns its data-relative offset
+static inline HRESULT DxcArchiveWriter_AddBlob(DxcArchiveWriter *writer, const void *pData, UINT32 size, UINT64 *pOffset) {
+    DxcHash hash = DxcHash_Compute(pData, size, size);
+
+    if ((writer->BlobCount + 1) * 2 > writer->BlobCapacity) {
+        UINT32 capacity = writer->BlobCapacity ? writer->BlobCapacity * 2 : 256;
+        DxcArchiveWriterBlob *blobs = (DxcArchiveWriterBlob*)calloc(capacity, sizeof(DxcArchiveWriterBlob));
+        if (!blobs) {
+            return E_OUTOFMEMORY;
+        }
+        for (UINT32 i = 0; i < writer->BlobCapacity; ++i) {
+            if (writer->pBlobs[i].Used) {
+                UINT32 index = DxcArchive_Bucket(writer->pBlobs[i].Hash.Digest, capacity);
+                while (blobs[index].Used) {
+                    index = (index + 1) & (capacity - 1);
+                }
+                blobs[index] = writer->pBlobs[i];
+            }
+        }
+        free(writer->pBlobs);
+        writer->pBlobs = blobs;
+        writer->BlobCapacity = capacity;
+    }
+
+    UINT32 index = DxcArchive_Bucket(hash.Digest, writer->BlobCapacity);
+    for (; writer->pBlobs[index].Used; index = (index + 1) & (writer->BlobCapacity - 1)) {
+        DxcArchiveWriterBlob *blob = &writer->pBlobs[index];
+        if (blob->Size == size && DxcHash_Equal(&blob->Hash, &hash) && memcmp(writer->pData + blob->Offset, pData, size) == 0) {
+            *pOffset = blob->Offset;
+            return S_OK;
+        }
+    }
+
+    UINT64 offset = (writer->DataSize + 15) & ~(UINT64)15;
+    if (!DxcArchiveWriter_Reserve((void**)&writer->pData, &writer->DataCapacity, offset + size, 1)) {
+        return E_OUTOFMEMORY;
+    }
+    memset(writer->pData + writer->DataSize, 0, (SIZE_T)(offset - writer->DataSize));
+    memcpy(writer->pData + offset, pData, size);
+    writer->DataSize = offset + size;
+
+    writer->pBlobs[index].Hash = hash;
+    writer->pBlobs[index].Offset = offset;
+    writer->pBlobs[index].Size = size;
+    writer->pBlobs[index].Used = 1;
+    writer->BlobCount++;
+
+    *pOffset = offset;
+    return S_OK;
+}
+
+// Returns the key slot for pKey, which is either empty or holds a matching entry
+static inline UINT32 *DxcArchiveWriter_FindKey(DxcArchiveWriter *writer, const BYTE pKey[16]) {
+    UINT32 index = DxcArchive_Bucket(pKey, writer->KeyCapacity);
+    while (writer->pKeySlots[index] && memcmp(writer->pEntries[writer->pKeySlots[index] - 1].Key, pKey, 16) != 0) {
+        index = (index + 1) & (writer->KeyCapacity - 1);
+    }
+    return &writer->pKeySlots[index];
+}
+
+static inline HRESULT DxcArchiveWriter_GrowKeys(DxcArchiveWriter *writer) {
+    if ((writer->EntryCount + 1) * 2 <= writer->KeyCapacity) {
+        return S_OK;
+    }
+    UINT32 *old = writer->pKeySlots;
+    UINT32 oldCapacity = writer->KeyCapacity;
+    writer->KeyCapacity = oldCapacity ? oldCapacity * 2 : 256;
+    writer->pKeySlots = (UINT32*)calloc(writer->KeyCapacity, sizeof(UINT32));
+    if (!writer->pKeySlots) {
+        writer->pKeySlots = old;
+        writer->KeyCapacity = oldCapacity;
+        return E_OUTOFMEMORY;
+    }
+    for (UINT32 i = 0; i < oldCapacity; ++i) {
+        if (old[i]) {
+            *DxcArchiveWriter_FindKey(writer, writer->pEntries[old[i] - 1].Key) = old[i];
+        }
+    }
+    free(old);
+    return S_OK;
+}
+
+static inline int DxcArchiveWriter_CompareEntries(const void *a, const void *b, UINT32 bucketCount) {
+    const DxcArchiveEntry *x = (const DxcArchiveEntry*)a;
+    const DxcArchiveEntry *y = (const DxcArchiveEntry*)b;
+    UINT32 bx = DxcArchive_Bucket(x->Key, bucketCount);
+    UINT32 by = DxcArchive_Bucket(y->Key, bucketCount);
+    if (bx != by) {
+        return bx < by ? -1 : 1;
+    }
+    return memcmp(x->Key, y->Key, sizeof(x->Key));
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline HRESULT DxcArchiveWriter_Create(BOOL dedupParts, DxcArchiveWriter **ppWriter) {
+    if (!ppWriter) {
+        return E_INVALIDARG;
+    }
+    *ppWriter = (DxcArchiveWriter*)calloc(1, sizeof(DxcArchiveWriter));
+    if (!*ppWriter) {
+        return E_OUTOFMEMORY;
+    }
+    (*ppWriter)->DedupParts = dedupParts;
+    return S_OK;
+}
+
+static inline void DxcArchiveWriter_Destroy(DxcArchiveWriter *writer) {
+    if (writer) {
+        free(writer->pData);
+        free(writer->pEntries);
+        free(writer->pParts);
+        free(writer->pBlobs);
+        free(writer->pKeySlots);
+        free(writer);
+    }
+}
+
+// Adds a container. pKey may be NULL to use its DXC_PART_SHADER_HASH part.
+// Returns S_FALSE if the key is already present; the first container wins.
+static inline HRESULT DxcArchiveWriter_Add(DxcArchiveWriter *writer, const void *pContainer, SIZE_T size, const DxcShaderHash *pKey) {
+    DxcContainerView view;
+    HRESULT hr = DxcContainer_Parse(pContainer, size, &view);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    DxcShaderHash key;
+    if (pKey) {
+        key = *pKey;
+    }
+    else if (!DxcContainer_GetShaderHash(&view, &key)) {
+        return E_INVALIDARG;
+    }
+
+    hr = DxcArchiveWriter_GrowKeys(writer);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    UINT32 *keySlot = DxcArchiveWriter_FindKey(writer, key.HashDigest);
+    if (*keySlot) {
+        return S_FALSE;
+    }
+
+    UINT64 entryCapacity = writer->EntryCapacity;
+    UINT64 partCapacity = writer->PartCapacity;
+    if (!DxcArchiveWriter_Reserve((void**)&writer->pEntries, &entryCapacity, writer->EntryCount + 1ull, sizeof(DxcArchiveEntry)) ||
+        !DxcArchiveWriter_Reserve((void**)&writer->pParts, &partCapacity, (UINT64)writer->PartCount + view.PartCount, sizeof(DxcArchivePart))) {
+        return E_OUTOFMEMORY;
+    }
+    writer->EntryCapacity = (UINT32)entryCapacity;
+    writer->PartCapacity = (UINT32)partCapacity;
+
+    DxcArchiveEntry *entry = &writer->pEntries[writer->EntryCount];
+    memset(entry, 0, sizeof(DxcArchiveEntry));
+    memcpy(entry->Key, key.HashDigest, sizeof(entry->Key));
+    memcpy(entry->ContainerDigest, view.Digest, sizeof(entry->ContainerDigest));
+    memcpy(&entry->MajorVersion, view.pData + offsetof(DxcContainerHeader, MajorVersion), sizeof(UINT16));
+    memcpy(&entry->MinorVersion, view.pData + offsetof(DxcContainerHeader, MinorVersion), sizeof(UINT16));
+    entry->ContainerSize = view.Size;
+    entry->FirstPart = writer->PartCount;
+    entry->PartCount = view.PartCount;
+
+    UINT64 containerOffset = 0;
+    if (!writer->DedupParts) {
+        hr = DxcArchiveWriter_AddBlob(writer, view.pData, view.Size, &containerOffset);
+        if (FAILED(hr)) {
+            return hr;
+        }
+    }
+
+    for (UINT32 i = 0; i < view.PartCount; ++i) {
+        DxcPartView part;
+        DxcContainer_GetPart(&view, i, &part);
+
+        DxcArchivePart *record = &writer->pParts[writer->PartCount + i];
+        record->FourCC = part.FourCC;
+        record->Size = part.Size;
+        if (writer->DedupParts) {
+            hr = DxcArchiveWriter_AddBlob(writer, part.pData, part.Size, &record->Offset);
+            if (FAILED(hr)) {
+                return hr;
+            }
+        }
+        else {
+            record->Offset = containerOffset + (UINT64)((const BYTE*)part.pData - view.pData);
+        }
+    }
+
+    // Offsets are data-relative until DxcArchiveWriter_Write; +1 keeps 0 free for "not contiguous"
+    entry->ContainerOffset = writer->DedupParts ? 0 : containerOffset + 1;
+    writer->PartCount += view.PartCount;
+    *keySlot = ++writer->EntryCount;
+    return S_OK;
+}
+
+// Writes the archive to pPath through a temporary file and an atomic rename
+static inline HRESULT DxcArchiveWriter_Write(DxcArchiveWriter *writer, const char *pPath) {
+    UINT32 bucketCount = 1;
+    while (bucketCount < writer->EntryCount) {
+        bucketCount *= 2;
+    }
+
+    // Counting sort by bucket, then insertion within each bucket by key
+    DxcArchiveEntry *entries = (DxcArchiveEntry*)malloc((writer->EntryCount + 1) * sizeof(DxcArchiveEntry));
+    UINT32 *buckets = (UINT32*)calloc(bucketCount + 1, sizeof(UINT32));
+    if (!entries || !buckets) {
+        free(buckets);
+        free(entries);
+        return E_OUTOFMEMORY;
+    }
+
+    for (UINT32 i = 0; i < writer->EntryCount; ++i) {
+        buckets[DxcArchive_Bucket(writer->pEntries[i].Key, bucketCount) + 1]++;
+    }
+    for (UINT32 i = 0; i < bucketCount; ++i) {
+        buckets[i + 1] += buckets[i];
+    }
+    UINT32 *cursor = (UINT32*)malloc((bucketCount + 1) * sizeof(UINT32));
+    if (!cursor) {
+        free(buckets);
+        free(entries);
+        return E_OUTOFMEMORY;
+    }
+    memcpy(cursor, buckets, (bucketCount + 1) * sizeof(UINT32));
+    for (UINT32 i = 0; i < writer->EntryCount; ++i) {
+        UINT32 bucket = DxcArchive_Bucket(writer->pEntries[i].Key, bucketCount);
+        UINT32 slot = cursor[bucket]++;
+        // Keep each bucket sorted by key so lookups can stop early
+        while (slot > buckets[bucket] && DxcArchiveWriter_CompareEntries(&entries[slot - 1], &writer->pEntries[i], bucketCount) > 0) {
+            entries[slot] = entries[slot - 1];
+            --slot;
+        }
+        entries[slot] = writer->pEntries[i];
+    }
+    free(cursor);
+
+    DxcArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = DXC_ARCHIVE_MAGIC;
+    header.Version = DXC_ARCHIVE_VERSION;
+    header.ShaderCount = writer->EntryCount;
+    header.BucketCount = bucketCount;
+    header.PartCount = writer->PartCount;
+    header.BucketsOffset = sizeof(DxcArchiveHeader);
+    header.EntriesOffset = (header.BucketsOffset + (bucketCount + 1) * sizeof(UINT32) + 15) & ~(UINT64)15;
+    header.PartsOffset = header.EntriesOffset + (UINT64)writer->EntryCount * sizeof(DxcArchiveEntry);
+    UINT64 dataOffset = (header.PartsOffset + (UINT64)writer->PartCount * sizeof(DxcArchivePart) + 15) & ~(UINT64)15;
+    header.FileSize = dataOffset + writer->DataSize;
+
+    for (UINT32 i = 0; i < writer->EntryCount; ++i) {
+        if (entries[i].ContainerOffset) {
+            entries[i].ContainerOffset += dataOffset - 1;
+        }
+    }
+
+    char tempPath[4096];
+    FILE *file = DxcUtil_CreateTemp(pPath, tempPath, sizeof(tempPath));
+    HRESULT hr = file ? S_OK : E_FAIL;
+
+    static const BYTE padding[16] = { 0 };
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, &header, sizeof(header)); }
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, buckets, (bucketCount + 1) * sizeof(UINT32)); }
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, padding, (SIZE_T)(header.EntriesOffset - header.BucketsOffset - (bucketCount + 1) * sizeof(UINT32))); }
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, entries, writer->EntryCount * sizeof(DxcArchiveEntry)); }
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < writer->PartCount; ++i) {
+        DxcArchivePart part = writer->pParts[i];
+        part.Offset += dataOffset;
+        hr = DxcUtil_WriteAll(file, &part, sizeof(part));
+    }
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, padding, (SIZE_T)(dataOffset - header.PartsOffset - writer->PartCount * sizeof(DxcArchivePart))); }
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, writer->pData, (SIZE_T)writer->DataSize); }
+
+    if (file) {
+        hr = DxcUtil_FinishTemp(file, tempPath, pPath, hr);
+    }
+
+    free(buckets);
+    free(entries);
+    return hr;
+}
+
+static inline void DxcArchive_Close(DxcArchive *archive) {
+    if (archive) {
+        munmap((void*)archive->pBase, archive->Size);
+        free(archive);
+    }
+}
+
+// Maps the archive and validates every table bound once
+static inline HRESULT DxcArchive_Open(const char *pPath, DxcArchive **ppArchive) {
+    if (!pPath || !ppArchive) {
+        return E_INVALIDARG;
+    }
+
+    *ppArchive = NULL;
+
+    int fd = open(pPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return E_FAIL;
+    }
+
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (SIZE_T)st.st_size >= sizeof(DxcArchiveHeader)) {
+        base = mmap(NULL, (SIZE_T)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        return E_FAIL;
+    }
+
+    SIZE_T size = (SIZE_T)st.st_size;
+    const BYTE *data = (const BYTE*)base;
+    const DxcArchiveHeader *header = (const DxcArchiveHeader*)data;
+    BOOL valid = header->Magic == DXC_ARCHIVE_MAGIC && header->Version == DXC_ARCHIVE_VERSION &&
+                 header->FileSize == size && header->BucketCount && (header->BucketCount & (header->BucketCount - 1)) == 0 &&
+                 header->BucketsOffset + (header->BucketCount + 1ull) * sizeof(UINT32) <= size &&
+                 header->EntriesOffset + (UINT64)header->ShaderCount * sizeof(DxcArchiveEntry) <= size &&
+                 header->PartsOffset + (UINT64)header->PartCount * sizeof(DxcArchivePart) <= size &&
+                 header->BucketsOffset % 4 == 0 && header->EntriesOffset % 8 == 0 && header->PartsOffset % 8 == 0;
+
+    const UINT32 *buckets = (const UINT32*)(data + header->BucketsOffset);
+    const DxcArchiveEntry *entries = (const DxcArchiveEntry*)(data + header->EntriesOffset);
+    const DxcArchivePart *parts = (const DxcArchivePart*)(data + header->PartsOffset);
+
+    valid = valid && buckets[header->BucketCount] == header->ShaderCount;
+    for (UINT32 i = 0; valid && i < header->BucketCount; ++i) {
+        valid = buckets[i] <= buckets[i + 1];
+    }
+    for (UINT32 i = 0; valid && i < header->ShaderCount; ++i) {
+        valid = (UINT64)entries[i].FirstPart + entries[i].PartCount <= header->PartCount &&
+                entries[i].ContainerOffset + entries[i].ContainerSize <= size;
+    }
+    for (UINT32 i = 0; valid && i < header->PartCount; ++i) {
+        valid = parts[i].Offset + parts[i].Size <= size;
+    }
+
+    DxcArchive *archive = valid ? (DxcArchive*)malloc(sizeof(DxcArchive)) : NULL;
+    if (!archive) {
+        munmap(base, size);
+        return valid ? E_OUTOFMEMORY : E_INVALIDARG;
+    }
+
+    archive->pBase = data;
+    archive->Size = size;
+    archive->pHeader = header;
+    archive->pBuckets = buckets;
+    archive->pEntries = entries;
+    archive->pParts = parts;
+
+    *ppArchive = archive;
+    return S_OK;
+}
+
+static inline UINT32 DxcArchive_GetShaderCount(const DxcArchive *archive) { return archive->pHeader->ShaderCount; }
+
+// Looks up a shader by DxcShaderHash.HashDigest. Returns NULL if absent.
+static inline const DxcArchiveEntry *DxcArchive_Find(const DxcArchive *archive, const BYTE pDigest[16]) {
+    UINT32 bucket = DxcArchive_Bucket(pDigest, archive->pHeader->BucketCount);
+    for (UINT32 i = archive->pBuckets[bucket]; i < archive->pBuckets[bucket + 1]; ++i) {
+        int order = memcmp(archive->pEntries[i].Key, pDigest, 16);
+        if (order == 0) {
+            return &archive->pEntries[i];
+        }
+        if (order > 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// Returns the stored container. Fails for archives written with DedupParts;
+// use DxcArchive_CopyContainer there.
+static inline BOOL DxcArchive_GetContainer(const DxcArchive *archive, const DxcArchiveEntry *pEntry, const void **ppData, UINT32 *pSize) {
+    if (!pEntry->ContainerOffset) {
+        return 0;
+    }
+    *ppData = archive->pBase + pEntry->ContainerOffset;
+    *pSize = pEntry->ContainerSize;
+    return 1;
+}
+
+static inline BOOL DxcArchive_FindPart(const DxcArchive *archive, const DxcArchiveEntry *pEntry, UINT32 fourCC, DxcPartView *pPart) {
+    for (UINT32 i = 0; i < pEntry->PartCount; ++i) {
+        const DxcArchivePart *part = &archive->pParts[pEntry->FirstPart + i];
+        if (part->FourCC == fourCC) {
+            pPart->FourCC = part->FourCC;
+            pPart->pData = archive->pBase + part->Offset;
+            pPart->Size = part->Size;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Rebuilds the container into pBuffer, which needs pEntry->ContainerSize bytes
+static inline HRESULT DxcArchive_CopyContainer(const DxcArchive *archive, const DxcArchiveEntry *pEntry, void *pBuffer, UINT32 capacity) {
+    if (capacity < pEntry->ContainerSize) {
+        return E_INVALIDARG;
+    }
+
+    const void *stored;
+    UINT32 storedSize;
+    if (DxcArchive_GetContainer(archive, pEntry, &stored, &storedSize)) {
+        memcpy(pBuffer, stored, storedSize);
+        return S_OK;
+    }
+
+    UINT64 offset = sizeof(DxcContainerHeader) + (UINT64)pEntry->PartCount * sizeof(UINT32);
+    for (UINT32 i = 0; i < pEntry->PartCount; ++i) {
+        offset += sizeof(DxcPartHeader) + archive->pParts[pEntry->FirstPart + i].Size;
+    }
+    if (offset != pEntry->ContainerSize) {
+        return E_INVALIDARG;
+    }
+
+    BYTE *out = (BYTE*)pBuffer;
+    DxcContainerHeader header;
+    header.HeaderFourCC = DXC_CONTAINER_FOURCC;
+    memcpy(header.Digest, pEntry->ContainerDigest, sizeof(header.Digest));
+    header.MajorVersion = pEntry->MajorVersion;
+    header.MinorVersion = pEntry->MinorVersion;
+    header.ContainerSizeInBytes = pEntry->ContainerSize;
+    header.PartCount = pEntry->PartCount;
+    memcpy(out, &header, sizeof(header));
+
+    UINT32 partOffset = (UINT32)(sizeof(DxcContainerHeader) + pEntry->PartCount * sizeof(UINT32));
+    for (UINT32 i = 0; i < pEntry->PartCount; ++i) {
+        const DxcArchivePart *part = &archive->pParts[pEntry->FirstPart + i];
+        DxcPartHeader partHeader = { part->FourCC, part->Size };
+        memcpy(out + sizeof(DxcContainerHeader) + i * sizeof(UINT32), &partOffset, sizeof(UINT32));
+        memcpy(out + partOffset, &partHeader, sizeof(partHeader));
+        memcpy(out + partOffset + sizeof(partHeader), archive->pBase + part->Offset, part->Size);
+        partOffset += (UINT32)sizeof(partHeader) + part->Size;
+    }
+    return S_OK;
+}
+
+// Wraps a view in an IDxcBlob without copying. The blob must not outlive the archive.
+static inline HRESULT DxcArchive_CreateBlob(IDxcUtils *pUtils, const void *pData, UINT32 size, IDxcBlob **ppBlob) {
+    return IDxcUtils_CreateBlobFromPinned(pUtils, pData, size, DXC_CP_ACP, (IDxcBlobEncoding**)ppBlob);
+}
+
+#endif /* __DXC_ARCHIVE_C__ */
@@ -0,0 +1,460 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_arena.h                                                             //
+// Arena-backed IMalloc for per-compile allocation via DxcCreateInstance2    //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_ARENA_C__
+#define __DXC_ARENA_C__
+
+#include "dxc_c.h"
+#include "dxc_c_util.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// NOTE: Requires POSIX threads. Pass the IMalloc to DxcCreateInstance2Proc (or
+// IDxcLibrary_SetMalloc) and DXC routes every allocation made inside its calls
+// through it. Between DxcArenaMalloc_BeginScope and DxcArenaMalloc_EndScope,
+// allocations on the calling thread are bump-allocated from thread-private
+// chunks; outside a scope they fall through to malloc, which keeps long-lived
+// objects such as the compiler itself off the arena.
+//
+// EndScope resets the arena wholesale: chunks without live allocations are
+// recycled for the next scope. Chunks that still hold live allocations (for
+// example the blobs of an IDxcResult that was not released yet) are detached
+// and freed when their last allocation is freed, so a reset never invalidates
+// memory DXC still owns.
+
+#define DXC_ARENA_DEFAULT_CHUNK_SIZE (1u << 20)
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcArenaMallocDesc {
+    SIZE_T ChunkSize;  // 0 uses DXC_ARENA_DEFAULT_CHUNK_SIZE
+    BOOL   TrackStats; // Maintain DxcArenaStats for every scope
+} DxcArenaMallocDesc;
+
+typedef struct DxcArenaStats {
+    UINT64 AllocationCount;
+    UINT64 FreeCount;
+    UINT64 AllocatedBytes; // Sum of all requested sizes
+    UINT64 PeakBytes;      // Highest number of simultaneously live bytes
+} DxcArenaStats;
+
+typedef struct DxcArenaThread DxcArenaThread;
+
+typedef struct DxcArenaChunk {
+    struct DxcArenaChunk *pNext;
+    DxcArenaThread       *pOwner;
+    UINT64                Scope;    // Owner scope the chunk was handed out in
+    atomic_size_t         RefCount; // Live allocations, plus one while owned by a scope
+    SIZE_T                Capacity;
+    SIZE_T                Used;
+    SIZE_T                LastOffset;
+} DxcArenaChunk;
+
+struct DxcArenaThread {
+    DxcArenaThread *pNext;    // Registry of every thread that used the arena
+    DxcArenaChunk  *pCurrent; // Chunks of the open scope, newest first
+    DxcArenaChunk  *pFree;    // Recycled chunks
+    BOOL            InScope;
+    atomic_ullong   Scope;    // Incremented by every BeginScope
+    atomic_llong    LiveBytes;
+    atomic_ullong   FreeCount;
+    UINT64          AllocationCount;
+    UINT64          AllocatedBytes;
+    UINT64          PeakBytes;
+};
+
+typedef struct DxcArenaMalloc {
+    void *const    *v;
+    atomic_uint     RefCount;
+    UINT64          Id;
+    SIZE_T          ChunkSize;
+    BOOL            TrackStats;
+    pthread_key_t   Key;
+    pthread_mutex_t Lock; // Guards pThreads
+    DxcArenaThread *pThreads;
+} DxcArenaMalloc;
+
+// Placed in front of every allocation
+typedef struct DxcArenaHeader {
+    DxcArenaChunk *pChunk; // NULL for allocations made outside a scope
+    SIZE_T         Size;
+} DxcArenaHeader;
+
+// --- Internals --------------------------------------------------------------
+#define DXC_ARENA_ALIGN(x)    (((x) + 15) & ~(SIZE_T)15)
+#define DXC_ARENA_HEADER_SIZE DXC_ARENA_ALIGN(sizeof(DxcArenaHeader))
+#define DXC_ARENA_CHUNK_SIZE  DXC_ARENA_ALIGN(sizeof(DxcArenaChunk))
+
+static const IID DxcArena_IID_IMalloc = { 0x00000002, 0x0000, 0x0000, { 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46 } };
+
+static atomic_ullong DxcArena_NextId = 1;
+
+// One-entry cache in front of pthread_getspecific, keyed by arena id so a
+// stale entry from a destroyed arena is never dereferenced
+static _Thread_local UINT64          DxcArena_CachedId;
+static _Thread_local DxcArenaThread *DxcArena_CachedThread;
+
+static inline BYTE *DxcArenaChunk_Data(DxcArenaChunk *chunk) { return (BYTE*)chunk + DXC_ARENA_CHUNK_SIZE; }
+
+static inline DxcArenaThread *DxcArena_GetThread(DxcArenaMalloc *self, BOOL create) {
+    if (DxcArena_CachedId == self->Id) {
+        return DxcArena_CachedThread;
+    }
+
+    DxcArenaThread *thread = (DxcArenaThread*)pthread_getspecific(self->Key);
+    if (!thread && create) {
+        thread = (DxcArenaThread*)calloc(1, sizeof(DxcArenaThread));
+        if (!thread) {
+            return NULL;
+        }
+        atomic_init(&thread->Scope, 0);
+        atomic_init(&thread->LiveBytes, 0);
+        atomic_init(&thread->FreeCount, 0);
+        pthread_setspecific(self->Key, thread);
+
+        pthread_mutex_lock(&self->Lock);
+        thread->pNext = self->pThreads;
+        self->pThreads = thread;
+        pthread_mutex_unlock(&self->Lock);
+    }
+
+    if (thread) {
+        DxcArena_CachedId = self->Id;
+        DxcArena_CachedThread = thread;
+    }
+    return thread;
+}
+
+// Drops the scope's reference on every chunk, recycling the ones that are empty
+static inline void DxcArena_CloseScope(DxcArenaThread *thread, SIZE_T chunkSize) {
+    DxcArenaChunk *chunk = thread->pCurrent;
+    while (chunk) {
+        DxcArenaChunk *next = chunk->pNext;
+        if (atomic_fetch_sub(&chunk->RefCount, 1) == 1) {
+            if (chunk->Capacity == chunkSize) {
+                chunk->Used = 0;
+                chunk->pNext = thread->pFree;
+                thread->pFree = chunk;
+            }
+            else {
+                free(chunk);
+            }
+        }
+        chunk = next;
+    }
+    thread->pCurrent = NULL;
+    thread->InScope = 0;
+}
+
+static inline void DxcArena_FreeChunks(DxcArenaThread *thread) {
+    while (thread->pFree) {
+        DxcArenaChunk *next = thread->pFree->pNext;
+        free(thread->pFree);
+        thread->pFree = next;
+    }
+}
+
+static inline void DxcArena_ThreadExit(void *arg) {
+    DxcArenaThread *thread = (DxcArenaThread*)arg;
+    if (thread->InScope) {
+        DxcArena_CloseScope(thread, 0);
+    }
+    DxcArena_FreeChunks(thread);
+    // The record stays in the registry: frees from other threads may still
+    // update its counters until the arena itself is destroyed.
+}
+
+static inline DxcArenaChunk *DxcArena_NewChunk(DxcArenaMalloc *self, DxcArenaThread *thread, SIZE_T capacity) {
+    DxcArenaChunk *chunk;
+    if (capacity == self->ChunkSize && thread->pFree) {
+        chunk = thread->pFree;
+        thread->pFree = chunk->pNext;
+    }
+    else {
+        chunk = (DxcArenaChunk*)malloc(DXC_ARENA_CHUNK_SIZE + capacity);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->Capacity = capacity;
+    }
+
+    chunk->pOwner = thread;
+    chunk->Scope = atomic_load_explicit(&thread->Scope, memory_order_relaxed);
+    chunk->Used = 0;
+    chunk->LastOffset = 0;
+    atomic_init(&chunk->RefCount, 0);
+    return chunk;
+}
+
+static inline void DxcArena_CountAlloc(DxcArenaThread *thread, SIZE_T size) {
+    thread->AllocationCount++;
+    thread->AllocatedBytes += size;
+    UINT64 live = (UINT64)(atomic_fetch_add(&thread->LiveBytes, (long long)size) + (long long)size);
+    if (live > thread->PeakBytes) {
+        thread->PeakBytes = live;
+    }
+}
+
+static inline ULONG __stdcall DxcArenaMalloc_AddRef(DxcArenaMalloc *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcArenaMalloc_Release(DxcArenaMalloc *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        pthread_key_delete(self->Key);
+        while (self->pThreads) {
+            DxcArenaThread *next = self->pThreads->pNext;
+            if (self->pThreads->InScope) {
+                DxcArena_CloseScope(self->pThreads, self->ChunkSize);
+            }
+            DxcArena_FreeChunks(self->pThreads);
+            free(self->pThreads);
+            self->pThreads = next;
+        }
+        pthread_mutex_destroy(&self->Lock);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcArenaMalloc_QueryInterface(DxcArenaMalloc *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &DxcArena_IID_IMalloc, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcArenaMalloc_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline void *__stdcall DxcArenaMalloc_Alloc(DxcArenaMalloc *self, SIZE_T cb) {
+    DxcArenaThread *thread = DxcArena_GetThread(self, 0);
+    SIZE_T need = DXC_ARENA_HEADER_SIZE + DXC_ARENA_ALIGN(cb);
+    DxcArenaHeader *header;
+
+    if (!thread || !thread->InScope) {
+        header = (DxcArenaHeader*)malloc(need);
+        if (!header) {
+            return NULL;
+        }
+        header->pChunk = NULL;
+    }
+    else if (need > self->ChunkSize / 4) {
+        // Dedicated chunk: no scope reference, freed with its only allocation
+        DxcArenaChunk *chunk = DxcArena_NewChunk(self, thread, need);
+        if (!chunk) {
+            return NULL;
+        }
+        header = (DxcArenaHeader*)DxcArenaChunk_Data(chunk);
+        header->pChunk = chunk;
+        atomic_store(&chunk->RefCount, 1);
+    }
+    else {
+        DxcArenaChunk *chunk = thread->pCurrent;
+        if (!chunk || chunk->Used + need > chunk->Capacity) {
+            chunk = DxcArena_NewChunk(self, thread, self->ChunkSize);
+            if (!chunk) {
+                return NULL;
+            }
+            atomic_store(&chunk->RefCount, 1);
+            chunk->pNext = thread->pCurrent;
+            thread->pCurrent = chunk;
+        }
+        header = (DxcArenaHeader*)(DxcArenaChunk_Data(chunk) + chunk->Used);
+        header->pChunk = chunk;
+        chunk->LastOffset = chunk->Used;
+        chunk->Used += need;
+        atomic_fetch_add(&chunk->RefCount, 1);
+    }
+
+    header->Size = cb;
+    if (self->TrackStats && header->pChunk) {
+        DxcArena_CountAlloc(thread, cb);
+    }
+    return (BYTE*)header + DXC_ARENA_HEADER_SIZE;
+}
+
+static inline void __stdcall DxcArenaMalloc_Free(DxcArenaMalloc *self, void *pv) {
+    if (!pv) {
+        return;
+    }
+
+    DxcArenaHeader *header = (DxcArenaHeader*)((BYTE*)pv - DXC_ARENA_HEADER_SIZE);
+    DxcArenaChunk *chunk = header->pChunk;
+    if (!chunk) {
+        free(header);
+        return;
+    }
+
+    // Survivors of an earlier scope must not skew the statistics of the current one
+    if (self->TrackStats && chunk->Scope == atomic_load_explicit(&chunk->pOwner->Scope, memory_order_relaxed)) {
+        atomic_fetch_sub(&chunk->pOwner->LiveBytes, (long long)header->Size);
+        atomic_fetch_add(&chunk->pOwner->FreeCount, 1);
+    }
+    if (atomic_fetch_sub(&chunk->RefCount, 1) == 1) {
+        free(chunk); // Detached from its scope or dedicated
+    }
+}
+
+static inline void *__stdcall DxcArenaMalloc_Realloc(DxcArenaMalloc *self, void *pv, SIZE_T cb) {
+    if (!pv) {
+        return DxcArenaMalloc_Alloc(self, cb);
+    }
+    if (cb == 0) {
+        DxcArenaMalloc_Free(self, pv);
+        return NULL;
+    }
+
+    DxcArenaHeader *header = (DxcArenaHeader*)((BYTE*)pv - DXC_ARENA_HEADER_SIZE);
+    DxcArenaChunk *chunk = header->pChunk;
+
+    if (!chunk) {
+        DxcArenaHeader *resized = (DxcArenaHeader*)realloc(header, DXC_ARENA_HEADER_SIZE + cb);
+        if (!resized) {
+            return NULL;
+        }
+        resized->Size = cb;
+        return (BYTE*)resized + DXC_ARENA_HEADER_SIZE;
+    }
+
+    // Grow or shrink in place when this is the newest allocation of the current chunk
+    DxcArenaThread *thread = DxcArena_GetThread(self, 0);
+    SIZE_T offset = (SIZE_T)((BYTE*)header - DxcArenaChunk_Data(chunk));
+    if (thread && thread->InScope && chunk == thread->pCurrent && offset == chunk->LastOffset &&
+        offset + DXC_ARENA_HEADER_SIZE + DXC_ARENA_ALIGN(cb) <= chunk->Capacity) {
+        if (self->TrackStats) {
+            if (cb > header->Size) {
+                thread->AllocatedBytes += cb - header->Size;
+            }
+            long long live = atomic_fetch_add(&thread->LiveBytes, (long long)cb - (long long)header->Size) + (long long)cb - (long long)header->Size;
+            if ((UINT64)live > thread->PeakBytes) {
+                thread->PeakBytes = (UINT64)live;
+            }
+        }
+        chunk->Used = offset + DXC_ARENA_HEADER_SIZE + DXC_ARENA_ALIGN(cb);
+        header->Size = cb;
+        return pv;
+    }
+
+    void *resized = DxcArenaMalloc_Alloc(self, cb);
+    if (resized) {
+        memcpy(resized, pv, header->Size < cb ? header->Size : cb);
+        DxcArenaMalloc_Free(self, pv);
+    }
+    return resized;
+}
+
+static inline SIZE_T __stdcall DxcArenaMalloc_GetSize(DxcArenaMalloc *self, void *pv) {
+    (void)self;
+    return pv ? ((DxcArenaHeader*)((BYTE*)pv - DXC_ARENA_HEADER_SIZE))->Size : (SIZE_T)-1;
+}
+
+static inline int __stdcall DxcArenaMalloc_DidAlloc(DxcArenaMalloc *self, void *pv) {
+    (void)self;
+    (void)pv;
+    return -1; // Cannot be determined cheaply
+}
+
+static inline void __stdcall DxcArenaMalloc_HeapMinimize(DxcArenaMalloc *self) {
+    DxcArenaThread *thread = DxcArena_GetThread(self, 0);
+    if (thread) {
+        DxcArena_FreeChunks(thread);
+    }
+}
+
+static void *const DxcArenaMalloc_Vtbl[] = {
+    (void*)DxcArenaMalloc_QueryInterface,
+    (void*)DxcArenaMalloc_AddRef,
+    (void*)DxcArenaMalloc_Release,
+    (void*)DxcArenaMalloc_Alloc,
+    (void*)DxcArenaMalloc_Realloc,
+    (void*)DxcArenaMalloc_Free,
+    (void*)DxcArenaMalloc_GetSize,
+    (void*)DxcArenaMalloc_DidAlloc,
+    (void*)DxcArenaMalloc_HeapMinimize,
+};
+
+// --- Methods ----------------------------------------------------------------
+static inline HRESULT DxcArenaMalloc_Create(const DxcArenaMallocDesc *pDesc, IMalloc **ppMalloc) {
+    if (!ppMalloc) {
+        return E_INVALIDARG;
+    }
+
+    *ppMalloc = NULL;
+
+    DxcArenaMalloc *self = (DxcArenaMalloc*)calloc(1, sizeof(DxcArenaMalloc));
+    if (!self) {
+        return E_OUTOFMEMORY;
+    }
+    if (pthread_key_create(&self->Key, DxcArena_ThreadExit) != 0) {
+        free(self);
+        return E_FAIL;
+    }
+
+    self->v = DxcArenaMalloc_Vtbl;
+    atomic_init(&self->RefCount, 1);
+    self->Id = atomic_fetch_add(&DxcArena_NextId, 1);
+    self->ChunkSize = pDesc && pDesc->ChunkSize ? DXC_ARENA_ALIGN(pDesc->ChunkSize) : DXC_ARENA_DEFAULT_CHUNK_SIZE;
+    self->TrackStats = pDesc ? pDesc->TrackStats : 0;
+    pthread_mutex_init(&self->Lock, NULL);
+
+    *ppMalloc = (IMalloc*)self;
+    return S_OK;
+}
+
+// Starts routing the calling thread's allocations to its arena. Scopes do not nest.
+static inline HRESULT DxcArenaMalloc_BeginScope(IMalloc *pMalloc) {
+    DxcArenaMalloc *self = (DxcArenaMalloc*)pMalloc;
+    DxcArenaThread *thread = DxcArena_GetThread(self, 1);
+    if (!thread) {
+        return E_OUTOFMEMORY;
+    }
+    if (thread->InScope) {
+        return E_FAIL;
+    }
+
+    thread->InScope = 1;
+    atomic_fetch_add(&thread->Scope, 1);
+    thread->AllocationCount = 0;
+    thread->AllocatedBytes = 0;
+    thread->PeakBytes = 0;
+    atomic_store(&thread->LiveBytes, 0);
+    atomic_store(&thread->FreeCount, 0);
+    return S_OK;
+}
+
+// Resets the calling thread's arena and returns the statistics of the scope
+// (all zero unless TrackStats was set)
+static inline DxcArenaStats DxcArenaMalloc_EndScope(IMalloc *pMalloc) {
+    DxcArenaMalloc *self = (DxcArenaMalloc*)pMalloc;
+    DxcArenaThread *thread = DxcArena_GetThread(self, 0);
+    DxcArenaStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    if (!thread || !thread->InScope) {
+        return stats;
+    }
+
+    stats.AllocationCount = thread->AllocationCount;
+    stats.FreeCount = atomic_load(&thread->FreeCount);
+    stats.AllocatedBytes = thread->AllocatedBytes;
+    stats.PeakBytes = thread->PeakBytes;
+
+    DxcArena_CloseScope(thread, self->ChunkSize);
+    return stats;
+}
+
+#endif /* __DXC_ARENA_C__ */
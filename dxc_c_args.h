@@ -0,0 +1,359 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_args.h                                                              //
+// Allocation-free compiler argument builder and UTF-8 conversion            //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_ARGS_C__
+#define __DXC_ARGS_C__
+
+#include "dxc_c.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DXC_ARGS_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define DXC_ARGS_NEON 1
+#endif
+
+// NOTE: Builds the LPCWSTR argument array for IDxcCompiler3_Compile, and the
+// DxcDefine list for the IDxcCompiler entry points, inside memory supplied by
+// the caller. It replaces IDxcUtils_BuildArguments and its heap strings.
+// Wide literals such as DXC_ARG_* are borrowed, not copied. UTF-8 strings are
+// converted straight into the caller's memory to wchar_t: UTF-16 on Windows,
+// UTF-32 elsewhere (see DXC_CP_WIDE). DxcArgs_Reset rewinds the builder, so
+// one buffer serves any number of jobs without a single allocation.
+//
+// Every Add function returns the builder's sticky status: once the memory is
+// exhausted, later calls do nothing and return E_OUTOFMEMORY. Checking the
+// last call, or DxcArgs::Status, is enough.
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcArgs {
+    LPCWSTR   *pArguments;
+    UINT32     ArgCount;
+    UINT32     MaxArguments;
+    DxcDefine *pDefines;
+    UINT32     DefineCount;
+    UINT32     MaxDefines;
+    wchar_t   *pChars;
+    SIZE_T     CharCount;
+    SIZE_T     CharCapacity;
+    HRESULT    Status;
+} DxcArgs;
+
+// --- Internals --------------------------------------------------------------
+// Decodes one non-ASCII sequence starting at pSrc[0]. Malformed input yields
+// U+FFFD and consumes a single byte.
+static inline UINT32 DxcUtf8_DecodeSlow(const BYTE *pSrc, SIZE_T remaining, SIZE_T *pLength) {
+    UINT32 c = pSrc[0];
+    *pLength = 1;
+
+    if (c >= 0xC2 && c <= 0xDF && remaining >= 2 && (pSrc[1] & 0xC0) == 0x80) {
+        *pLength = 2;
+        return ((c & 0x1F) << 6) | (pSrc[1] & 0x3F);
+    }
+    if ((c & 0xF0) == 0xE0 && remaining >= 3 && (pSrc[1] & 0xC0) == 0x80 && (pSrc[2] & 0xC0) == 0x80) {
+        UINT32 cp = ((c & 0x0F) << 12) | ((UINT32)(pSrc[1] & 0x3F) << 6) | (pSrc[2] & 0x3F);
+        if (cp >= 0x800 && (cp < 0xD800 || cp > 0xDFFF)) {
+            *pLength = 3;
+            return cp;
+        }
+    }
+    if ((c & 0xF8) == 0xF0 && remaining >= 4 && (pSrc[1] & 0xC0) == 0x80 && (pSrc[2] & 0xC0) == 0x80 && (pSrc[3] & 0xC0) == 0x80) {
+        UINT32 cp = ((c & 0x07) << 18) | ((UINT32)(pSrc[1] & 0x3F) << 12) | ((UINT32)(pSrc[2] & 0x3F) << 6) | (pSrc[3] & 0x3F);
+        if (cp >= 0x10000 && cp <= 0x10FFFF) {
+            *pLength = 4;
+            return cp;
+        }
+    }
+    return 0xFFFD;
+}
+
+// Widens 16 ASCII bytes to 16 wchar_t
+static inline void DxcUtf8_WidenAscii16(const BYTE *pSrc, wchar_t *pDst) {
+#if defined(DXC_ARGS_SSE2)
+    __m128i bytes = _mm_loadu_si128((const __m128i*)pSrc);
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    if (sizeof(wchar_t) == 2) {
+        _mm_storeu_si128((__m128i*)pDst, lo);
+        _mm_storeu_si128((__m128i*)(pDst + 8), hi);
+    }
+    else {
+        _mm_storeu_si128((__m128i*)pDst, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(pDst + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(pDst + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i*)(pDst + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+#elif defined(DXC_ARGS_NEON)
+    uint8x16_t bytes = vld1q_u8(pSrc);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+    if (sizeof(wchar_t) == 2) {
+        vst1q_u16((uint16_t*)pDst, lo);
+        vst1q_u16((uint16_t*)(pDst + 8), hi);
+    }
+    else {
+        vst1q_u32((uint32_t*)pDst, vmovl_u16(vget_low_u16(lo)));
+        vst1q_u32((uint32_t*)(pDst + 4), vmovl_u16(vget_high_u16(lo)));
+        vst1q_u32((uint32_t*)(pDst + 8), vmovl_u16(vget_low_u16(hi)));
+        vst1q_u32((uint32_t*)(pDst + 12), vmovl_u16(vget_high_u16(hi)));
+    }
+#else
+    for (UINT32 i = 0; i < 16; ++i) {
+        pDst[i] = (wchar_t)pSrc[i];
+    }
+#endif
+}
+
+static inline BOOL DxcUtf8_IsAscii16(const BYTE *pSrc) {
+#if defined(DXC_ARGS_SSE2)
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)pSrc)) == 0;
+#elif defined(DXC_ARGS_NEON)
+    return vmaxvq_u8(vld1q_u8(pSrc)) < 0x80;
+#else
+    UINT64 a, b;
+    memcpy(&a, pSrc, 8);
+    memcpy(&b, pSrc + 8, 8);
+    return ((a | b) & 0x8080808080808080ull) == 0;
+#endif
+}
+
+// --- Methods ----------------------------------------------------------------
+// Converts srcSize bytes of UTF-8 to wchar_t and returns the number of
+// elements written, without a terminator. pDst must hold srcSize elements,
+// which is always enough. Runs of ASCII are widened 16 bytes at a time.
+static inline SIZE_T DxcUtf8_ToWide(const char *pSrc, SIZE_T srcSize, wchar_t *pDst) {
+    const BYTE *src = (const BYTE*)pSrc;
+    wchar_t *dst = pDst;
+    SIZE_T i = 0;
+
+    while (i < srcSize) {
+        while (i + 16 <= srcSize && DxcUtf8_IsAscii16(src + i)) {
+            DxcUtf8_WidenAscii16(src + i, dst);
+            i += 16;
+            dst += 16;
+        }
+        if (i >= srcSize) {
+            break;
+        }
+
+        if (src[i] < 0x80) {
+            *dst++ = (wchar_t)src[i++];
+            continue;
+        }
+
+        SIZE_T length;
+        UINT32 cp = DxcUtf8_DecodeSlow(src + i, srcSize - i, &length);
+        i += length;
+        if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+            cp -= 0x10000;
+            *dst++ = (wchar_t)(0xD800 | (cp >> 10));
+            *dst++ = (wchar_t)(0xDC00 | (cp & 0x3FF));
+        }
+        else {
+            *dst++ = (wchar_t)cp;
+        }
+    }
+    return (SIZE_T)(dst - pDst);
+}
+
+// Converts length wchar_t to UTF-8 and returns the number of bytes written,
+// without a terminator. pDst must hold length * 4 bytes. Surrogate pairs are
+// joined; unpaired surrogates and values past U+10FFFF become U+FFFD, as in
+// DxcUtf8_ToWide.
+static inline SIZE_T DxcUtf8_FromWide(const wchar_t *pSrc, SIZE_T length, char *pDst) {
+    BYTE *dst = (BYTE*)pDst;
+    for (SIZE_T i = 0; i < length; ++i) {
+        UINT32 c = (UINT32)pSrc[i];
+        if (c < 0x80) {
+            *dst++ = (BYTE)c;
+            continue;
+        }
+
+        if (sizeof(wchar_t) == 2 && c >= 0xD800 && c < 0xDC00 && i + 1 < length &&
+            (UINT32)pSrc[i + 1] >= 0xDC00 && (UINT32)pSrc[i + 1] < 0xE000) {
+            c = 0x10000 + ((c - 0xD800) << 10) + ((UINT32)pSrc[++i] - 0xDC00);
+        }
+        else if ((c >= 0xD800 && c < 0xE000) || c > 0x10FFFF) {
+            c = 0xFFFD;
+        }
+
+        if (c < 0x800) {
+            *dst++ = (BYTE)(0xC0 | (c >> 6));
+            *dst++ = (BYTE)(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000) {
+            *dst++ = (BYTE)(0xE0 | (c >> 12));
+            *dst++ = (BYTE)(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = (BYTE)(0x80 | (c & 0x3F));
+        }
+        else {
+            *dst++ = (BYTE)(0xF0 | (c >> 18));
+            *dst++ = (BYTE)(0x80 | ((c >> 12) & 0x3F));
+            *dst++ = (BYTE)(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = (BYTE)(0x80 | (c & 0x3F));
+        }
+    }
+    return (SIZE_T)(dst - (BYTE*)pDst);
+}
+
+// Returns the number of bytes DxcArgs_Init needs for the given limits
+static inline SIZE_T DxcArgs_GetRequiredSize(UINT32 maxArguments, UINT32 maxDefines, SIZE_T maxChars) {
+    return (SIZE_T)maxArguments * sizeof(LPCWSTR) + (SIZE_T)maxDefines * sizeof(DxcDefine) + maxChars * sizeof(wchar_t) + sizeof(void*);
+}
+
+// Carves pMemory into the argument array, the define list and character
+// storage. Whatever is left after the two arrays holds converted strings.
+static inline HRESULT DxcArgs_Init(DxcArgs *args, void *pMemory, SIZE_T size, UINT32 maxArguments, UINT32 maxDefines) {
+    if (!args || !pMemory) {
+        return E_INVALIDARG;
+    }
+
+    BYTE *base = (BYTE*)pMemory;
+    SIZE_T misalign = (SIZE_T)((uintptr_t)base % sizeof(void*));
+    SIZE_T skip = misalign ? sizeof(void*) - misalign : 0;
+    SIZE_T arrays = (SIZE_T)maxArguments * sizeof(LPCWSTR) + (SIZE_T)maxDefines * sizeof(DxcDefine);
+    if (size < skip + arrays) {
+        return E_INVALIDARG;
+    }
+
+    memset(args, 0, sizeof(DxcArgs));
+    args->pArguments = (LPCWSTR*)(base + skip);
+    args->MaxArguments = maxArguments;
+    args->pDefines = (DxcDefine*)(args->pArguments + maxArguments);
+    args->MaxDefines = maxDefines;
+    args->pChars = (wchar_t*)(args->pDefines + maxDefines);
+    args->CharCapacity = (size - skip - arrays) / sizeof(wchar_t);
+    args->Status = S_OK;
+    return S_OK;
+}
+
+// Forgets every argument, define and string so the memory can be reused
+static inline void DxcArgs_Reset(DxcArgs *args) {
+    args->ArgCount = 0;
+    args->DefineCount = 0;
+    args->CharCount = 0;
+    args->Status = S_OK;
+}
+
+// Borrows a wide argument such as DXC_ARG_DEBUG; it must outlive the compile
+static inline HRESULT DxcArgs_Add(DxcArgs *args, LPCWSTR pArgument) {
+    if (FAILED(args->Status)) {
+        return args->Status;
+    }
+    if (args->ArgCount == args->MaxArguments) {
+        return args->Status = E_OUTOFMEMORY;
+    }
+    args->pArguments[args->ArgCount++] = pArgument;
+    return S_OK;
+}
+
+static inline HRESULT DxcArgs_AddList(DxcArgs *args, const LPCWSTR *pArguments, UINT32 argCount) {
+    if (FAILED(args->Status)) {
+        return args->Status;
+    }
+    if (argCount > args->MaxArguments - args->ArgCount) {
+        return args->Status = E_OUTOFMEMORY;
+    }
+    memcpy(args->pArguments + args->ArgCount, pArguments, argCount * sizeof(LPCWSTR));
+    args->ArgCount += argCount;
+    return S_OK;
+}
+
+// Converts up to two UTF-8 strings, joined by separator when pSecond is
+// given, into character storage and returns the terminated wide string
+static inline LPCWSTR DxcArgs_Convert(DxcArgs *args, const char *pFirst, wchar_t separator, const char *pSecond) {
+    SIZE_T firstSize = strlen(pFirst);
+    SIZE_T secondSize = pSecond ? strlen(pSecond) : 0;
+    SIZE_T worstCase = firstSize + (pSecond ? 1 + secondSize : 0) + 1;
+    if (FAILED(args->Status) || worstCase > args->CharCapacity - args->CharCount) {
+        args->Status = E_OUTOFMEMORY;
+        return NULL;
+    }
+
+    wchar_t *start = args->pChars + args->CharCount;
+    wchar_t *dst = start + DxcUtf8_ToWide(pFirst, firstSize, start);
+    if (pSecond) {
+        *dst++ = separator;
+        dst += DxcUtf8_ToWide(pSecond, secondSize, dst);
+    }
+    *dst++ = L'\0';
+    args->CharCount += (SIZE_T)(dst - start);
+    return start;
+}
+
+// Copies a UTF-8 argument
+static inline HRESULT DxcArgs_AddUtf8(DxcArgs *args, const char *pArgument) {
+    if (args->ArgCount == args->MaxArguments) {
+        return args->Status = E_OUTOFMEMORY;
+    }
+    LPCWSTR argument = DxcArgs_Convert(args, pArgument, 0, NULL);
+    return argument ? DxcArgs_Add(args, argument) : args->Status;
+}
+
+// Adds a borrowed option followed by a copied UTF-8 value, e.g. L"-Fo" "out.bin"
+static inline HRESULT DxcArgs_AddOption(DxcArgs *args, LPCWSTR pOption, const char *pValue) {
+    if (args->MaxArguments - args->ArgCount < 2) {
+        return args->Status = E_OUTOFMEMORY;
+    }
+    LPCWSTR value = DxcArgs_Convert(args, pValue, 0, NULL);
+    if (!value) {
+        return args->Status;
+    }
+    DxcArgs_Add(args, pOption);
+    return DxcArgs_Add(args, value);
+}
+
+// The source name is positional, as in IDxcUtils_BuildArguments
+static inline HRESULT DxcArgs_AddSourceName(DxcArgs *args, const char *pSourceName) { return DxcArgs_AddUtf8(args, pSourceName); }
+static inline HRESULT DxcArgs_AddEntryPoint(DxcArgs *args, const char *pEntryPoint) { return DxcArgs_AddOption(args, L"-E", pEntryPoint); }
+static inline HRESULT DxcArgs_AddTargetProfile(DxcArgs *args, const char *pTargetProfile) { return DxcArgs_AddOption(args, L"-T", pTargetProfile); }
+
+// Adds "-D" "Name=Value" (or "-D" "Name" when pValue is NULL) to the arguments
+static inline HRESULT DxcArgs_AddDefine(DxcArgs *args, const char *pName, const char *pValue) {
+    if (args->MaxArguments - args->ArgCount < 2) {
+        return args->Status = E_OUTOFMEMORY;
+    }
+    LPCWSTR define = DxcArgs_Convert(args, pName, L'=', pValue);
+    if (!define) {
+        return args->Status;
+    }
+    DxcArgs_Add(args, L"-D");
+    return DxcArgs_Add(args, define);
+}
+
+// Appends to the DxcDefine list passed to IDxcCompiler_Compile and friends
+static inline HRESULT DxcArgs_AddDefineEntry(DxcArgs *args, const char *pName, const char *pValue) {
+    if (FAILED(args->Status)) {
+        return args->Status;
+    }
+    if (args->DefineCount == args->MaxDefines) {
+        return args->Status = E_OUTOFMEMORY;
+    }
+    LPCWSTR name = DxcArgs_Convert(args, pName, 0, NULL);
+    LPCWSTR value = name && pValue ? DxcArgs_Convert(args, pValue, 0, NULL) : NULL;
+    if (!name || (pValue && !value)) {
+        return args->Status;
+    }
+    args->pDefines[args->DefineCount].Name = name;
+    args->pDefines[args->DefineCount].Value = value;
+    args->DefineCount++;
+    return S_OK;
+}
+
+#endif /* __DXC_ARGS_C__ */
@@ -0,0 +1,600 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_async.h                                                             //
+// Asynchronous IDxcCompiler3_Compile with a pollable completion queue       //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_ASYNC_C__
+#define __DXC_ASYNC_C__
+
+#include "dxc_c.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#if defined(__linux__)
+    #include <sys/eventfd.h>
+#endif
+
+// NOTE: Requires POSIX threads. DxcAsync_Submit copies the job's source and
+// arguments, queues it and returns a ticket immediately; a fixed set of
+// background threads, each with its own IDxcCompiler3, compiles pending jobs
+// highest priority first and FIFO within a priority. Every ticket produces
+// exactly one completion, including cancelled jobs, and tickets become invalid
+// once their completion has been taken with DxcAsync_PollCompletions.
+//
+// DxcAsync_GetEventFd returns a descriptor that is readable while completions
+// are queued, so it can sit in an epoll set or an io_uring poll next to the
+// application's other sources. It is an eventfd on Linux and the read end of a
+// pipe elsewhere; either way, only DxcAsync_PollCompletions should drain it.
+//
+// Pending jobs can be cancelled or reprioritized, for example to move the
+// shader the user just saved to the front. A job that has already started
+// runs to completion, since IDxcCompiler3_Compile cannot be interrupted. Job
+// include handlers are called from the background threads.
+
+#define DXC_ASYNC_E_CANCELLED ((HRESULT)0x800704C7) // HRESULT_FROM_WIN32(ERROR_CANCELLED)
+
+// --- Structs ----------------------------------------------------------------
+typedef UINT64 DxcAsyncTicket; // 0 is never a valid ticket
+
+typedef struct DxcAsyncJob {
+    DxcBuffer           Source;          // Copied by DxcAsync_Submit
+    LPCWSTR            *pArguments;      // Copied by DxcAsync_Submit
+    UINT32              ArgCount;
+    IDxcIncludeHandler *pIncludeHandler; // NULL uses the thread's default include handler, must be thread-safe
+    INT32               Priority;        // Higher runs first
+    void               *pUserData;       // Returned with the completion
+} DxcAsyncJob;
+
+typedef struct DxcAsyncCompletion {
+    DxcAsyncTicket Ticket;
+    HRESULT        Status;    // Return value of IDxcCompiler3_Compile, or DXC_ASYNC_E_CANCELLED
+    IDxcResult    *pResult;   // Owned by the caller, release with IDxcResult_Release; NULL if cancelled
+    void          *pUserData;
+} DxcAsyncCompletion;
+
+typedef struct DxcAsyncDesc {
+    DxcCreateInstanceProc pfnCreateInstance;
+    UINT32                ThreadCount; // 0 uses the number of online CPUs
+} DxcAsyncDesc;
+
+typedef enum DxcAsyncState {
+    DXC_ASYNC_STATE_FREE    = 0,
+    DXC_ASYNC_STATE_PENDING = 1,
+    DXC_ASYNC_STATE_RUNNING = 2,
+    DXC_ASYNC_STATE_DONE    = 3,
+} DxcAsyncState;
+
+typedef struct DxcAsyncRecord {
+    UINT32              Generation;
+    DxcAsyncState       State;
+    UINT32              HeapIndex; // Valid while pending
+    UINT32              Next;      // Free list or completion queue link
+    INT32               Priority;
+    UINT64              Sequence;
+    void               *pStorage;  // Copied arguments and source
+    DxcBuffer           Source;
+    LPCWSTR            *pArguments;
+    UINT32              ArgCount;
+    IDxcIncludeHandler *pIncludeHandler;
+    void               *pUserData;
+    HRESULT             Status;
+    IDxcResult         *pResult;
+} DxcAsyncRecord;
+
+typedef struct DxcAsync DxcAsync;
+
+typedef struct DxcAsyncWorker {
+    DxcAsync           *pAsync;
+    pthread_t           Thread;
+    IDxcCompiler3      *pCompiler;
+    IDxcUtils          *pUtils;
+    IDxcIncludeHandler *pDefaultIncludeHandler;
+} DxcAsyncWorker;
+
+struct DxcAsync {
+    DxcAsyncWorker *pWorkers;
+    UINT32          WorkerCount;
+    DxcAsyncRecord *pRecords;   // Addressed by index only, the array may move
+    UINT32          RecordCount;
+    UINT32          FreeHead;   // UINT32_MAX when empty
+    UINT32         *pHeap;      // Pending record indices, max-heap on (Priority, -Sequence)
+    UINT32          HeapCount;
+    UINT32          DoneHead;   // Completion queue in completion order
+    UINT32          DoneTail;
+    UINT64          NextSequence;  // Counts up from 2^63 for submitted jobs
+    UINT64          FrontSequence; // Counts down from 2^63 - 1 for jobs moved to the front
+    BOOL            Shutdown;
+    int             EventFd;    // Read end on platforms without eventfd
+    int             EventWriteFd;
+    pthread_mutex_t Lock;
+    pthread_cond_t  WorkCond;
+};
+
+#define DXC_ASYNC_NONE 0xFFFFFFFFu
+
+// --- Internals --------------------------------------------------------------
+static inline void DxcAsync_Signal(DxcAsync *async) {
+#if defined(__linux__)
+    UINT64 one = 1;
+    ssize_t written = write(async->EventWriteFd, &one, sizeof(one));
+#else
+    BYTE one = 1;
+    ssize_t written = write(async->EventWriteFd, &one, sizeof(one));
+#endif
+    (void)written; // A full pipe or a saturated counter is still readable
+}
+
+static inline void DxcAsync_ClearSignal(DxcAsync *async) {
+    BYTE buffer[64];
+    while (read(async->EventFd, buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+static inline BOOL DxcAsync_Before(const DxcAsyncRecord *a, const DxcAsyncRecord *b) {
+    return a->Priority != b->Priority ? a->Priority > b->Priority : a->Sequence < b->Sequence;
+}
+
+static inline void DxcAsync_HeapSet(DxcAsync *async, UINT32 position, UINT32 index) {
+    async->pHeap[position] = index;
+    async->pRecords[index].HeapIndex = position;
+}
+
+static inline void DxcAsync_SiftUp(DxcAsync *async, UINT32 position) {
+    UINT32 index = async->pHeap[position];
+    while (position > 0) {
+        UINT32 parent = (position - 1) / 2;
+        if (!DxcAsync_Before(&async->pRecords[index], &async->pRecords[async->pHeap[parent]])) {
+            break;
+        }
+        DxcAsync_HeapSet(async, position, async->pHeap[parent]);
+        position = parent;
+    }
+    DxcAsync_HeapSet(async, position, index);
+}
+
+static inline void DxcAsync_SiftDown(DxcAsync *async, UINT32 position) {
+    UINT32 index = async->pHeap[position];
+    for (;;) {
+        UINT32 child = position * 2 + 1;
+        if (child >= async->HeapCount) {
+            break;
+        }
+        if (child + 1 < async->HeapCount &&
+            DxcAsync_Before(&async->pRecords[async->pHeap[child + 1]], &async->pRecords[async->pHeap[child]])) {
+            child++;
+        }
+        if (!DxcAsync_Before(&async->pRecords[async->pHeap[child]], &async->pRecords[index])) {
+            break;
+        }
+        DxcAsync_HeapSet(async, position, async->pHeap[child]);
+        position = child;
+    }
+    DxcAsync_HeapSet(async, position, index);
+}
+
+static inline void DxcAsync_HeapRemove(DxcAsync *async, UINT32 position) {
+    UINT32 last = async->pHeap[--async->HeapCount];
+    if (position < async->HeapCount) {
+        DxcAsync_HeapSet(async, position, last);
+        DxcAsync_SiftUp(async, position);
+        DxcAsync_SiftDown(async, async->pRecords[last].HeapIndex);
+    }
+}
+
+// Must be called with async->Lock held
+static inline DxcAsyncRecord *DxcAsync_Lookup(DxcAsync *async, DxcAsyncTicket ticket, UINT32 *pIndex) {
+    UINT32 index = (UINT32)ticket;
+    if (index >= async->RecordCount) {
+        return NULL;
+    }
+    DxcAsyncRecord *record = &async->pRecords[index];
+    if (record->State == DXC_ASYNC_STATE_FREE || record->Generation != (UINT32)(ticket >> 32)) {
+        return NULL;
+    }
+    if (pIndex) {
+        *pIndex = index;
+    }
+    return record;
+}
+
+// Must be called with async->Lock held
+static inline void DxcAsync_Complete(DxcAsync *async, UINT32 index, HRESULT status, IDxcResult *pResult) {
+    DxcAsyncRecord *record = &async->pRecords[index];
+    record->State = DXC_ASYNC_STATE_DONE;
+    record->Status = status;
+    record->pResult = pResult;
+    record->Next = DXC_ASYNC_NONE;
+
+    if (async->DoneTail != DXC_ASYNC_NONE) {
+        async->pRecords[async->DoneTail].Next = index;
+    } else {
+        async->DoneHead = index;
+    }
+    async->DoneTail = index;
+
+    DxcAsync_Signal(async);
+}
+
+// Must be called with async->Lock held
+static inline void DxcAsync_FreeRecord(DxcAsync *async, UINT32 index) {
+    DxcAsyncRecord *record = &async->pRecords[index];
+    if (record->pIncludeHandler) {
+        IDxcIncludeHandler_Release(record->pIncludeHandler);
+    }
+    free(record->pStorage);
+
+    UINT32 generation = record->Generation + 1;
+    memset(record, 0, sizeof(DxcAsyncRecord));
+    record->Generation = generation ? generation : 1;
+    record->Next = async->FreeHead;
+    async->FreeHead = index;
+}
+
+static inline void *DxcAsync_WorkerMain(void *arg) {
+    DxcAsyncWorker *worker = (DxcAsyncWorker*)arg;
+    DxcAsync *async = worker->pAsync;
+
+    pthread_mutex_lock(&async->Lock);
+    for (;;) {
+        while (!async->Shutdown && async->HeapCount == 0) {
+            pthread_cond_wait(&async->WorkCond, &async->Lock);
+        }
+        if (async->Shutdown) {
+            break;
+        }
+
+        UINT32 index = async->pHeap[0];
+        DxcAsync_HeapRemove(async, 0);
+        DxcAsyncRecord *record = &async->pRecords[index];
+        record->State = DXC_ASYNC_STATE_RUNNING;
+
+        // The storage and include handler stay put while the record is running
+        DxcBuffer source = record->Source;
+        LPCWSTR *arguments = record->pArguments;
+        UINT32 argCount = record->ArgCount;
+        IDxcIncludeHandler *includeHandler = record->pIncludeHandler ? record->pIncludeHandler : worker->pDefaultIncludeHandler;
+        pthread_mutex_unlock(&async->Lock);
+
+        IDxcResult *result = NULL;
+        HRESULT status = IDxcCompiler3_Compile(worker->pCompiler, &source, arguments, argCount, includeHandler,
+                                               &IID_IDxcResult, (void**)&result);
+
+        pthread_mutex_lock(&async->Lock);
+        DxcAsync_Complete(async, index, status, result);
+    }
+    pthread_mutex_unlock(&async->Lock);
+
+    return NULL;
+}
+
+static inline void DxcAsync_ReleaseWorker(DxcAsyncWorker *worker) {
+    if (worker->pDefaultIncludeHandler) { IDxcIncludeHandler_Release(worker->pDefaultIncludeHandler); }
+    if (worker->pUtils)                 { IDxcUtils_Release(worker->pUtils); }
+    if (worker->pCompiler)              { IDxcCompiler3_Release(worker->pCompiler); }
+}
+
+// --- Methods ----------------------------------------------------------------
+// Stops the threads after their current compile. Pending jobs are dropped and
+// completions that were never polled are released.
+static inline void DxcAsync_Destroy(DxcAsync *async) {
+    if (!async) {
+        return;
+    }
+
+    pthread_mutex_lock(&async->Lock);
+    async->Shutdown = 1;
+    pthread_cond_broadcast(&async->WorkCond);
+    pthread_mutex_unlock(&async->Lock);
+
+    for (UINT32 i = 0; i < async->WorkerCount; ++i) {
+        pthread_join(async->pWorkers[i].Thread, NULL);
+        DxcAsync_ReleaseWorker(&async->pWorkers[i]);
+    }
+
+    for (UINT32 i = 0; i < async->RecordCount; ++i) {
+        DxcAsyncRecord *record = &async->pRecords[i];
+        if (record->State != DXC_ASYNC_STATE_FREE) {
+            if (record->pResult) {
+                IDxcResult_Release(record->pResult);
+            }
+            DxcAsync_FreeRecord(async, i);
+        }
+    }
+
+    if (async->EventWriteFd >= 0 && async->EventWriteFd != async->EventFd) {
+        close(async->EventWriteFd);
+    }
+    if (async->EventFd >= 0) {
+        close(async->EventFd);
+    }
+
+    pthread_cond_destroy(&async->WorkCond);
+    pthread_mutex_destroy(&async->Lock);
+    free(async->pHeap);
+    free(async->pRecords);
+    free(async->pWorkers);
+    free(async);
+}
+
+static inline HRESULT DxcAsync_Create(const DxcAsyncDesc *pDesc, DxcAsync **ppAsync) {
+    if (!pDesc || !pDesc->pfnCreateInstance || !ppAsync) {
+        return E_INVALIDARG;
+    }
+
+    *ppAsync = NULL;
+
+    UINT32 threadCount = pDesc->ThreadCount;
+    if (threadCount == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = cpus > 0 ? (UINT32)cpus : 1;
+    }
+
+    DxcAsync *async = (DxcAsync*)calloc(1, sizeof(DxcAsync));
+    DxcAsyncWorker *workers = (DxcAsyncWorker*)calloc(threadCount, sizeof(DxcAsyncWorker));
+    if (!async || !workers) {
+        free(workers);
+        free(async);
+        return E_OUTOFMEMORY;
+    }
+
+    async->pWorkers = workers;
+    async->FreeHead = DXC_ASYNC_NONE;
+    async->DoneHead = DXC_ASYNC_NONE;
+    async->DoneTail = DXC_ASYNC_NONE;
+    async->NextSequence = 1ull << 63;
+    async->FrontSequence = (1ull << 63) - 1;
+    async->EventFd = -1;
+    async->EventWriteFd = -1;
+    pthread_mutex_init(&async->Lock, NULL);
+    pthread_cond_init(&async->WorkCond, NULL);
+
+    HRESULT hr = S_OK;
+#if defined(__linux__)
+    async->EventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    async->EventWriteFd = async->EventFd;
+    if (async->EventFd < 0) {
+        hr = E_FAIL;
+    }
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+        async->EventFd = fds[0];
+        async->EventWriteFd = fds[1];
+        for (int i = 0; i < 2; ++i) {
+            fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        }
+    } else {
+        hr = E_FAIL;
+    }
+#endif
+
+    for (UINT32 i = 0; i < threadCount && SUCCEEDED(hr); ++i) {
+        DxcAsyncWorker *worker = &workers[i];
+        worker->pAsync = async;
+
+        hr = pDesc->pfnCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, (LPVOID*)&worker->pCompiler);
+        if (SUCCEEDED(hr)) { hr = pDesc->pfnCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, (LPVOID*)&worker->pUtils); }
+        if (SUCCEEDED(hr)) { hr = IDxcUtils_CreateDefaultIncludeHandler(worker->pUtils, &worker->pDefaultIncludeHandler); }
+        if (SUCCEEDED(hr) && pthread_create(&worker->Thread, NULL, DxcAsync_WorkerMain, worker) != 0) {
+            hr = E_FAIL;
+        }
+
+        if (FAILED(hr)) {
+            DxcAsync_ReleaseWorker(worker);
+            break;
+        }
+
+        async->WorkerCount = i + 1;
+    }
+
+    if (FAILED(hr)) {
+        DxcAsync_Destroy(async);
+        return hr;
+    }
+
+    *ppAsync = async;
+    return S_OK;
+}
+
+// Readable while at least one completion is waiting in DxcAsync_PollCompletions
+static inline int DxcAsync_GetEventFd(DxcAsync *async) { return async->EventFd; }
+
+static inline HRESULT DxcAsync_Submit(DxcAsync *async, const DxcAsyncJob *pJob, DxcAsyncTicket *pTicket) {
+    if (!async || !pJob || !pTicket || (pJob->ArgCount && !pJob->pArguments) || (pJob->Source.Size && !pJob->Source.Ptr)) {
+        return E_INVALIDARG;
+    }
+
+    *pTicket = 0;
+
+    SIZE_T size = pJob->ArgCount * sizeof(LPCWSTR) + pJob->Source.Size;
+    for (UINT32 i = 0; i < pJob->ArgCount; ++i) {
+        size += (wcslen(pJob->pArguments[i]) + 1) * sizeof(WCHAR);
+    }
+
+    BYTE *storage = (BYTE*)malloc(size ? size : 1);
+    if (!storage) {
+        return E_OUTOFMEMORY;
+    }
+
+    LPCWSTR *arguments = (LPCWSTR*)storage;
+    BYTE *cursor = storage + pJob->ArgCount * sizeof(LPCWSTR);
+    for (UINT32 i = 0; i < pJob->ArgCount; ++i) {
+        SIZE_T argSize = (wcslen(pJob->pArguments[i]) + 1) * sizeof(WCHAR);
+        memcpy(cursor, pJob->pArguments[i], argSize);
+        arguments[i] = (LPCWSTR)cursor;
+        cursor += argSize;
+    }
+    if (pJob->Source.Size) {
+        memcpy(cursor, pJob->Source.Ptr, pJob->Source.Size);
+    }
+
+    pthread_mutex_lock(&async->Lock);
+
+    HRESULT hr = S_OK;
+    if (async->FreeHead == DXC_ASYNC_NONE) {
+        UINT32 capacity = async->RecordCount ? async->RecordCount * 2 : 64;
+        DxcAsyncRecord *records = (DxcAsyncRecord*)realloc(async->pRecords, capacity * sizeof(DxcAsyncRecord));
+        UINT32 *heap = records ? (UINT32*)realloc(async->pHeap, capacity * sizeof(UINT32)) : NULL;
+        if (records) {
+            async->pRecords = records;
+        }
+        if (heap) {
+            async->pHeap = heap;
+            for (UINT32 i = capacity; i-- > async->RecordCount;) {
+                memset(&records[i], 0, sizeof(DxcAsyncRecord));
+                records[i].Generation = 1;
+                records[i].Next = async->FreeHead;
+                async->FreeHead = i;
+            }
+            async->RecordCount = capacity;
+        } else {
+            hr = E_OUTOFMEMORY;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        UINT32 index = async->FreeHead;
+        DxcAsyncRecord *record = &async->pRecords[index];
+        async->FreeHead = record->Next;
+
+        record->State = DXC_ASYNC_STATE_PENDING;
+        record->Priority = pJob->Priority;
+        record->Sequence = async->NextSequence++;
+        record->pStorage = storage;
+        record->Source.Ptr = cursor;
+        record->Source.Size = pJob->Source.Size;
+        record->Source.Encoding = pJob->Source.Encoding;
+        record->pArguments = arguments;
+        record->ArgCount = pJob->ArgCount;
+        record->pIncludeHandler = pJob->pIncludeHandler;
+        record->pUserData = pJob->pUserData;
+        if (record->pIncludeHandler) {
+            IDxcIncludeHandler_AddRef(record->pIncludeHandler);
+        }
+
+        async->pHeap[async->HeapCount] = index;
+        DxcAsync_SiftUp(async, async->HeapCount++);
+        pthread_cond_signal(&async->WorkCond);
+
+        *pTicket = ((UINT64)record->Generation << 32) | index;
+    }
+
+    pthread_mutex_unlock(&async->Lock);
+
+    if (FAILED(hr)) {
+        free(storage);
+    }
+    return hr;
+}
+
+// Cancels a pending job, which then completes with DXC_ASYNC_E_CANCELLED.
+// Returns S_FALSE if the job has already started or finished.
+static inline HRESULT DxcAsync_Cancel(DxcAsync *async, DxcAsyncTicket ticket) {
+    if (!async) {
+        return E_INVALIDARG;
+    }
+
+    pthread_mutex_lock(&async->Lock);
+    UINT32 index = 0;
+    DxcAsyncRecord *record = DxcAsync_Lookup(async, ticket, &index);
+    HRESULT hr = record ? S_FALSE : E_INVALIDARG;
+    if (record && record->State == DXC_ASYNC_STATE_PENDING) {
+        DxcAsync_HeapRemove(async, record->HeapIndex);
+        DxcAsync_Complete(async, index, DXC_ASYNC_E_CANCELLED, NULL);
+        hr = S_OK;
+    }
+    pthread_mutex_unlock(&async->Lock);
+
+    return hr;
+}
+
+// Changes the priority of a pending job. Among jobs of equal priority the
+// job keeps its submission order. Returns S_FALSE if it is no longer pending.
+static inline HRESULT DxcAsync_Reprioritize(DxcAsync *async, DxcAsyncTicket ticket, INT32 priority) {
+    if (!async) {
+        return E_INVALIDARG;
+    }
+
+    pthread_mutex_lock(&async->Lock);
+    DxcAsyncRecord *record = DxcAsync_Lookup(async, ticket, NULL);
+    HRESULT hr = record ? S_FALSE : E_INVALIDARG;
+    if (record && record->State == DXC_ASYNC_STATE_PENDING) {
+        record->Priority = priority;
+        DxcAsync_SiftUp(async, record->HeapIndex);
+        DxcAsync_SiftDown(async, record->HeapIndex);
+        hr = S_OK;
+    }
+    pthread_mutex_unlock(&async->Lock);
+
+    return hr;
+}
+
+// Moves a pending job ahead of everything currently pending
+static inline HRESULT DxcAsync_MoveToFront(DxcAsync *async, DxcAsyncTicket ticket) {
+    if (!async) {
+        return E_INVALIDARG;
+    }
+
+    pthread_mutex_lock(&async->Lock);
+    DxcAsyncRecord *record = DxcAsync_Lookup(async, ticket, NULL);
+    HRESULT hr = record ? S_FALSE : E_INVALIDARG;
+    if (record && record->State == DXC_ASYNC_STATE_PENDING) {
+        const DxcAsyncRecord *front = &async->pRecords[async->pHeap[0]];
+        if (front != record) {
+            record->Priority = front->Priority;
+            record->Sequence = async->FrontSequence--;
+            DxcAsync_SiftUp(async, record->HeapIndex);
+        }
+        hr = S_OK;
+    }
+    pthread_mutex_unlock(&async->Lock);
+
+    return hr;
+}
+
+// Takes up to maxCompletions finished jobs in completion order and returns
+// how many were written. Never blocks; wait on DxcAsync_GetEventFd instead.
+static inline UINT32 DxcAsync_PollCompletions(DxcAsync *async, DxcAsyncCompletion *pCompletions, UINT32 maxCompletions) {
+    UINT32 count = 0;
+
+    pthread_mutex_lock(&async->Lock);
+    DxcAsync_ClearSignal(async);
+    while (count < maxCompletions && async->DoneHead != DXC_ASYNC_NONE) {
+        UINT32 index = async->DoneHead;
+        DxcAsyncRecord *record = &async->pRecords[index];
+        async->DoneHead = record->Next;
+        if (async->DoneHead == DXC_ASYNC_NONE) {
+            async->DoneTail = DXC_ASYNC_NONE;
+        }
+
+        DxcAsyncCompletion *completion = &pCompletions[count++];
+        completion->Ticket = ((UINT64)record->Generation << 32) | index;
+        completion->Status = record->Status;
+        completion->pResult = record->pResult;
+        completion->pUserData = record->pUserData;
+        record->pResult = NULL;
+        DxcAsync_FreeRecord(async, index);
+    }
+    if (async->DoneHead != DXC_ASYNC_NONE) {
+        DxcAsync_Signal(async);
+    }
+    pthread_mutex_unlock(&async->Lock);
+
+    return count;
+}
+
+#endif /* __DXC_ASYNC_C__ */
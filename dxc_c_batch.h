@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_batch.h                                                             //
+// Parallel batch compilation on top of IDxcCompiler3_Compile                //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_BATCH_C__
+#define __DXC_BATCH_C__
+
+#include "dxc_c.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX threads. Every worker owns a private IDxcCompiler3 and
+// IDxcUtils, so no DXC object is ever shared between threads. Jobs are split
+// into one contiguous range per worker; idle workers steal the back half of
+// another worker's remaining range.
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcBatchJob {
+    DxcBuffer           Source;
+    LPCWSTR            *pArguments;
+    UINT32              ArgCount;
+    IDxcIncludeHandler *pIncludeHandler; // NULL uses the worker's default include handler
+} DxcBatchJob;
+
+typedef struct DxcBatchResult {
+    HRESULT     Status;  // Return value of IDxcCompiler3_Compile
+    IDxcResult *pResult; // Owned by the caller, release with IDxcResult_Release
+} DxcBatchResult;
+
+typedef struct DxcBatchDesc {
+    DxcCreateInstanceProc pfnCreateInstance;
+    UINT32                ThreadCount; // 0 uses the number of online CPUs
+} DxcBatchDesc;
+
+typedef struct DxcBatch DxcBatch;
+
+typedef struct DxcBatchWorker {
+    DxcBatch           *pBatch;
+    pthread_t           Thread;
+    pthread_mutex_t     Lock;  // Guards Begin and End
+    UINT32              Begin; // Pending job range [Begin, End)
+    UINT32              End;
+    UINT32              Index;
+    IDxcCompiler3      *pCompiler;
+    IDxcUtils          *pUtils;
+    IDxcIncludeHandler *pDefaultIncludeHandler;
+} DxcBatchWorker;
+
+struct DxcBatch {
+    DxcBatchWorker    *pWorkers;
+    UINT32             WorkerCount;
+    UINT32             ActiveWorkers;
+    UINT64             Generation;
+    BOOL               Shutdown;
+    const DxcBatchJob *pJobs;
+    DxcBatchResult    *pResults;
+    pthread_mutex_t    SubmitLock; // Serializes DxcBatch_Compile callers
+    pthread_mutex_t    Lock;
+    pthread_cond_t     WorkCond;
+    pthread_cond_t     DoneCond;
+};
+
+// --- Internals --------------------------------------------------------------
+static inline BOOL DxcBatch_PopJob(DxcBatchWorker *worker, UINT32 *pJobIndex) {
+    BOOL found = 0;
+
+    pthread_mutex_lock(&worker->Lock);
+    if (worker->Begin < worker->End) {
+        *pJobIndex = worker->Begin++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&worker->Lock);
+
+    return found;
+}
+
+static inline BOOL DxcBatch_StealJobs(DxcBatchWorker *worker) {
+    DxcBatch *batch = worker->pBatch;
+
+    for (UINT32 i = 1; i < batch->WorkerCount; ++i) {
+        DxcBatchWorker *victim = &batch->pWorkers[(worker->Index + i) % batch->WorkerCount];
+        UINT32 begin = 0;
+        UINT32 end = 0;
+
+        pthread_mutex_lock(&victim->Lock);
+        if (victim->Begin < victim->End) {
+            end = victim->End;
+            begin = end - (end - victim->Begin + 1) / 2;
+            victim->End = begin;
+        }
+        pthread_mutex_unlock(&victim->Lock);
+
+        if (begin < end) {
+            pthread_mutex_lock(&worker->Lock);
+            worker->Begin = begin;
+            worker->End = end;
+            pthread_mutex_unlock(&worker->Lock);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static inline void DxcBatch_RunJob(DxcBatchWorker *worker, UINT32 jobIndex) {
+    const DxcBatchJob *job = &worker->pBatch->pJobs[jobIndex];
+    DxcBatchResult *result = &worker->pBatch->pResults[jobIndex];
+    IDxcIncludeHandler *includeHandler = job->pIncludeHandler ? job->pIncludeHandler : worker->pDefaultIncludeHandler;
+
+    result->pResult = NULL;
+    result->Status = IDxcCompiler3_Compile(worker->pCompiler, &job->Source, job->pArguments, job->ArgCount,
+                                           includeHandler, &IID_IDxcResult, (void**)&result->pResult);
+}
+
+static inline void *DxcBatch_WorkerMain(void *arg) {
+    DxcBatchWorker *worker = (DxcBatchWorker*)arg;
+    DxcBatch *batch = worker->pBatch;
+    UINT64 generation = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->Lock);
+        while (!batch->Shutdown && batch->Generation == generation) {
+            pthread_cond_wait(&batch->WorkCond, &batch->Lock);
+        }
+        if (batch->Shutdown) {
+            pthread_mutex_unlock(&batch->Lock);
+            return NULL;
+        }
+        generation = batch->Generation;
+        pthread_mutex_unlock(&batch->Lock);
+
+        for (;;) {
+            UINT32 jobIndex;
+            if (DxcBatch_PopJob(worker, &jobIndex)) {
+                DxcBatch_RunJob(worker, jobIndex);
+            }
+            else if (!DxcBatch_StealJobs(worker)) {
+                break;
+            }
+        }
+
+        pthread_mutex_lock(&batch->Lock);
+        if (--batch->ActiveWorkers == 0) {
+            pthread_cond_signal(&batch->DoneCond);
+        }
+        pthread_mutex_unlock(&batch->Lock);
+    }
+}
+
+static inline void DxcBatch_ReleaseWorker(DxcBatchWorker *worker) {
+    if (worker->pDefaultIncludeHandler) { IDxcIncludeHandler_Release(worker->pDefaultIncludeHandler); }
+    if (worker->pUtils)                 { IDxcUtils_Release(worker->pUtils); }
+    if (worker->pCompiler)              { IDxcCompiler3_Release(worker->pCompiler); }
+    pthread_mutex_destroy(&worker->Lock);
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline void DxcBatch_Destroy(DxcBatch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    pthread_mutex_lock(&batch->Lock);
+    batch->Shutdown = 1;
+    pthread_cond_broadcast(&batch->WorkCond);
+    pthread_mutex_unlock(&batch->Lock);
+
+    for (UINT32 i = 0; i < batch->WorkerCount; ++i) {
+        pthread_join(batch->pWorkers[i].Thread, NULL);
+        DxcBatch_ReleaseWorker(&batch->pWorkers[i]);
+    }
+
+    pthread_cond_destroy(&batch->DoneCond);
+    pthread_cond_destroy(&batch->WorkCond);
+    pthread_mutex_destroy(&batch->Lock);
+    pthread_mutex_destroy(&batch->SubmitLock);
+    free(batch->pWorkers);
+    free(batch);
+}
+
+static inline HRESULT DxcBatch_Create(const DxcBatchDesc *pDesc, DxcBatch **ppBatch) {
+    if (!pDesc || !pDesc->pfnCreateInstance || !ppBatch) {
+        return E_INVALIDARG;
+    }
+
+    *ppBatch = NULL;
+
+    UINT32 threadCount = pDesc->ThreadCount;
+    if (threadCount == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = cpus > 0 ? (UINT32)cpus : 1;
+    }
+
+    DxcBatch *batch = (DxcBatch*)calloc(1, sizeof(DxcBatch));
+    DxcBatchWorker *workers = (DxcBatchWorker*)calloc(threadCount, sizeof(DxcBatchWorker));
+    if (!batch || !workers) {
+        free(workers);
+        free(batch);
+        return E_OUTOFMEMORY;
+    }
+
+    batch->pWorkers = workers;
+    pthread_mutex_init(&batch->SubmitLock, NULL);
+    pthread_mutex_init(&batch->Lock, NULL);
+    pthread_cond_init(&batch->WorkCond, NULL);
+    pthread_cond_init(&batch->DoneCond, NULL);
+
+    HRESULT hr = S_OK;
+    for (UINT32 i = 0; i < threadCount; ++i) {
+        DxcBatchWorker *worker = &workers[i];
+        worker->pBatch = batch;
+        worker->Index = i;
+        pthread_mutex_init(&worker->Lock, NULL);
+
+        hr = pDesc->pfnCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, (LPVOID*)&worker->pCompiler);
+        if (SUCCEEDED(hr)) { hr = pDesc->pfnCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, (LPVOID*)&worker->pUtils); }
+        if (SUCCEEDED(hr)) { hr = IDxcUtils_CreateDefaultIncludeHandler(worker->pUtils, &worker->pDefaultIncludeHandler); }
+        if (SUCCEEDED(hr) && pthread_create(&worker->Thread, NULL, DxcBatch_WorkerMain, worker) != 0) {
+            hr = E_FAIL;
+        }
+
+        if (FAILED(hr)) {
+            DxcBatch_ReleaseWorker(worker);
+            break;
+        }
+
+        batch->WorkerCount = i + 1;
+    }
+
+    if (FAILED(hr)) {
+        DxcBatch_Destroy(batch);
+        return hr;
+    }
+
+    *ppBatch = batch;
+    return S_OK;
+}
+
+// Compiles pJobs[0..jobCount) and writes pResults[i] for pJobs[i]. Blocks until
+// every job has finished. Per-job failures are reported through pResults, the
+// return value only covers invalid arguments.
+static inline HRESULT DxcBatch_Compile(DxcBatch *batch, const DxcBatchJob *pJobs, UINT32 jobCount, DxcBatchResult *pResults) {
+    if (!batch || (jobCount && (!pJobs || !pResults))) {
+        return E_INVALIDARG;
+    }
+    if (jobCount == 0) {
+        return S_OK;
+    }
+
+    pthread_mutex_lock(&batch->SubmitLock);
+
+    // Workers are parked, so their ranges can be assigned without contention
+    UINT32 begin = 0;
+    for (UINT32 i = 0; i < batch->WorkerCount; ++i) {
+        UINT32 end = (UINT32)(((UINT64)jobCount * (i + 1)) / batch->WorkerCount);
+        pthread_mutex_lock(&batch->pWorkers[i].Lock);
+        batch->pWorkers[i].Begin = begin;
+        batch->pWorkers[i].End = end;
+        pthread_mutex_unlock(&batch->pWorkers[i].Lock);
+        begin = end;
+    }
+
+    pthread_mutex_lock(&batch->Lock);
+    batch->pJobs = pJobs;
+    batch->pResults = pResults;
+    batch->ActiveWorkers = batch->WorkerCount;
+    batch->Generation++;
+    pthread_cond_broadcast(&batch->WorkCond);
+    while (batch->ActiveWorkers > 0) {
+        pthread_cond_wait(&batch->DoneCond, &batch->Lock);
+    }
+    batch->pJobs = NULL;
+    batch->pResults = NULL;
+    pthread_mutex_unlock(&batch->Lock);
+
+    pthread_mutex_unlock(&batch->SubmitLock);
+    return S_OK;
+}
+
+#endif /* __DXC_BATCH_C__ */
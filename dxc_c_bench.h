@@ -0,0 +1,384 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_bench.h                                                             //
+// Dispatch, blob and batch throughput benchmarks with JSON Lines output     //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_BENCH_C__
+#define __DXC_BENCH_C__
+
+#include "dxc_c.h"
+#include "dxc_c_batch.h"
+#include "dxc_c_loader.h"
+#include "dxc_c_standin.h"
+#include "dxc_c_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX threads. DxcBench_Run measures the cost of the
+// wrappers on top of whatever DxcCreateInstanceProc it is given: a
+// dxc_c_standin.h instance to isolate dispatch overhead, or a real
+// libdxcompiler.so to track end-to-end numbers. Each measurement is written
+// as one JSON object per line:
+//
+//   {"benchmark":"blob.create_release","backend":"standin","threads":1,
+//    "operations":100000,"total_ns":...,"ns_per_op":...,"ops_per_sec":...}
+//
+// Benchmarks:
+//   dispatch.baseline          indirect call through a plain function pointer
+//   dispatch.blob_size         IDxcBlob_GetBufferSize
+//   dispatch.addref_release    IDxcBlob_AddRef + IDxcBlob_Release
+//   dispatch.result_status     IDxcResult_GetStatus
+//   result.get_output          IDxcResult_GetOutput(DXC_OUT_OBJECT) + Release
+//   blob.create_release        IDxcUtils_CreateBlob (copy) + Release
+//   blob.pinned_release        IDxcUtils_CreateBlobFromPinned + Release
+//   compile.latency            IDxcCompiler3_Compile on one thread
+//   batch.throughput           DxcBatch_Compile at 1, 2, 4, ... threads
+//
+// Defining DXC_BENCH_MAIN before including this header also defines main(),
+// which benchmarks the stand-in unless --library names a DXC library:
+//
+//   dxc_bench [--library PATH] [--iterations N] [--jobs N] [--threads N]
+//             [--compile-ns N] [--ns-per-kib N] [--sleep] [--output PATH]
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcBenchDesc {
+    DxcCreateInstanceProc pfnCreateInstance;
+    const char           *pBackend;   // Copied into every record, e.g. "standin" or a library path
+    UINT32                Iterations; // Per dispatch, result and blob benchmark; 0 selects 100000
+    UINT32                Jobs;       // Compiles per latency and throughput run; 0 selects 256
+    UINT32                MaxThreads; // Largest throughput run; 0 uses the number of online CPUs
+    const char           *pSource;    // NULL uses a small pixel shader
+    LPCWSTR              *pArguments; // NULL uses -T ps_6_0 -E main
+    UINT32                ArgCount;
+    FILE                 *pOutput;    // NULL writes to stdout
+} DxcBenchDesc;
+
+typedef struct DxcBenchRecord {
+    const char *pName;
+    UINT32      Threads;
+    UINT64      Operations;
+    UINT64      Nanoseconds;
+} DxcBenchRecord;
+
+// --- Internals --------------------------------------------------------------
+#define DXC_BENCH_DEFAULT_SOURCE \
+    "float4 main(float4 position : SV_Position) : SV_Target { return position * 0.5f; }\n"
+
+static LPCWSTR DxcBench_DefaultArguments[] = { L"-T", L"ps_6_0", L"-E", L"main" };
+
+static inline void DxcBench_WriteString(FILE *file, const char *pString) {
+    fputc('"', file);
+    for (const char *c = pString; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(file, "\\u%04x", (unsigned)(unsigned char)*c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static inline void DxcBench_Emit(const DxcBenchDesc *pDesc, const DxcBenchRecord *pRecord) {
+    FILE *file = pDesc->pOutput ? pDesc->pOutput : stdout;
+    double nanoseconds = (double)pRecord->Nanoseconds;
+    double operations = (double)pRecord->Operations;
+
+    fputs("{\"benchmark\":", file);
+    DxcBench_WriteString(file, pRecord->pName);
+    fputs(",\"backend\":", file);
+    DxcBench_WriteString(file, pDesc->pBackend ? pDesc->pBackend : "unknown");
+    fprintf(file, ",\"threads\":%u,\"operations\":%llu,\"total_ns\":%llu,\"ns_per_op\":%.3f,\"ops_per_sec\":%.1f}\n",
+            pRecord->Threads, (unsigned long long)pRecord->Operations, (unsigned long long)pRecord->Nanoseconds,
+            operations > 0 ? nanoseconds / operations : 0.0, nanoseconds > 0 ? operations * 1e9 / nanoseconds : 0.0);
+    fflush(file);
+}
+
+static inline void DxcBench_EmitTimed(const DxcBenchDesc *pDesc, const char *pName, UINT32 threads, UINT64 operations, UINT64 start) {
+    DxcBenchRecord record = { pName, threads, operations, DxcUtil_Now() - start };
+    DxcBench_Emit(pDesc, &record);
+}
+
+// Keeps the measured calls from being optimized away
+static volatile SIZE_T DxcBench_Sink;
+
+static SIZE_T __stdcall DxcBench_Baseline(IDxcBlob *pBlob) { return (SIZE_T)(uintptr_t)pBlob; }
+
+static inline HRESULT DxcBench_Compile(IDxcCompiler3 *pCompiler, const DxcBenchDesc *pDesc, const DxcBuffer *pSource, IDxcResult **ppResult) {
+    LPCWSTR *arguments = pDesc->pArguments ? pDesc->pArguments : DxcBench_DefaultArguments;
+    UINT32 argCount = pDesc->pArguments ? pDesc->ArgCount : sizeof(DxcBench_DefaultArguments) / sizeof(DxcBench_DefaultArguments[0]);
+    HRESULT status = E_FAIL;
+
+    HRESULT hr = IDxcCompiler3_Compile(pCompiler, pSource, arguments, argCount, NULL, &IID_IDxcResult, (void**)ppResult);
+    if (SUCCEEDED(hr)) { hr = IDxcResult_GetStatus(*ppResult, &status); }
+    if (SUCCEEDED(hr)) { hr = status; }
+    return hr;
+}
+
+static inline void DxcBench_RunDispatch(const DxcBenchDesc *pDesc, UINT32 iterations, IDxcBlob *pBlob, IDxcResult *pResult) {
+    SIZE_T (__stdcall *volatile baseline)(IDxcBlob*) = DxcBench_Baseline;
+    SIZE_T sink = 0;
+
+    UINT64 start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        sink += baseline(pBlob);
+    }
+    DxcBench_EmitTimed(pDesc, "dispatch.baseline", 1, iterations, start);
+
+    start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        sink += IDxcBlob_GetBufferSize(pBlob);
+    }
+    DxcBench_EmitTimed(pDesc, "dispatch.blob_size", 1, iterations, start);
+
+    start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        IDxcBlob_AddRef(pBlob);
+        sink += IDxcBlob_Release(pBlob);
+    }
+    DxcBench_EmitTimed(pDesc, "dispatch.addref_release", 1, iterations, start);
+
+    start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        HRESULT status;
+        IDxcResult_GetStatus(pResult, &status);
+        sink += (SIZE_T)status;
+    }
+    DxcBench_EmitTimed(pDesc, "dispatch.result_status", 1, iterations, start);
+
+    start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        IDxcBlob *object = NULL;
+        if (SUCCEEDED(IDxcResult_GetOutput(pResult, DXC_OUT_OBJECT, &IID_IDxcBlob, (void**)&object, NULL)) && object) {
+            sink += IDxcBlob_Release(object);
+        }
+    }
+    DxcBench_EmitTimed(pDesc, "result.get_output", 1, iterations, start);
+
+    DxcBench_Sink = sink;
+}
+
+static inline void DxcBench_RunBlobs(const DxcBenchDesc *pDesc, UINT32 iterations, IDxcUtils *pUtils) {
+    BYTE payload[256];
+    SIZE_T sink = 0;
+    memset(payload, 0x5A, sizeof(payload));
+
+    UINT64 start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        IDxcBlobEncoding *blob = NULL;
+        if (SUCCEEDED(IDxcUtils_CreateBlob(pUtils, payload, sizeof(payload), DXC_CP_ACP, &blob))) {
+            sink += IDxcBlobEncoding_Release(blob);
+        }
+    }
+    DxcBench_EmitTimed(pDesc, "blob.create_release", 1, iterations, start);
+
+    start = DxcUtil_Now();
+    for (UINT32 i = 0; i < iterations; ++i) {
+        IDxcBlobEncoding *blob = NULL;
+        if (SUCCEEDED(IDxcUtils_CreateBlobFromPinned(pUtils, payload, sizeof(payload), DXC_CP_ACP, &blob))) {
+            sink += IDxcBlobEncoding_Release(blob);
+        }
+    }
+    DxcBench_EmitTimed(pDesc, "blob.pinned_release", 1, iterations, start);
+
+    DxcBench_Sink = sink;
+}
+
+static inline HRESULT DxcBench_RunBatch(const DxcBenchDesc *pDesc, UINT32 threads, const DxcBuffer *pSource) {
+    UINT32 jobs = pDesc->Jobs ? pDesc->Jobs : 256;
+    LPCWSTR *arguments = pDesc->pArguments ? pDesc->pArguments : DxcBench_DefaultArguments;
+    UINT32 argCount = pDesc->pArguments ? pDesc->ArgCount : sizeof(DxcBench_DefaultArguments) / sizeof(DxcBench_DefaultArguments[0]);
+
+    DxcBatchJob *batchJobs = (DxcBatchJob*)calloc(jobs, sizeof(DxcBatchJob));
+    DxcBatchResult *results = (DxcBatchResult*)calloc(jobs, sizeof(DxcBatchResult));
+    if (!batchJobs || !results) {
+        free(results);
+        free(batchJobs);
+        return E_OUTOFMEMORY;
+    }
+    for (UINT32 i = 0; i < jobs; ++i) {
+        batchJobs[i].Source = *pSource;
+        batchJobs[i].pArguments = arguments;
+        batchJobs[i].ArgCount = argCount;
+    }
+
+    // Workers and their compilers are created outside the measured region
+    DxcBatchDesc batchDesc = { pDesc->pfnCreateInstance, threads };
+    DxcBatch *batch = NULL;
+    HRESULT hr = DxcBatch_Create(&batchDesc, &batch);
+
+    if (SUCCEEDED(hr)) {
+        UINT64 start = DxcUtil_Now();
+        hr = DxcBatch_Compile(batch, batchJobs, jobs, results);
+        UINT64 end = DxcUtil_Now();
+
+        for (UINT32 i = 0; i < jobs; ++i) {
+            if (SUCCEEDED(hr) && FAILED(results[i].Status)) {
+                hr = results[i].Status;
+            }
+            if (results[i].pResult) {
+                IDxcResult_Release(results[i].pResult);
+            }
+        }
+        if (SUCCEEDED(hr)) {
+            DxcBenchRecord record = { "batch.throughput", threads, jobs, end - start };
+            DxcBench_Emit(pDesc, &record);
+        }
+    }
+
+    DxcBatch_Destroy(batch);
+    free(results);
+    free(batchJobs);
+    return hr;
+}
+
+// --- Methods ----------------------------------------------------------------
+// Runs every benchmark in order and writes one record per measurement.
+// Returns the first failure; records already written stay valid.
+static inline HRESULT DxcBench_Run(const DxcBenchDesc *pDesc) {
+    if (!pDesc || !pDesc->pfnCreateInstance) {
+        return E_INVALIDARG;
+    }
+
+    UINT32 iterations = pDesc->Iterations ? pDesc->Iterations : 100000;
+    UINT32 jobs = pDesc->Jobs ? pDesc->Jobs : 256;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    UINT32 maxThreads = pDesc->MaxThreads ? pDesc->MaxThreads : (cpus > 0 ? (UINT32)cpus : 1);
+    const char *text = pDesc->pSource ? pDesc->pSource : DXC_BENCH_DEFAULT_SOURCE;
+    DxcBuffer source = { text, strlen(text), DXC_CP_UTF8 };
+
+    IDxcCompiler3 *compiler = NULL;
+    IDxcUtils *utils = NULL;
+    IDxcResult *result = NULL;
+    IDxcBlob *object = NULL;
+
+    HRESULT hr = pDesc->pfnCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, (LPVOID*)&compiler);
+    if (SUCCEEDED(hr)) { hr = pDesc->pfnCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, (LPVOID*)&utils); }
+    if (SUCCEEDED(hr)) { hr = DxcBench_Compile(compiler, pDesc, &source, &result); }
+    if (SUCCEEDED(hr)) { hr = IDxcResult_GetOutput(result, DXC_OUT_OBJECT, &IID_IDxcBlob, (void**)&object, NULL); }
+    if (SUCCEEDED(hr) && !object) { hr = E_FAIL; }
+
+    if (SUCCEEDED(hr)) {
+        DxcBench_RunDispatch(pDesc, iterations, object, result);
+        DxcBench_RunBlobs(pDesc, iterations, utils);
+    }
+
+    if (SUCCEEDED(hr)) {
+        UINT64 start = DxcUtil_Now();
+        for (UINT32 i = 0; i < jobs && SUCCEEDED(hr); ++i) {
+            IDxcResult *compiled = NULL;
+            hr = DxcBench_Compile(compiler, pDesc, &source, &compiled);
+            if (compiled) {
+                IDxcResult_Release(compiled);
+            }
+        }
+        if (SUCCEEDED(hr)) {
+            DxcBench_EmitTimed(pDesc, "compile.latency", 1, jobs, start);
+        }
+    }
+
+    // Powers of two, always finishing with maxThreads itself
+    for (UINT32 threads = 1; SUCCEEDED(hr); threads *= 2) {
+        if (threads > maxThreads) {
+            threads = maxThreads;
+        }
+        hr = DxcBench_RunBatch(pDesc, threads, &source);
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+
+    if (object)   { IDxcBlob_Release(object); }
+    if (result)   { IDxcResult_Release(result); }
+    if (utils)    { IDxcUtils_Release(utils); }
+    if (compiler) { IDxcCompiler3_Release(compiler); }
+    return hr;
+}
+
+#ifdef DXC_BENCH_MAIN
+int main(int argc, char **argv) {
+    DxcBenchDesc desc;
+    DxcStandInDesc standIn;
+    const char *library = NULL;
+    const char *output = NULL;
+    memset(&desc, 0, sizeof(desc));
+    memset(&standIn, 0, sizeof(standIn));
+
+    for (int i = 1; i < argc; ++i) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--sleep") == 0) {
+            standIn.Sleep = 1;
+            continue;
+        }
+
+        BOOL known = 1;
+        if (!value) {
+            known = 0;
+        } else if (strcmp(argv[i], "--library") == 0)    { library = value; }
+        else if (strcmp(argv[i], "--output") == 0)       { output = value; }
+        else if (strcmp(argv[i], "--iterations") == 0)   { desc.Iterations = (UINT32)strtoul(value, NULL, 10); }
+        else if (strcmp(argv[i], "--jobs") == 0)         { desc.Jobs = (UINT32)strtoul(value, NULL, 10); }
+        else if (strcmp(argv[i], "--threads") == 0)      { desc.MaxThreads = (UINT32)strtoul(value, NULL, 10); }
+        else if (strcmp(argv[i], "--compile-ns") == 0)   { standIn.CompileNanoseconds = strtoull(value, NULL, 10); }
+        else if (strcmp(argv[i], "--ns-per-kib") == 0)   { standIn.NanosecondsPerKiB = strtoull(value, NULL, 10); }
+        else {
+            known = 0;
+        }
+
+        if (!known) {
+            fprintf(stderr, "dxc_bench: unknown option or missing value: %s\n", argv[i]);
+            return 2;
+        }
+        ++i;
+    }
+
+    DxcLoader *loader = NULL;
+    if (library) {
+        DxcLoaderDesc loaderDesc = { library, NULL, 0 };
+        if (FAILED(DxcLoader_Open(&loaderDesc, &loader))) {
+            fprintf(stderr, "dxc_bench: cannot load %s\n", library);
+            return 1;
+        }
+        desc.pfnCreateInstance = loader->DxcCreateInstance;
+        desc.pBackend = library;
+    } else {
+        DxcStandIn_Configure(&standIn);
+        desc.pfnCreateInstance = DxcStandIn_CreateInstance;
+        desc.pBackend = "standin";
+    }
+
+    if (output) {
+        desc.pOutput = fopen(output, "w");
+        if (!desc.pOutput) {
+            fprintf(stderr, "dxc_bench: cannot open %s\n", output);
+            DxcLoader_Close(loader);
+            return 1;
+        }
+    }
+
+    HRESULT hr = DxcBench_Run(&desc);
+    if (FAILED(hr)) {
+        fprintf(stderr, "dxc_bench: failed with 0x%08x\n", (unsigned)hr);
+    }
+
+    if (desc.pOutput) {
+        fclose(desc.pOutput);
+    }
+    DxcLoader_Close(loader);
+    return FAILED(hr) ? 1 : 0;
+}
+#endif
+
+#endif /* __DXC_BENCH_C__ */
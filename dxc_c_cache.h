@@ -0,0 +1,675 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_cache.h                                                             //
+// Content-addressed on-disk compile cache                                   //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_CACHE_C__
+#define __DXC_CACHE_C__
+
+#include "dxc_c.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wchar.h>
+
+// NOTE: Requires POSIX. A cache key hashes the compiler identity, the
+// preprocessed source and the argument list, so include edits invalidate
+// entries without any dependency tracking. Each entry is a single file at
+// <directory>/<2 hex>/<32 hex>.dxcc, written to a temporary name and renamed
+// into place, so several processes can safely share one directory. Hits are
+// served as IDxcBlob views into a read-only mapping of the entry file.
+
+#define DXC_CACHE_MAGIC   DXC_FOURCC('D', 'X', 'C', 'C')
+#define DXC_CACHE_VERSION 1
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcCacheFileHeader {
+    UINT32  Magic;
+    UINT32  Version;
+    UINT32  OutputCount;
+    UINT32  FileSize;
+    DxcHash Key;
+} DxcCacheFileHeader;
+
+typedef struct DxcCacheFileOutput {
+    UINT32 Kind; // DXC_OUT_KIND
+    UINT32 Offset;
+    UINT32 Size;
+    UINT32 Reserved;
+} DxcCacheFileOutput;
+
+typedef struct DxcCacheOutputs {
+    IDxcBlob            *pObject;        // DXC_OUT_OBJECT
+    IDxcBlob            *pReflection;    // DXC_OUT_REFLECTION
+    IDxcBlob            *pRootSignature; // DXC_OUT_ROOT_SIGNATURE
+    IDxcBlob            *pShaderHash;    // DXC_OUT_SHADER_HASH
+    IDxcOperationResult *pResult;        // Compiler result on a miss, NULL on a hit
+    BOOL                 Hit;
+} DxcCacheOutputs;
+
+typedef struct DxcCacheStats {
+    UINT64 Hits;
+    UINT64 Misses;
+    UINT64 Stores;
+} DxcCacheStats;
+
+typedef struct DxcCache {
+    char            *pDirectory;
+    DxcHash          Identity;
+    atomic_ullong    Hits;
+    atomic_ullong    Misses;
+    atomic_ullong    Stores;
+} DxcCache;
+
+// --- Internals --------------------------------------------------------------
+static const DXC_OUT_KIND DxcCache_OutputKinds[] = {
+    DXC_OUT_OBJECT, DXC_OUT_REFLECTION, DXC_OUT_ROOT_SIGNATURE, DXC_OUT_SHADER_HASH,
+};
+#define DXC_CACHE_OUTPUT_COUNT (sizeof(DxcCache_OutputKinds) / sizeof(DxcCache_OutputKinds[0]))
+
+static inline IDxcBlob **DxcCacheOutputs_Slot(DxcCacheOutputs *outputs, DXC_OUT_KIND kind) {
+    switch (kind) {
+    case DXC_OUT_OBJECT:         return &outputs->pObject;
+    case DXC_OUT_REFLECTION:     return &outputs->pReflection;
+    case DXC_OUT_ROOT_SIGNATURE: return &outputs->pRootSignature;
+    case DXC_OUT_SHADER_HASH:    return &outputs->pShaderHash;
+    default:                     return NULL;
+    }
+}
+
+// Shared read-only mapping of one cache entry, unmapped with its last blob
+typedef struct DxcCacheMapping {
+    void       *pBase;
+    SIZE_T      Size;
+    atomic_uint RefCount;
+} DxcCacheMapping;
+
+static inline void DxcCacheMapping_Release(DxcCacheMapping *mapping) {
+    if (atomic_fetch_sub(&mapping->RefCount, 1) == 1) {
+        munmap(mapping->pBase, mapping->Size);
+        free(mapping);
+    }
+}
+
+// Minimal IDxcBlob implementation over a slice of a mapping
+typedef struct DxcCacheBlob {
+    void *const     *v;
+    DxcCacheMapping *pMapping;
+    const BYTE      *pData;
+    SIZE_T           Size;
+    atomic_uint      RefCount;
+} DxcCacheBlob;
+
+static inline ULONG __stdcall DxcCacheBlob_AddRef(DxcCacheBlob *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcCacheBlob_Release(DxcCacheBlob *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        DxcCacheMapping_Release(self->pMapping);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcCacheBlob_QueryInterface(DxcCacheBlob *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcBlob, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcCacheBlob_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline LPVOID __stdcall DxcCacheBlob_GetBufferPointer(DxcCacheBlob *self) { return (LPVOID)self->pData; }
+static inline SIZE_T __stdcall DxcCacheBlob_GetBufferSize(DxcCacheBlob *self) { return self->Size; }
+
+static void *const DxcCacheBlob_Vtbl[] = {
+    (void*)DxcCacheBlob_QueryInterface,
+    (void*)DxcCacheBlob_AddRef,
+    (void*)DxcCacheBlob_Release,
+    (void*)DxcCacheBlob_GetBufferPointer,
+    (void*)DxcCacheBlob_GetBufferSize,
+};
+
+static inline IDxcBlob *DxcCacheBlob_Create(DxcCacheMapping *mapping, const BYTE *pData, SIZE_T size) {
+    DxcCacheBlob *blob = (DxcCacheBlob*)malloc(sizeof(DxcCacheBlob));
+    if (!blob) {
+        return NULL;
+    }
+    blob->v = DxcCacheBlob_Vtbl;
+    blob->pMapping = mapping;
+    blob->pData = pData;
+    blob->Size = size;
+    atomic_init(&blob->RefCount, 1);
+    atomic_fetch_add(&mapping->RefCount, 1);
+    return (IDxcBlob*)blob;
+}
+
+static inline void DxcCache_EntryPath(const DxcCache *cache, const DxcHash *key, char *pPath, SIZE_T size, BOOL directoryOnly) {
+    char hex[33];
+    DxcHash_ToHex(key, hex);
+    if (directoryOnly) {
+        snprintf(pPath, size, "%s/%.2s", cache->pDirectory, hex);
+    }
+    else {
+        snprintf(pPath, size, "%s/%.2s/%s.dxcc", cache->pDirectory, hex, hex);
+    }
+}
+
+// Returns the option length when arg is option pName, joined with its value
+// or not, and 0 otherwise. A / spelling whose joined value holds another /
+// is an absolute POSIX path such as /home/..., not an option.
+static inline SIZE_T DxcCache_OptionLength(LPCWSTR arg, LPCWSTR pName) {
+    if (arg[0] != L'-' && arg[0] != L'/') {
+        return 0;
+    }
+    SIZE_T length = wcslen(pName);
+    if (wcsncmp(arg + 1, pName, length) != 0 || (arg[0] == L'/' && wcschr(arg + 1 + length, L'/'))) {
+        return 0;
+    }
+    return 1 + length;
+}
+
+// Output file options never change the produced blobs, except -Fd: with
+// debug info on, the PDB path is recorded in the container. Returns the
+// option length when arg is one of them and 0 otherwise.
+static inline SIZE_T DxcCache_OutputPathArgLength(LPCWSTR arg, BOOL debugInfo) {
+    static const WCHAR *const outputArgs[] = { L"Fre", L"Frs", L"Fsh", L"Fo", L"Fe", L"Fc", L"Fi", L"Fd", L"Fh" };
+    for (SIZE_T i = 0; i < sizeof(outputArgs) / sizeof(outputArgs[0]); ++i) {
+        SIZE_T length = DxcCache_OptionLength(arg, outputArgs[i]);
+        if (length) {
+            return debugInfo && wcscmp(outputArgs[i], L"Fd") == 0 ? 0 : length;
+        }
+    }
+    return 0;
+}
+
+// -D and -I value in either spelling; Kind is L'D' or L'I'
+typedef struct DxcCacheListArg {
+    WCHAR   Kind;
+    LPCWSTR pValue;
+} DxcCacheListArg;
+
+static inline int DxcCache_CompareListArgs(const void *a, const void *b) {
+    const DxcCacheListArg *x = (const DxcCacheListArg*)a;
+    const DxcCacheListArg *y = (const DxcCacheListArg*)b;
+    if (x->Kind != y->Kind) {
+        return x->Kind < y->Kind ? -1 : 1;
+    }
+    return wcscmp(x->pValue, y->pValue);
+}
+
+// Hashes the normalized argument list: output file options are dropped
+// (-Fd only without -Zi or -Zs), "-D X" and "-DX" (likewise -I and the /
+// spellings) fold to one form, and the -D and -I entries are sorted.
+// Everything else is hashed in order.
+static inline HRESULT DxcCache_HashArguments(DxcHasher *hasher, LPCWSTR *pArguments, UINT32 argCount) {
+    DxcCacheListArg *listArgs = (DxcCacheListArg*)malloc((argCount ? argCount : 1) * sizeof(DxcCacheListArg));
+    if (!listArgs) {
+        return E_OUTOFMEMORY;
+    }
+
+    BOOL debugInfo = 0;
+    for (UINT32 i = 0; i < argCount; ++i) {
+        LPCWSTR arg = pArguments[i];
+        if ((arg[0] == L'-' || arg[0] == L'/') && (wcscmp(arg + 1, L"Zi") == 0 || wcscmp(arg + 1, L"Zs") == 0)) {
+            debugInfo = 1;
+        }
+    }
+
+    UINT32 listCount = 0;
+    for (UINT32 i = 0; i < argCount; ++i) {
+        LPCWSTR arg = pArguments[i];
+        SIZE_T outputLength = DxcCache_OutputPathArgLength(arg, debugInfo);
+        if (outputLength) {
+            if (arg[outputLength] == L'\0') {
+                ++i; // Separate value
+            }
+            continue;
+        }
+
+        if (DxcCache_OptionLength(arg, L"D") || DxcCache_OptionLength(arg, L"I")) {
+            LPCWSTR value = arg + 2;
+            if (*value == L'\0' && i + 1 < argCount) {
+                value = pArguments[++i];
+            }
+            listArgs[listCount].Kind = arg[1];
+            listArgs[listCount].pValue = value;
+            ++listCount;
+            continue;
+        }
+        DxcHasher_UpdateWide(hasher, arg);
+    }
+
+    qsort(listArgs, listCount, sizeof(DxcCacheListArg), DxcCache_CompareListArgs);
+    DxcHasher_UpdateField(hasher, &listCount, sizeof(listCount));
+    for (UINT32 i = 0; i < listCount; ++i) {
+        DxcHasher_UpdateField(hasher, &listArgs[i].Kind, sizeof(listArgs[i].Kind));
+        DxcHasher_UpdateWide(hasher, listArgs[i].pValue);
+    }
+
+    free(listArgs);
+    return S_OK;
+}
+
+// Order-independent define hash. The preprocessed text already reflects the
+// effective define set, so this only separates otherwise identical inputs.
+static inline void DxcCache_HashDefines(DxcHasher *hasher, const DxcDefine *pDefines, UINT32 defineCount) {
+    UINT64 sum[2] = { 0, 0 };
+    for (UINT32 i = 0; i < defineCount; ++i) {
+        DxcHasher define;
+        DxcHasher_Init(&define, 0);
+        DxcHasher_UpdateWide(&define, pDefines[i].Name);
+        DxcHasher_UpdateWide(&define, pDefines[i].Value);
+        DxcHash hash = DxcHasher_Final(&define);
+
+        UINT64 lanes[2];
+        memcpy(lanes, hash.Digest, sizeof(lanes));
+        sum[0] += lanes[0];
+        sum[1] += lanes[1];
+    }
+    DxcHasher_UpdateField(hasher, sum, sizeof(sum));
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline void DxcCacheOutputs_Release(DxcCacheOutputs *pOutputs) {
+    for (SIZE_T i = 0; i < DXC_CACHE_OUTPUT_COUNT; ++i) {
+        IDxcBlob **slot = DxcCacheOutputs_Slot(pOutputs, DxcCache_OutputKinds[i]);
+        if (*slot) {
+            IDxcBlob_Release(*slot);
+        }
+    }
+    if (pOutputs->pResult) {
+        IDxcOperationResult_Release(pOutputs->pResult);
+    }
+    memset(pOutputs, 0, sizeof(DxcCacheOutputs));
+}
+
+// Opens (and creates) a cache directory. The compiler identity is taken from
+// the IDxcVersionInfo2 interface of the compiler that will fill the cache.
+static inline HRESULT DxcCache_Open(const char *pDirectory, IDxcVersionInfo2 *pVersionInfo, DxcCache **ppCache) {
+    if (!pDirectory || !pVersionInfo || !ppCache) {
+        return E_INVALIDARG;
+    }
+
+    *ppCache = NULL;
+
+    UINT32 major = 0;
+    UINT32 minor = 0;
+    UINT32 flags = 0;
+    UINT32 commitCount = 0;
+    char *commitHash = NULL;
+
+    HRESULT hr = IDxcVersionInfo2_GetVersion(pVersionInfo, &major, &minor);
+    if (SUCCEEDED(hr)) { hr = IDxcVersionInfo2_GetFlags(pVersionInfo, &flags); }
+    if (SUCCEEDED(hr)) { hr = IDxcVersionInfo2_GetCommitInfo(pVersionInfo, &commitCount, &commitHash); }
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    UINT32 version[4] = { major, minor, flags, commitCount };
+    DxcHasher hasher;
+    DxcHasher_Init(&hasher, 0);
+    DxcHasher_UpdateField(&hasher, version, sizeof(version));
+    DxcHasher_UpdateField(&hasher, commitHash, commitHash ? strlen(commitHash) : 0);
+
+#ifdef _WIN32
+    CoTaskMemFree(commitHash);
+#else
+    free(commitHash); // WinAdapter.h maps CoTaskMemAlloc to malloc
+#endif
+
+    if (mkdir(pDirectory, 0777) != 0 && errno != EEXIST) {
+        return E_FAIL;
+    }
+
+    DxcCache *cache = (DxcCache*)calloc(1, sizeof(DxcCache));
+    SIZE_T length = strlen(pDirectory);
+    char *directory = (char*)malloc(length + 1);
+    if (!cache || !directory) {
+        free(directory);
+        free(cache);
+        return E_OUTOFMEMORY;
+    }
+
+    memcpy(directory, pDirectory, length + 1);
+    cache->pDirectory = directory;
+    cache->Identity = DxcHasher_Final(&hasher);
+    atomic_init(&cache->Hits, 0);
+    atomic_init(&cache->Misses, 0);
+    atomic_init(&cache->Stores, 0);
+
+    *ppCache = cache;
+    return S_OK;
+}
+
+static inline void DxcCache_Close(DxcCache *cache) {
+    if (cache) {
+        free(cache->pDirectory);
+        free(cache);
+    }
+}
+
+static inline DxcCacheStats DxcCache_GetStats(DxcCache *cache) {
+    DxcCacheStats stats;
+    stats.Hits = atomic_load(&cache->Hits);
+    stats.Misses = atomic_load(&cache->Misses);
+    stats.Stores = atomic_load(&cache->Stores);
+    return stats;
+}
+
+// Maps the entry for key and fills the output blobs. Returns S_FALSE on a miss.
+static inline HRESULT DxcCache_Lookup(DxcCache *cache, const DxcHash *key, DxcCacheOutputs *pOutputs) {
+    char path[4096];
+    DxcCache_EntryPath(cache, key, path, sizeof(path), 0);
+    memset(pOutputs, 0, sizeof(DxcCacheOutputs));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return S_FALSE;
+    }
+
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (SIZE_T)st.st_size >= sizeof(DxcCacheFileHeader)) {
+        base = mmap(NULL, (SIZE_T)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        return S_FALSE;
+    }
+
+    // Validate everything before handing out views; a torn or foreign file is a miss
+    SIZE_T size = (SIZE_T)st.st_size;
+    const DxcCacheFileHeader *header = (const DxcCacheFileHeader*)base;
+    const DxcCacheFileOutput *records = (const DxcCacheFileOutput*)(header + 1);
+    BOOL valid = header->Magic == DXC_CACHE_MAGIC && header->Version == DXC_CACHE_VERSION &&
+                 header->FileSize == size && DxcHash_Equal(&header->Key, key) &&
+                 header->OutputCount <= DXC_CACHE_OUTPUT_COUNT &&
+                 sizeof(DxcCacheFileHeader) + header->OutputCount * sizeof(DxcCacheFileOutput) <= size;
+    for (UINT32 i = 0; valid && i < header->OutputCount; ++i) {
+        valid = (UINT64)records[i].Offset + records[i].Size <= size &&
+                DxcCacheOutputs_Slot(pOutputs, (DXC_OUT_KIND)records[i].Kind) != NULL;
+    }
+
+    DxcCacheMapping *mapping = valid ? (DxcCacheMapping*)malloc(sizeof(DxcCacheMapping)) : NULL;
+    if (!mapping) {
+        munmap(base, size);
+        return S_FALSE;
+    }
+
+    mapping->pBase = base;
+    mapping->Size = size;
+    atomic_init(&mapping->RefCount, 1);
+
+    HRESULT hr = S_OK;
+    for (UINT32 i = 0; i < header->OutputCount; ++i) {
+        IDxcBlob **slot = DxcCacheOutputs_Slot(pOutputs, (DXC_OUT_KIND)records[i].Kind);
+        if (*slot) {
+            continue;
+        }
+        *slot = DxcCacheBlob_Create(mapping, (const BYTE*)base + records[i].Offset, records[i].Size);
+        if (!*slot) {
+            hr = E_OUTOFMEMORY;
+            break;
+        }
+    }
+
+    DxcCacheMapping_Release(mapping);
+
+    if (FAILED(hr)) {
+        DxcCacheOutputs_Release(pOutputs);
+        return hr;
+    }
+
+    pOutputs->Hit = 1;
+    atomic_fetch_add(&cache->Hits, 1);
+    return S_OK;
+}
+
+// Writes the non-NULL blobs of pOutputs under key. The entry becomes visible
+// atomically; concurrent writers of the same key simply replace each other.
+static inline HRESULT DxcCache_Store(DxcCache *cache, const DxcHash *key, const DxcCacheOutputs *pOutputs) {
+    DxcCacheFileHeader header;
+    DxcCacheFileOutput records[DXC_CACHE_OUTPUT_COUNT];
+    IDxcBlob *blobs[DXC_CACHE_OUTPUT_COUNT];
+
+    memset(&header, 0, sizeof(header));
+    memset(records, 0, sizeof(records));
+    header.Magic = DXC_CACHE_MAGIC;
+    header.Version = DXC_CACHE_VERSION;
+    header.Key = *key;
+
+    for (SIZE_T i = 0; i < DXC_CACHE_OUTPUT_COUNT; ++i) {
+        IDxcBlob *blob = *DxcCacheOutputs_Slot((DxcCacheOutputs*)pOutputs, DxcCache_OutputKinds[i]);
+        if (blob) {
+            records[header.OutputCount].Kind = DxcCache_OutputKinds[i];
+            records[header.OutputCount].Size = (UINT32)IDxcBlob_GetBufferSize(blob);
+            blobs[header.OutputCount++] = blob;
+        }
+    }
+
+    // Blobs start 16-byte aligned so views can be consumed in place
+    UINT64 offset = sizeof(DxcCacheFileHeader) + header.OutputCount * sizeof(DxcCacheFileOutput);
+    for (UINT32 i = 0; i < header.OutputCount; ++i) {
+        offset = (offset + 15) & ~(UINT64)15;
+        records[i].Offset = (UINT32)offset;
+        offset += records[i].Size;
+    }
+    if (offset > 0xFFFFFFFFull) {
+        return E_INVALIDARG;
+    }
+    header.FileSize = (UINT32)offset;
+
+    char directory[4096];
+    char path[4096];
+    char tempPath[4096 + 64];
+    DxcCache_EntryPath(cache, key, directory, sizeof(directory), 1);
+    DxcCache_EntryPath(cache, key, path, sizeof(path), 0);
+
+    if (mkdir(directory, 0777) != 0 && errno != EEXIST) {
+        return E_FAIL;
+    }
+
+    FILE *file = DxcUtil_CreateTemp(path, tempPath, sizeof(tempPath));
+    if (!file) {
+        return E_FAIL;
+    }
+
+    static const BYTE padding[16] = { 0 };
+    UINT64 position = sizeof(DxcCacheFileHeader) + header.OutputCount * sizeof(DxcCacheFileOutput);
+    HRESULT hr = DxcUtil_WriteAll(file, &header, sizeof(header));
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, records, header.OutputCount * sizeof(DxcCacheFileOutput)); }
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < header.OutputCount; ++i) {
+        hr = DxcUtil_WriteAll(file, padding, (SIZE_T)(records[i].Offset - position));
+        if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, IDxcBlob_GetBufferPointer(blobs[i]), records[i].Size); }
+        position = records[i].Offset + records[i].Size;
+    }
+
+    hr = DxcUtil_FinishTemp(file, tempPath, path, hr);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    atomic_fetch_add(&cache->Stores, 1);
+    return S_OK;
+}
+
+// Cache key for IDxcCompiler3_Compile. Runs the preprocessor (-P) with the same
+// arguments and include handler. Fails if preprocessing fails.
+static inline HRESULT DxcCache_ComputeKey3(DxcCache *cache, IDxcCompiler3 *pCompiler, const DxcBuffer *pSource, LPCWSTR *pArguments,
+                                           UINT32 argCount, IDxcIncludeHandler *pIncludeHandler, DxcHash *pKey) {
+    LPCWSTR *arguments = (LPCWSTR*)malloc((argCount + 1) * sizeof(LPCWSTR));
+    if (!arguments) {
+        return E_OUTOFMEMORY;
+    }
+    memcpy(arguments, pArguments, argCount * sizeof(LPCWSTR));
+    arguments[argCount] = L"-P";
+
+    IDxcResult *result = NULL;
+    IDxcBlobUtf8 *text = NULL;
+    HRESULT status = E_FAIL;
+    HRESULT hr = IDxcCompiler3_Compile(pCompiler, pSource, arguments, argCount + 1, pIncludeHandler, &IID_IDxcResult, (void**)&result);
+    free(arguments);
+
+    if (SUCCEEDED(hr)) { hr = IDxcResult_GetStatus(result, &status); }
+    if (SUCCEEDED(hr)) { hr = status; }
+    if (SUCCEEDED(hr)) { hr = IDxcResult_GetOutput(result, DXC_OUT_HLSL, &IID_IDxcBlobUtf8, (void**)&text, NULL); }
+    if (SUCCEEDED(hr) && !text) { hr = E_FAIL; }
+
+    if (SUCCEEDED(hr)) {
+        DxcHasher hasher;
+        DxcHasher_Init(&hasher, 3);
+        DxcHasher_UpdateField(&hasher, cache->Identity.Digest, sizeof(cache->Identity.Digest));
+        DxcHasher_UpdateField(&hasher, IDxcBlobUtf8_GetBufferPointer(text), IDxcBlobUtf8_GetBufferSize(text));
+        hr = DxcCache_HashArguments(&hasher, pArguments, argCount);
+        if (SUCCEEDED(hr)) {
+            *pKey = DxcHasher_Final(&hasher);
+        }
+    }
+
+    if (text)   { IDxcBlobUtf8_Release(text); }
+    if (result) { IDxcResult_Release(result); }
+    return hr;
+}
+
+// Cache key for IDxcCompiler_Compile, using IDxcCompiler_Preprocess
+static inline HRESULT DxcCache_ComputeKey(DxcCache *cache, IDxcCompiler *pCompiler, IDxcBlob *pSource, LPCWSTR pSourceName,
+                                          LPCWSTR pEntryPoint, LPCWSTR pTargetProfile, LPCWSTR *pArguments, UINT32 argCount,
+                                          const DxcDefine *pDefines, UINT32 defineCount, IDxcIncludeHandler *pIncludeHandler,
+                                          DxcHash *pKey) {
+    IDxcOperationResult *result = NULL;
+    IDxcBlob *text = NULL;
+    HRESULT status = E_FAIL;
+    HRESULT hr = IDxcCompiler_Preprocess(pCompiler, pSource, pSourceName, pArguments, argCount, pDefines, defineCount, pIncludeHandler, &result);
+
+    if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetStatus(result, &status); }
+    if (SUCCEEDED(hr)) { hr = status; }
+    if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetResult(result, &text); }
+    if (SUCCEEDED(hr) && !text) { hr = E_FAIL; }
+
+    if (SUCCEEDED(hr)) {
+        DxcHasher hasher;
+        DxcHasher_Init(&hasher, 1);
+        DxcHasher_UpdateField(&hasher, cache->Identity.Digest, sizeof(cache->Identity.Digest));
+        DxcHasher_UpdateField(&hasher, IDxcBlob_GetBufferPointer(text), IDxcBlob_GetBufferSize(text));
+        DxcHasher_UpdateWide(&hasher, pEntryPoint);
+        DxcHasher_UpdateWide(&hasher, pTargetProfile);
+        DxcCache_HashDefines(&hasher, pDefines, defineCount);
+        hr = DxcCache_HashArguments(&hasher, pArguments, argCount);
+        if (SUCCEEDED(hr)) {
+            *pKey = DxcHasher_Final(&hasher);
+        }
+    }
+
+    if (text)   { IDxcBlob_Release(text); }
+    if (result) { IDxcOperationResult_Release(result); }
+    return hr;
+}
+
+// Collects the cacheable outputs of a successful compile and stores them
+static inline void DxcCache_StoreResult(DxcCache *cache, const DxcHash *key, IDxcOperationResult *pResult, DxcCacheOutputs *pOutputs) {
+    IDxcResult *result = NULL;
+    if (SUCCEEDED(IDxcOperationResult_QueryInterface(pResult, &IID_IDxcResult, (void**)&result)) && result) {
+        for (SIZE_T i = 0; i < DXC_CACHE_OUTPUT_COUNT; ++i) {
+            if (IDxcResult_HasOutput(result, DxcCache_OutputKinds[i])) {
+                IDxcResult_GetOutput(result, DxcCache_OutputKinds[i], &IID_IDxcBlob,
+                                     (void**)DxcCacheOutputs_Slot(pOutputs, DxcCache_OutputKinds[i]), NULL);
+            }
+        }
+        IDxcResult_Release(result);
+    }
+    else {
+        IDxcOperationResult_GetResult(pResult, &pOutputs->pObject);
+    }
+
+    if (pOutputs->pObject) {
+        DxcCache_Store(cache, key, pOutputs); // A failed store only costs a future miss
+    }
+}
+
+// Cached IDxcCompiler3_Compile. On a hit the compiler is never invoked and
+// pOutputs->pResult is NULL. On a miss pOutputs->pResult holds the compile
+// result (check its status); successful results are written to the cache.
+static inline HRESULT DxcCache_Compile3(DxcCache *cache, IDxcCompiler3 *pCompiler, const DxcBuffer *pSource, LPCWSTR *pArguments,
+                                        UINT32 argCount, IDxcIncludeHandler *pIncludeHandler, DxcCacheOutputs *pOutputs) {
+    if (!cache || !pCompiler || !pSource || !pOutputs) {
+        return E_INVALIDARG;
+    }
+
+    DxcHash key;
+    BOOL cacheable = SUCCEEDED(DxcCache_ComputeKey3(cache, pCompiler, pSource, pArguments, argCount, pIncludeHandler, &key));
+    if (cacheable && DxcCache_Lookup(cache, &key, pOutputs) == S_OK) {
+        return S_OK;
+    }
+
+    atomic_fetch_add(&cache->Misses, 1);
+    memset(pOutputs, 0, sizeof(DxcCacheOutputs));
+
+    IDxcResult *result = NULL;
+    HRESULT status = E_FAIL;
+    HRESULT hr = IDxcCompiler3_Compile(pCompiler, pSource, pArguments, argCount, pIncludeHandler, &IID_IDxcResult, (void**)&result);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    pOutputs->pResult = (IDxcOperationResult*)result;
+    if (cacheable && SUCCEEDED(IDxcResult_GetStatus(result, &status)) && SUCCEEDED(status)) {
+        DxcCache_StoreResult(cache, &key, pOutputs->pResult, pOutputs);
+    }
+    return S_OK;
+}
+
+// Cached IDxcCompiler_Compile, see DxcCache_Compile3
+static inline HRESULT DxcCache_Compile(DxcCache *cache, IDxcCompiler *pCompiler, IDxcBlob *pSource, LPCWSTR pSourceName,
+                                       LPCWSTR pEntryPoint, LPCWSTR pTargetProfile, LPCWSTR *pArguments, UINT32 argCount,
+                                       const DxcDefine *pDefines, UINT32 defineCount, IDxcIncludeHandler *pIncludeHandler,
+                                       DxcCacheOutputs *pOutputs) {
+    if (!cache || !pCompiler || !pSource || !pOutputs) {
+        return E_INVALIDARG;
+    }
+
+    DxcHash key;
+    BOOL cacheable = SUCCEEDED(DxcCache_ComputeKey(cache, pCompiler, pSource, pSourceName, pEntryPoint, pTargetProfile,
+                                                   pArguments, argCount, pDefines, defineCount, pIncludeHandler, &key));
+    if (cacheable && DxcCache_Lookup(cache, &key, pOutputs) == S_OK) {
+        return S_OK;
+    }
+
+    atomic_fetch_add(&cache->Misses, 1);
+    memset(pOutputs, 0, sizeof(DxcCacheOutputs));
+
+    HRESULT status = E_FAIL;
+    HRESULT hr = IDxcCompiler_Compile(pCompiler, pSource, pSourceName, pEntryPoint, pTargetProfile, pArguments, argCount,
+                                      pDefines, defineCount, pIncludeHandler, &pOutputs->pResult);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    if (cacheable && SUCCEEDED(IDxcOperationResult_GetStatus(pOutputs->pResult, &status)) && SUCCEEDED(status)) {
+        DxcCache_StoreResult(cache, &key, pOutputs->pResult, pOutputs);
+    }
+    return S_OK;
+}
+
+#endif /* __DXC_CACHE_C__ */
@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_container.h                                                         //
+// Zero-copy DXIL container parser                                           //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_CONTAINER_C__
+#define __DXC_CONTAINER_C__
+
+#include "dxc_c.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// NOTE: Walks a DXIL container in place. Nothing is allocated and no DXC
+// entry point is called, so the parser works without the DXC library loaded.
+// Every view borrows from the buffer passed to DxcContainer_Parse and is only
+// valid while that buffer is. Fields are read with memcpy, so the buffer does
+// not need to be aligned.
+
+#define DXC_CONTAINER_FOURCC DXC_FOURCC('D', 'X', 'B', 'C')
+#define DXC_DXIL_MAGIC       DXC_FOURCC('D', 'X', 'I', 'L')
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcContainerHeader {
+    UINT32 HeaderFourCC;
+    BYTE   Digest[16];
+    UINT16 MajorVersion;
+    UINT16 MinorVersion;
+    UINT32 ContainerSizeInBytes;
+    UINT32 PartCount;
+} DxcContainerHeader;
+
+typedef struct DxcPartHeader {
+    UINT32 PartFourCC;
+    UINT32 PartSize;
+} DxcPartHeader;
+
+typedef struct DxcProgramHeader {
+    UINT32 ProgramVersion; // (ShaderKind << 16) | (Major << 4) | Minor
+    UINT32 SizeInUint32;
+    UINT32 DxilMagic;
+    UINT32 DxilVersion;
+    UINT32 BitcodeOffset;  // Relative to DxilMagic
+    UINT32 BitcodeSize;
+} DxcProgramHeader;
+
+typedef struct DxcContainerView {
+    const BYTE *pData;
+    UINT32      Size;      // ContainerSizeInBytes
+    UINT32      PartCount;
+    BYTE        Digest[16];
+} DxcContainerView;
+
+typedef struct DxcPartView {
+    UINT32      FourCC; // DXC_PART_*
+    const void *pData;
+    UINT32      Size;
+} DxcPartView;
+
+typedef struct DxcProgramView {
+    UINT32      ShaderKind;
+    UINT32      MajorVersion;
+    UINT32      MinorVersion;
+    UINT32      DxilVersion;
+    const void *pBitcode;
+    UINT32      BitcodeSize;
+} DxcProgramView;
+
+// --- Internals --------------------------------------------------------------
+static inline UINT32 DxcContainer_ReadU32(const BYTE *p) {
+    UINT32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline UINT16 DxcContainer_ReadU16(const BYTE *p) {
+    UINT16 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// --- Methods ----------------------------------------------------------------
+// Validates the header and every part bound once, so the accessors below can
+// index without further checks
+static inline HRESULT DxcContainer_Parse(const void *pData, SIZE_T size, DxcContainerView *pView) {
+    if (!pData || !pView) {
+        return E_INVALIDARG;
+    }
+
+    const BYTE *data = (const BYTE*)pData;
+    if (size < sizeof(DxcContainerHeader) || DxcContainer_ReadU32(data) != DXC_CONTAINER_FOURCC) {
+        return E_INVALIDARG;
+    }
+
+    UINT32 containerSize = DxcContainer_ReadU32(data + offsetof(DxcContainerHeader, ContainerSizeInBytes));
+    UINT32 partCount = DxcContainer_ReadU32(data + offsetof(DxcContainerHeader, PartCount));
+    if (containerSize > size || containerSize < sizeof(DxcContainerHeader) ||
+        partCount > (containerSize - sizeof(DxcContainerHeader)) / sizeof(UINT32)) {
+        return E_INVALIDARG;
+    }
+
+    const BYTE *offsets = data + sizeof(DxcContainerHeader);
+    for (UINT32 i = 0; i < partCount; ++i) {
+        UINT64 offset = DxcContainer_ReadU32(offsets + i * sizeof(UINT32));
+        if (offset + sizeof(DxcPartHeader) > containerSize) {
+            return E_INVALIDARG;
+        }
+        UINT64 partSize = DxcContainer_ReadU32(data + offset + offsetof(DxcPartHeader, PartSize));
+        if (offset + sizeof(DxcPartHeader) + partSize > containerSize) {
+            return E_INVALIDARG;
+        }
+    }
+
+    pView->pData = data;
+    pView->Size = containerSize;
+    pView->PartCount = partCount;
+    memcpy(pView->Digest, data + offsetof(DxcContainerHeader, Digest), sizeof(pView->Digest));
+    return S_OK;
+}
+
+static inline BOOL DxcContainer_GetPart(const DxcContainerView *pView, UINT32 index, DxcPartView *pPart) {
+    if (index >= pView->PartCount) {
+        return 0;
+    }
+
+    UINT32 offset = DxcContainer_ReadU32(pView->pData + sizeof(DxcContainerHeader) + index * sizeof(UINT32));
+    const BYTE *header = pView->pData + offset;
+    pPart->FourCC = DxcContainer_ReadU32(header + offsetof(DxcPartHeader, PartFourCC));
+    pPart->Size = DxcContainer_ReadU32(header + offsetof(DxcPartHeader, PartSize));
+    pPart->pData = header + sizeof(DxcPartHeader);
+    return 1;
+}
+
+// Finds the first part of the given DXC_PART_* kind
+static inline BOOL DxcContainer_FindPart(const DxcContainerView *pView, UINT32 fourCC, DxcPartView *pPart) {
+    for (UINT32 i = 0; i < pView->PartCount; ++i) {
+        UINT32 offset = DxcContainer_ReadU32(pView->pData + sizeof(DxcContainerHeader) + i * sizeof(UINT32));
+        if (DxcContainer_ReadU32(pView->pData + offset) == fourCC) {
+            return DxcContainer_GetPart(pView, i, pPart);
+        }
+    }
+    return 0;
+}
+
+// Copies the DXC_PART_SHADER_HASH part
+static inline BOOL DxcContainer_GetShaderHash(const DxcContainerView *pView, DxcShaderHash *pHash) {
+    DxcPartView part;
+    if (!DxcContainer_FindPart(pView, DXC_PART_SHADER_HASH, &part) || part.Size < sizeof(DxcShaderHash)) {
+        return 0;
+    }
+    memcpy(pHash, part.pData, sizeof(DxcShaderHash));
+    return 1;
+}
+
+// Decodes the program header of DXC_PART_DXIL and returns a view of the bitcode
+static inline BOOL DxcContainer_GetProgram(const DxcContainerView *pView, DxcProgramView *pProgram) {
+    DxcPartView part;
+    if (!DxcContainer_FindPart(pView, DXC_PART_DXIL, &part) || part.Size < sizeof(DxcProgramHeader)) {
+        return 0;
+    }
+
+    const BYTE *data = (const BYTE*)part.pData;
+    UINT32 version = DxcContainer_ReadU32(data + offsetof(DxcProgramHeader, ProgramVersion));
+    UINT32 bitcodeOffset = DxcContainer_ReadU32(data + offsetof(DxcProgramHeader, BitcodeOffset));
+    UINT32 bitcodeSize = DxcContainer_ReadU32(data + offsetof(DxcProgramHeader, BitcodeSize));
+    UINT64 bitcodeStart = (UINT64)offsetof(DxcProgramHeader, DxilMagic) + bitcodeOffset;
+
+    if (DxcContainer_ReadU32(data + offsetof(DxcProgramHeader, DxilMagic)) != DXC_DXIL_MAGIC ||
+        bitcodeStart + bitcodeSize > part.Size) {
+        return 0;
+    }
+
+    pProgram->ShaderKind = version >> 16;
+    pProgram->MajorVersion = (version >> 4) & 0xF;
+    pProgram->MinorVersion = version & 0xF;
+    pProgram->DxilVersion = DxcContainer_ReadU32(data + offsetof(DxcProgramHeader, DxilVersion));
+    pProgram->pBitcode = data + bitcodeStart;
+    pProgram->BitcodeSize = bitcodeSize;
+    return 1;
+}
+
+// Returns the debug name stored in DXC_PART_PDB_NAME. The name is not
+// guaranteed to be NUL-terminated; use *pLength.
+static inline BOOL DxcContainer_GetPdbName(const DxcContainerView *pView, const char **ppName, UINT32 *pLength) {
+    DxcPartView part;
+    if (!DxcContainer_FindPart(pView, DXC_PART_PDB_NAME, &part) || part.Size < 4) {
+        return 0;
+    }
+
+    // struct { UINT16 Flags; UINT16 NameLength; char Name[]; }
+    const BYTE *data = (const BYTE*)part.pData;
+    UINT32 length = DxcContainer_ReadU16(data + 2);
+    if (4 + (UINT64)length > part.Size) {
+        return 0;
+    }
+
+    *ppName = (const char*)(data + 4);
+    *pLength = length;
+    return 1;
+}
+
+#endif /* __DXC_CONTAINER_C__ */
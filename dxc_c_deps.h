@@ -0,0 +1,776 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_deps.h                                                              //
+// Include-dependency tracking and manifest for incremental builds           //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_DEPS_C__
+#define __DXC_DEPS_C__
+
+#include "dxc_c.h"
+#include "dxc_c_args.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX. A dependency tracker is an IDxcIncludeHandler that
+// wraps another one and records every file a compile asks for: its path, size,
+// modification time (taken before the read) and a hash of the returned
+// content. Lookups that fail are recorded too, so a header that later appears
+// earlier on the include path still triggers a rebuild. A DxcDepsWriter turns
+// the trackers of a build into a manifest: a file table shared by all shaders,
+// per-shader dependency lists and the paths, written as one flat file.
+//
+// DxcDepsManifest_Open maps the manifest once. DxcDepsManifest_Check stats
+// each distinct file one time; only files whose size or timestamp moved, or
+// whose timestamp is too close to when the manifest was written to be trusted,
+// are read and rehashed. A shader is dirty when any of its files changed.
+
+#define DXC_DEPS_MAGIC   DXC_FOURCC('D', 'X', 'D', 'M')
+#define DXC_DEPS_VERSION 1
+#define DXC_DEPS_ABSENT  0x1 // The file did not exist when it was looked up
+
+#define DXC_DEPS_NOT_FOUND 0xFFFFFFFFu
+
+// Timestamps this close to the manifest write time are rehashed on check
+#ifndef DXC_DEPS_RACY_NS
+    #define DXC_DEPS_RACY_NS 2000000000ull
+#endif
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcDepsHeader {
+    UINT32 Magic;
+    UINT32 Version;
+    UINT32 ShaderCount;
+    UINT32 FileCount;
+    UINT32 DepCount;
+    UINT32 Reserved;
+    UINT64 WriteTimeNs;    // CLOCK_REALTIME, comparable to file timestamps
+    UINT64 ShadersOffset;  // DxcDepsShader[ShaderCount], sorted by NameHash
+    UINT64 FilesOffset;    // DxcDepsFile[FileCount]
+    UINT64 DepsOffset;     // UINT32[DepCount], indices into the file table
+    UINT64 StringsOffset;  // NUL-terminated UTF-8 names and paths
+    UINT64 FileSize;
+} DxcDepsHeader;
+
+typedef struct DxcDepsFile {
+    DxcHash Hash;
+    UINT64  MTimeNs;
+    UINT64  Size;
+    UINT32  PathOffset; // Relative to StringsOffset
+    UINT32  Flags;      // DXC_DEPS_*
+} DxcDepsFile;
+
+typedef struct DxcDepsShader {
+    DxcHash NameHash;
+    DxcHash ConfigHash; // Caller-defined, e.g. a hash of the arguments
+    UINT32  NameOffset;
+    UINT32  FirstDep;
+    UINT32  DepCount;
+    UINT32  Reserved;
+} DxcDepsShader;
+
+typedef struct DxcDepsManifest {
+    const BYTE          *pBase;
+    SIZE_T               Size;
+    const DxcDepsHeader *pHeader;
+    const DxcDepsShader *pShaders;
+    const DxcDepsFile   *pFiles;
+    const UINT32        *pDeps;
+    const char          *pStrings;
+} DxcDepsManifest;
+
+typedef struct DxcDepsCheckStats {
+    UINT32 FilesChecked;
+    UINT32 FilesRehashed;
+    UINT32 FilesChanged;
+    UINT32 ShadersDirty;
+    UINT64 Nanoseconds;
+} DxcDepsCheckStats;
+
+typedef struct DxcDepsRecord {
+    char   *pPath;
+    DxcHash Hash;
+    UINT64  MTimeNs;
+    UINT64  Size;
+    UINT32  Flags;
+} DxcDepsRecord;
+
+// Key is the path hash in a tracker, and the hash of path, content hash and
+// flags in a writer
+typedef struct DxcDepsKeyedRecord {
+    DxcHash       Key;
+    DxcDepsRecord Record;
+} DxcDepsKeyedRecord;
+
+typedef struct DxcDepsTracker {
+    void *const        *v;
+    atomic_uint         RefCount;
+    IDxcIncludeHandler *pInner;
+    pthread_mutex_t     Lock;    // Guards the records
+    DxcHashTable        Records; // DxcDepsKeyedRecord
+} DxcDepsTracker;
+
+typedef struct DxcDepsWriterShader {
+    DxcHash NameHash;
+    char   *pName;
+    DxcHash ConfigHash;
+    UINT32  FirstDep;
+    UINT32  DepCount;
+} DxcDepsWriterShader;
+
+typedef struct DxcDepsWriter {
+    DxcHashTable         Files;   // DxcDepsKeyedRecord
+    DxcHashTable         Shaders; // DxcDepsWriterShader keyed by NameHash
+    UINT32              *pDeps;
+    UINT32               DepCount;
+    UINT32               DepCapacity;
+} DxcDepsWriter;
+
+// --- Internals --------------------------------------------------------------
+static inline UINT64 DxcDeps_StatTime(const struct stat *st) {
+#if defined(__APPLE__)
+    return (UINT64)st->st_mtimespec.tv_sec * 1000000000ull + (UINT64)st->st_mtimespec.tv_nsec;
+#else
+    return (UINT64)st->st_mtim.tv_sec * 1000000000ull + (UINT64)st->st_mtim.tv_nsec;
+#endif
+}
+
+// Fills size and time from stat, or marks the record absent
+static inline void DxcDeps_StatRecord(const char *pPath, DxcDepsRecord *pRecord) {
+    struct stat st;
+    if (stat(pPath, &st) == 0 && S_ISREG(st.st_mode)) {
+        pRecord->MTimeNs = DxcDeps_StatTime(&st);
+        pRecord->Size = (UINT64)st.st_size;
+        pRecord->Flags = 0;
+    }
+    else {
+        pRecord->MTimeNs = 0;
+        pRecord->Size = 0;
+        pRecord->Flags = DXC_DEPS_ABSENT;
+    }
+}
+
+static inline BOOL DxcDeps_HashFile(const char *pPath, UINT64 size, DxcHash *pHash) {
+    int fd = open(pPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+
+    BOOL ok = 1;
+    if (size == 0) {
+        *pHash = DxcHash_Compute("", 0, 0);
+    }
+    else {
+        void *data = mmap(NULL, (SIZE_T)size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ok = 0;
+        }
+        else {
+            *pHash = DxcHash_Compute(data, (SIZE_T)size, 0);
+            munmap(data, (SIZE_T)size);
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+static inline BOOL DxcDeps_Grow(void **ppData, UINT32 *pCapacity, UINT32 required, SIZE_T elementSize) {
+    if (required <= *pCapacity) {
+        return 1;
+    }
+    UINT32 capacity = *pCapacity ? *pCapacity * 2 : 64;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    void *data = realloc(*ppData, capacity * elementSize);
+    if (!data) {
+        return 0;
+    }
+    *ppData = data;
+    *pCapacity = capacity;
+    return 1;
+}
+
+static inline DxcDepsRecord *DxcDeps_Record(const DxcHashTable *table, UINT32 index) {
+    return &((DxcDepsKeyedRecord*)DxcHashTable_Entry(table, index))->Record;
+}
+
+// Takes ownership of pRecord->pPath. The first record of a path wins.
+static inline HRESULT DxcDepsTracker_AddRecord(DxcDepsTracker *self, const DxcDepsRecord *pRecord) {
+    DxcDepsKeyedRecord entry;
+    entry.Key = DxcHash_Compute(pRecord->pPath, strlen(pRecord->pPath), 0);
+    entry.Record = *pRecord;
+
+    pthread_mutex_lock(&self->Lock);
+    HRESULT hr = DxcHashTable_Insert(&self->Records, &entry, NULL);
+    pthread_mutex_unlock(&self->Lock);
+
+    if (hr != S_OK) {
+        free(pRecord->pPath);
+    }
+    return SUCCEEDED(hr) ? S_OK : hr;
+}
+
+static inline void DxcDepsTracker_ClearRecords(DxcDepsTracker *self) {
+    for (UINT32 i = 0; i < self->Records.EntryCount; ++i) {
+        free(DxcDeps_Record(&self->Records, i)->pPath);
+    }
+    DxcHashTable_Clear(&self->Records);
+}
+
+static inline ULONG __stdcall DxcDepsTracker_AddRef(DxcDepsTracker *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcDepsTracker_Release(DxcDepsTracker *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        DxcDepsTracker_ClearRecords(self);
+        DxcHashTable_Destroy(&self->Records);
+        pthread_mutex_destroy(&self->Lock);
+        IDxcIncludeHandler_Release(self->pInner);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcDepsTracker_QueryInterface(DxcDepsTracker *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcIncludeHandler, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcDepsTracker_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcDepsTracker_LoadSource(DxcDepsTracker *self, LPCWSTR pFilename, IDxcBlob **ppIncludeSource) {
+    if (!pFilename || !ppIncludeSource) {
+        return E_INVALIDARG;
+    }
+
+    SIZE_T length = wcslen(pFilename);
+    char *path = (char*)malloc(length * 4 + 1);
+    BOOL tracked = path != NULL;
+    if (tracked) {
+        path[DxcUtf8_FromWide(pFilename, length, path)] = '\0';
+    }
+
+    // Stat before reading: a write after this point moves the timestamp and is seen by the next check
+    DxcDepsRecord record;
+    memset(&record, 0, sizeof(record));
+    if (tracked) {
+        DxcDeps_StatRecord(path, &record);
+    }
+
+    HRESULT hr = IDxcIncludeHandler_LoadSource(self->pInner, pFilename, ppIncludeSource);
+    if (!tracked) {
+        return hr;
+    }
+
+    if (SUCCEEDED(hr) && *ppIncludeSource) {
+        record.Hash = DxcHash_Compute(IDxcBlob_GetBufferPointer(*ppIncludeSource), IDxcBlob_GetBufferSize(*ppIncludeSource), 0);
+        record.Flags &= ~(UINT32)DXC_DEPS_ABSENT;
+    }
+    else {
+        memset(&record.Hash, 0, sizeof(record.Hash));
+        record.Flags |= DXC_DEPS_ABSENT;
+    }
+
+    record.pPath = path;
+    DxcDepsTracker_AddRecord(self, &record);
+    return hr;
+}
+
+static void *const DxcDepsTracker_Vtbl[] = {
+    (void*)DxcDepsTracker_QueryInterface,
+    (void*)DxcDepsTracker_AddRef,
+    (void*)DxcDepsTracker_Release,
+    (void*)DxcDepsTracker_LoadSource,
+};
+
+// Returns the index of an equal file record, adding a copy if there is none
+static inline UINT32 DxcDepsWriter_InternFile(DxcDepsWriter *writer, const DxcDepsRecord *pRecord) {
+    DxcHasher hasher;
+    DxcHasher_Init(&hasher, 0);
+    DxcHasher_UpdateField(&hasher, pRecord->pPath, strlen(pRecord->pPath));
+    DxcHasher_UpdateField(&hasher, &pRecord->Hash, sizeof(pRecord->Hash));
+    DxcHasher_UpdateField(&hasher, &pRecord->Flags, sizeof(pRecord->Flags));
+
+    DxcDepsKeyedRecord entry;
+    entry.Key = DxcHasher_Final(&hasher);
+    const BYTE *file = (const BYTE*)DxcHashTable_Find(&writer->Files, entry.Key.Digest);
+    if (file) {
+        return (UINT32)((SIZE_T)(file - writer->Files.pEntries) / sizeof(DxcDepsKeyedRecord));
+    }
+
+    entry.Record = *pRecord;
+    entry.Record.pPath = (char*)malloc(strlen(pRecord->pPath) + 1);
+    if (!entry.Record.pPath || DxcHashTable_Insert(&writer->Files, &entry, NULL) != S_OK) {
+        free(entry.Record.pPath);
+        return DXC_DEPS_NOT_FOUND;
+    }
+    strcpy(entry.Record.pPath, pRecord->pPath);
+    return writer->Files.EntryCount - 1;
+}
+
+// Starts a shader entry, replacing any earlier entry with the same name
+static inline DxcDepsWriterShader *DxcDepsWriter_BeginShader(DxcDepsWriter *writer, const char *pName, const DxcHash *pConfigHash) {
+    DxcDepsWriterShader entry;
+    entry.NameHash = DxcHash_Compute(pName, strlen(pName), 0);
+    entry.pName = NULL;
+    entry.ConfigHash = *pConfigHash;
+    entry.FirstDep = writer->DepCount;
+    entry.DepCount = 0;
+
+    DxcDepsWriterShader *shader = (DxcDepsWriterShader*)DxcHashTable_Find(&writer->Shaders, entry.NameHash.Digest);
+    if (shader) {
+        entry.pName = shader->pName;
+        *shader = entry;
+        return shader;
+    }
+
+    entry.pName = (char*)malloc(strlen(pName) + 1);
+    if (!entry.pName || DxcHashTable_Insert(&writer->Shaders, &entry, (void**)&shader) != S_OK) {
+        free(entry.pName);
+        return NULL;
+    }
+    strcpy(entry.pName, pName);
+    return shader;
+}
+
+static inline HRESULT DxcDepsWriter_AddDep(DxcDepsWriter *writer, DxcDepsWriterShader *pShader, const DxcDepsRecord *pRecord) {
+    UINT32 file = DxcDepsWriter_InternFile(writer, pRecord);
+    if (file == DXC_DEPS_NOT_FOUND || !DxcDeps_Grow((void**)&writer->pDeps, &writer->DepCapacity, writer->DepCount + 1, sizeof(UINT32))) {
+        return E_OUTOFMEMORY;
+    }
+    writer->pDeps[writer->DepCount++] = file;
+    pShader->DepCount++;
+    return S_OK;
+}
+
+static inline int DxcDepsWriter_CompareShaders(const void *a, const void *b) {
+    return memcmp(((const DxcDepsWriterShader*)a)->NameHash.Digest, ((const DxcDepsWriterShader*)b)->NameHash.Digest, sizeof(DxcHash));
+}
+
+// --- Methods ----------------------------------------------------------------
+// Creates a tracker that forwards to pInner and records what it returns
+static inline HRESULT DxcDepsTracker_Create(IDxcIncludeHandler *pInner, IDxcIncludeHandler **ppHandler) {
+    if (!pInner || !ppHandler) {
+        return E_INVALIDARG;
+    }
+
+    DxcDepsTracker *self = (DxcDepsTracker*)calloc(1, sizeof(DxcDepsTracker));
+    if (!self) {
+        *ppHandler = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    self->v = DxcDepsTracker_Vtbl;
+    atomic_init(&self->RefCount, 1);
+    self->pInner = pInner;
+    pthread_mutex_init(&self->Lock, NULL);
+    DxcHashTable_Init(&self->Records, sizeof(DxcDepsKeyedRecord));
+    IDxcIncludeHandler_AddRef(pInner);
+
+    *ppHandler = (IDxcIncludeHandler*)self;
+    return S_OK;
+}
+
+// Records the main source file, which DXC receives directly rather than
+// through the include handler. Call it right after reading the file.
+static inline HRESULT DxcDepsTracker_RecordFile(IDxcIncludeHandler *pHandler, const char *pPath, const void *pData, SIZE_T size) {
+    DxcDepsTracker *self = (DxcDepsTracker*)pHandler;
+    DxcDepsRecord record;
+    DxcDeps_StatRecord(pPath, &record);
+    record.Hash = DxcHash_Compute(pData, size, 0);
+    record.Flags &= ~(UINT32)DXC_DEPS_ABSENT;
+    record.pPath = (char*)malloc(strlen(pPath) + 1);
+    if (!record.pPath) {
+        return E_OUTOFMEMORY;
+    }
+    strcpy(record.pPath, pPath);
+    return DxcDepsTracker_AddRecord(self, &record);
+}
+
+// Forgets every recorded file so the tracker can serve the next compile
+static inline void DxcDepsTracker_Reset(IDxcIncludeHandler *pHandler) {
+    DxcDepsTracker *self = (DxcDepsTracker*)pHandler;
+    pthread_mutex_lock(&self->Lock);
+    DxcDepsTracker_ClearRecords(self);
+    pthread_mutex_unlock(&self->Lock);
+}
+
+static inline HRESULT DxcDepsWriter_Create(DxcDepsWriter **ppWriter) {
+    if (!ppWriter) {
+        return E_INVALIDARG;
+    }
+    *ppWriter = (DxcDepsWriter*)calloc(1, sizeof(DxcDepsWriter));
+    if (!*ppWriter) {
+        return E_OUTOFMEMORY;
+    }
+    DxcHashTable_Init(&(*ppWriter)->Files, sizeof(DxcDepsKeyedRecord));
+    DxcHashTable_Init(&(*ppWriter)->Shaders, sizeof(DxcDepsWriterShader));
+    return S_OK;
+}
+
+static inline void DxcDepsWriter_Destroy(DxcDepsWriter *writer) {
+    if (!writer) {
+        return;
+    }
+    for (UINT32 i = 0; i < writer->Files.EntryCount; ++i) {
+        free(DxcDeps_Record(&writer->Files, i)->pPath);
+    }
+    for (UINT32 i = 0; i < writer->Shaders.EntryCount; ++i) {
+        free(((DxcDepsWriterShader*)DxcHashTable_Entry(&writer->Shaders, i))->pName);
+    }
+    DxcHashTable_Destroy(&writer->Files);
+    DxcHashTable_Destroy(&writer->Shaders);
+    free(writer->pDeps);
+    free(writer);
+}
+
+// Adds a compiled shader with everything its tracker recorded. pConfigHash
+// identifies the arguments; a change to it makes the shader dirty.
+static inline HRESULT DxcDepsWriter_AddShader(DxcDepsWriter *writer, const char *pName, const DxcHash *pConfigHash, IDxcIncludeHandler *pTracker) {
+    DxcDepsTracker *tracker = (DxcDepsTracker*)pTracker;
+    DxcDepsWriterShader *shader = DxcDepsWriter_BeginShader(writer, pName, pConfigHash);
+    if (!shader) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = S_OK;
+    pthread_mutex_lock(&tracker->Lock);
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < tracker->Records.EntryCount; ++i) {
+        hr = DxcDepsWriter_AddDep(writer, shader, DxcDeps_Record(&tracker->Records, i));
+    }
+    pthread_mutex_unlock(&tracker->Lock);
+    return hr;
+}
+
+// Carries an up-to-date shader over from the previous manifest
+static inline HRESULT DxcDepsWriter_AddFromManifest(DxcDepsWriter *writer, const DxcDepsManifest *pManifest, UINT32 shaderIndex) {
+    const DxcDepsShader *source = &pManifest->pShaders[shaderIndex];
+    DxcDepsWriterShader *shader = DxcDepsWriter_BeginShader(writer, pManifest->pStrings + source->NameOffset, &source->ConfigHash);
+    if (!shader) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = S_OK;
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < source->DepCount; ++i) {
+        const DxcDepsFile *file = &pManifest->pFiles[pManifest->pDeps[source->FirstDep + i]];
+        DxcDepsRecord record;
+        record.pPath = (char*)(pManifest->pStrings + file->PathOffset);
+        record.Hash = file->Hash;
+        record.MTimeNs = file->MTimeNs;
+        record.Size = file->Size;
+        record.Flags = file->Flags;
+        hr = DxcDepsWriter_AddDep(writer, shader, &record);
+    }
+    return hr;
+}
+
+// Writes the manifest through a temporary file and an atomic rename. Only
+// files still referenced by a shader are kept.
+static inline HRESULT DxcDepsWriter_Write(DxcDepsWriter *writer, const char *pPath) {
+    DxcDepsWriterShader *shaders = (DxcDepsWriterShader*)malloc((writer->Shaders.EntryCount + 1) * sizeof(DxcDepsWriterShader));
+    UINT32 *remap = (UINT32*)malloc((writer->Files.EntryCount + 1) * sizeof(UINT32));
+    if (!shaders || !remap) {
+        free(remap);
+        free(shaders);
+        return E_OUTOFMEMORY;
+    }
+    memcpy(shaders, writer->Shaders.pEntries, writer->Shaders.EntryCount * sizeof(DxcDepsWriterShader));
+    qsort(shaders, writer->Shaders.EntryCount, sizeof(DxcDepsWriterShader), DxcDepsWriter_CompareShaders);
+
+    // Assign final file indices and string offsets in first-use order
+    memset(remap, 0xFF, (writer->Files.EntryCount + 1) * sizeof(UINT32));
+    UINT32 fileCount = 0;
+    UINT32 depCount = 0;
+    UINT64 stringBytes = 0;
+    for (UINT32 i = 0; i < writer->Shaders.EntryCount; ++i) {
+        stringBytes += strlen(shaders[i].pName) + 1;
+        for (UINT32 j = 0; j < shaders[i].DepCount; ++j) {
+            UINT32 file = writer->pDeps[shaders[i].FirstDep + j];
+            if (remap[file] == DXC_DEPS_NOT_FOUND) {
+                remap[file] = fileCount++;
+                stringBytes += strlen(DxcDeps_Record(&writer->Files, file)->pPath) + 1;
+            }
+        }
+        depCount += shaders[i].DepCount;
+    }
+    if (stringBytes > 0xFFFFFFFFull) {
+        free(remap);
+        free(shaders);
+        return E_INVALIDARG;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    DxcDepsHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = DXC_DEPS_MAGIC;
+    header.Version = DXC_DEPS_VERSION;
+    header.ShaderCount = writer->Shaders.EntryCount;
+    header.FileCount = fileCount;
+    header.DepCount = depCount;
+    header.WriteTimeNs = (UINT64)now.tv_sec * 1000000000ull + (UINT64)now.tv_nsec;
+    header.ShadersOffset = sizeof(DxcDepsHeader);
+    header.FilesOffset = header.ShadersOffset + (UINT64)writer->Shaders.EntryCount * sizeof(DxcDepsShader);
+    header.DepsOffset = header.FilesOffset + (UINT64)fileCount * sizeof(DxcDepsFile);
+    header.StringsOffset = header.DepsOffset + (UINT64)depCount * sizeof(UINT32);
+    header.FileSize = header.StringsOffset + stringBytes;
+
+    char tempPath[4096];
+    FILE *file = DxcUtil_CreateTemp(pPath, tempPath, sizeof(tempPath));
+    HRESULT hr = file ? S_OK : E_FAIL;
+
+    if (SUCCEEDED(hr)) { hr = DxcUtil_WriteAll(file, &header, sizeof(header)); }
+
+    // Shaders: names come first in the string section, then paths in file order
+    UINT32 stringOffset = 0;
+    UINT32 firstDep = 0;
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < writer->Shaders.EntryCount; ++i) {
+        DxcDepsShader shader;
+        memset(&shader, 0, sizeof(shader));
+        shader.NameHash = shaders[i].NameHash;
+        shader.ConfigHash = shaders[i].ConfigHash;
+        shader.NameOffset = stringOffset;
+        shader.FirstDep = firstDep;
+        shader.DepCount = shaders[i].DepCount;
+        stringOffset += (UINT32)strlen(shaders[i].pName) + 1;
+        firstDep += shaders[i].DepCount;
+        hr = DxcUtil_WriteAll(file, &shader, sizeof(shader));
+    }
+
+    // Files, in remapped order
+    UINT32 *order = SUCCEEDED(hr) ? (UINT32*)malloc((fileCount + 1) * sizeof(UINT32)) : NULL;
+    if (SUCCEEDED(hr) && !order) {
+        hr = E_OUTOFMEMORY;
+    }
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < writer->Files.EntryCount; ++i) {
+        if (remap[i] != DXC_DEPS_NOT_FOUND) {
+            order[remap[i]] = i;
+        }
+    }
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < fileCount; ++i) {
+        const DxcDepsRecord *record = DxcDeps_Record(&writer->Files, order[i]);
+        DxcDepsFile entry;
+        entry.Hash = record->Hash;
+        entry.MTimeNs = record->MTimeNs;
+        entry.Size = record->Size;
+        entry.PathOffset = stringOffset;
+        entry.Flags = record->Flags;
+        stringOffset += (UINT32)strlen(record->pPath) + 1;
+        hr = DxcUtil_WriteAll(file, &entry, sizeof(entry));
+    }
+
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < writer->Shaders.EntryCount; ++i) {
+        for (UINT32 j = 0; SUCCEEDED(hr) && j < shaders[i].DepCount; ++j) {
+            UINT32 dep = remap[writer->pDeps[shaders[i].FirstDep + j]];
+            hr = DxcUtil_WriteAll(file, &dep, sizeof(dep));
+        }
+    }
+
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < writer->Shaders.EntryCount; ++i) {
+        hr = DxcUtil_WriteAll(file, shaders[i].pName, strlen(shaders[i].pName) + 1);
+    }
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < fileCount; ++i) {
+        const char *path = DxcDeps_Record(&writer->Files, order[i])->pPath;
+        hr = DxcUtil_WriteAll(file, path, strlen(path) + 1);
+    }
+
+    if (file) {
+        hr = DxcUtil_FinishTemp(file, tempPath, pPath, hr);
+    }
+
+    free(order);
+    free(remap);
+    free(shaders);
+    return hr;
+}
+
+static inline void DxcDepsManifest_Close(DxcDepsManifest *manifest) {
+    if (manifest) {
+        munmap((void*)manifest->pBase, manifest->Size);
+        free(manifest);
+    }
+}
+
+// Maps a manifest and validates every table bound once
+static inline HRESULT DxcDepsManifest_Open(const char *pPath, DxcDepsManifest **ppManifest) {
+    if (!pPath || !ppManifest) {
+        return E_INVALIDARG;
+    }
+
+    *ppManifest = NULL;
+
+    int fd = open(pPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return E_FAIL;
+    }
+
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (SIZE_T)st.st_size >= sizeof(DxcDepsHeader)) {
+        base = mmap(NULL, (SIZE_T)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        return E_FAIL;
+    }
+
+    SIZE_T size = (SIZE_T)st.st_size;
+    const BYTE *data = (const BYTE*)base;
+    const DxcDepsHeader *header = (const DxcDepsHeader*)data;
+    UINT64 stringBytes = header->FileSize - header->StringsOffset;
+    BOOL valid = header->Magic == DXC_DEPS_MAGIC && header->Version == DXC_DEPS_VERSION && header->FileSize == size &&
+                 header->ShadersOffset == sizeof(DxcDepsHeader) &&
+                 header->FilesOffset == header->ShadersOffset + (UINT64)header->ShaderCount * sizeof(DxcDepsShader) &&
+                 header->DepsOffset == header->FilesOffset + (UINT64)header->FileCount * sizeof(DxcDepsFile) &&
+                 header->StringsOffset == header->DepsOffset + (UINT64)header->DepCount * sizeof(UINT32) &&
+                 header->StringsOffset <= size && (stringBytes == 0 || data[size - 1] == '\0');
+
+    const DxcDepsShader *shaders = (const DxcDepsShader*)(data + header->ShadersOffset);
+    const DxcDepsFile *files = (const DxcDepsFile*)(data + header->FilesOffset);
+    const UINT32 *deps = (const UINT32*)(data + header->DepsOffset);
+
+    for (UINT32 i = 0; valid && i < header->ShaderCount; ++i) {
+        valid = shaders[i].NameOffset < stringBytes && (UINT64)shaders[i].FirstDep + shaders[i].DepCount <= header->DepCount;
+    }
+    for (UINT32 i = 0; valid && i < header->FileCount; ++i) {
+        valid = files[i].PathOffset < stringBytes;
+    }
+    for (UINT32 i = 0; valid && i < header->DepCount; ++i) {
+        valid = deps[i] < header->FileCount;
+    }
+
+    DxcDepsManifest *manifest = valid ? (DxcDepsManifest*)malloc(sizeof(DxcDepsManifest)) : NULL;
+    if (!manifest) {
+        munmap(base, size);
+        return valid ? E_OUTOFMEMORY : E_INVALIDARG;
+    }
+
+    manifest->pBase = data;
+    manifest->Size = size;
+    manifest->pHeader = header;
+    manifest->pShaders = shaders;
+    manifest->pFiles = files;
+    manifest->pDeps = deps;
+    manifest->pStrings = (const char*)(data + header->StringsOffset);
+
+    *ppManifest = manifest;
+    return S_OK;
+}
+
+static inline UINT32 DxcDepsManifest_GetShaderCount(const DxcDepsManifest *manifest) { return manifest->pHeader->ShaderCount; }
+static inline const char *DxcDepsManifest_GetShaderName(const DxcDepsManifest *manifest, UINT32 index) { return manifest->pStrings + manifest->pShaders[index].NameOffset; }
+
+// Returns the index of the named shader, or DXC_DEPS_NOT_FOUND
+static inline UINT32 DxcDepsManifest_FindShader(const DxcDepsManifest *manifest, const char *pName) {
+    DxcHash hash = DxcHash_Compute(pName, strlen(pName), 0);
+    UINT32 lo = 0;
+    UINT32 hi = manifest->pHeader->ShaderCount;
+    while (lo < hi) {
+        UINT32 mid = lo + (hi - lo) / 2;
+        if (memcmp(manifest->pShaders[mid].NameHash.Digest, hash.Digest, sizeof(hash.Digest)) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    for (; lo < manifest->pHeader->ShaderCount && DxcHash_Equal(&manifest->pShaders[lo].NameHash, &hash); ++lo) {
+        if (strcmp(manifest->pStrings + manifest->pShaders[lo].NameOffset, pName) == 0) {
+            return lo;
+        }
+    }
+    return DXC_DEPS_NOT_FOUND;
+}
+
+// Stats every distinct file once and sets pDirty[i] for each shader with a
+// changed dependency. pDirty must hold DxcDepsManifest_GetShaderCount bytes.
+static inline HRESULT DxcDepsManifest_Check(const DxcDepsManifest *manifest, BYTE *pDirty, DxcDepsCheckStats *pStats) {
+    UINT64 start = DxcUtil_Now();
+
+    const DxcDepsHeader *header = manifest->pHeader;
+    BYTE *changed = (BYTE*)malloc(header->FileCount + 1);
+    if (!changed) {
+        return E_OUTOFMEMORY;
+    }
+
+    DxcDepsCheckStats stats;
+    memset(&stats, 0, sizeof(stats));
+    UINT64 racyAfter = header->WriteTimeNs > DXC_DEPS_RACY_NS ? header->WriteTimeNs - DXC_DEPS_RACY_NS : 0;
+
+    for (UINT32 i = 0; i < header->FileCount; ++i) {
+        const DxcDepsFile *file = &manifest->pFiles[i];
+        const char *path = manifest->pStrings + file->PathOffset;
+        DxcDepsRecord current;
+        DxcDeps_StatRecord(path, &current);
+        stats.FilesChecked++;
+
+        if ((file->Flags & DXC_DEPS_ABSENT) || (current.Flags & DXC_DEPS_ABSENT)) {
+            changed[i] = (file->Flags & DXC_DEPS_ABSENT) != (current.Flags & DXC_DEPS_ABSENT);
+        }
+        else if (current.Size != file->Size) {
+            changed[i] = 1;
+        }
+        else if (current.MTimeNs == file->MTimeNs && current.MTimeNs < racyAfter) {
+            changed[i] = 0;
+        }
+        else {
+            stats.FilesRehashed++;
+            changed[i] = !DxcDeps_HashFile(path, current.Size, &current.Hash) || !DxcHash_Equal(&current.Hash, &file->Hash);
+        }
+        stats.FilesChanged += changed[i];
+    }
+
+    for (UINT32 i = 0; i < header->ShaderCount; ++i) {
+        const DxcDepsShader *shader = &manifest->pShaders[i];
+        BYTE dirty = 0;
+        for (UINT32 j = 0; j < shader->DepCount && !dirty; ++j) {
+            dirty = changed[manifest->pDeps[shader->FirstDep + j]];
+        }
+        pDirty[i] = dirty;
+        stats.ShadersDirty += dirty;
+    }
+    free(changed);
+
+    stats.Nanoseconds = DxcUtil_Now() - start;
+    if (pStats) {
+        *pStats = stats;
+    }
+    return S_OK;
+}
+
+// Returns whether a shader must be recompiled: it is unknown to the manifest,
+// its configuration changed, or Check found a changed dependency
+static inline BOOL DxcDepsManifest_NeedsBuild(const DxcDepsManifest *manifest, const BYTE *pDirty, const char *pName, const DxcHash *pConfigHash) {
+    UINT32 index = manifest ? DxcDepsManifest_FindShader(manifest, pName) : DXC_DEPS_NOT_FOUND;
+    if (index == DXC_DEPS_NOT_FOUND) {
+        return 1;
+    }
+    return pDirty[index] || !DxcHash_Equal(&manifest->pShaders[index].ConfigHash, pConfigHash);
+}
+
+#endif /* __DXC_DEPS_C__ */
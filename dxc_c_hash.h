@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_hash.h                                                              //
+// Streaming 128-bit content hash shared by the companion headers            //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_HASH_C__
+#define __DXC_HASH_C__
+
+#include "dxc_c.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// NOTE: MurmurHash3 x64 128-bit. Not cryptographic; used for content
+// addressing where inputs are not adversarial. Digests are little-endian.
+// DxcHashTable indexes records by such digests, using the first four bytes
+// of the key as the bucket.
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcHash { BYTE Digest[16]; } DxcHash;
+
+typedef struct DxcHasher {
+    UINT64 H1;
+    UINT64 H2;
+    UINT64 Length;
+    BYTE   Tail[16];
+    UINT32 TailSize;
+} DxcHasher;
+
+// Growable array of fixed-size entries that each begin with a 16-byte key,
+// indexed by open addressing. Not synchronized; owners hold their own lock.
+typedef struct DxcHashTable {
+    BYTE   *pEntries;
+    UINT32  EntrySize;
+    UINT32  EntryCount;
+    UINT32  EntryCapacity;
+    UINT32 *pSlots;    // Entry index + 1
+    UINT32  SlotCount; // Power of two
+} DxcHashTable;
+
+// --- Internals --------------------------------------------------------------
+#define DXC_HASH_C1 0x87c37b91114253d5ull
+#define DXC_HASH_C2 0x4cf5ad432745937full
+
+static inline UINT64 DxcHash_Rotl(UINT64 x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline UINT64 DxcHash_Mix(UINT64 k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+static inline void DxcHasher_Block(DxcHasher *hasher, const BYTE *block) {
+    UINT64 k1, k2;
+    memcpy(&k1, block, 8);
+    memcpy(&k2, block + 8, 8);
+
+    k1 *= DXC_HASH_C1; k1 = DxcHash_Rotl(k1, 31); k1 *= DXC_HASH_C2; hasher->H1 ^= k1;
+    hasher->H1 = DxcHash_Rotl(hasher->H1, 27); hasher->H1 += hasher->H2; hasher->H1 = hasher->H1 * 5 + 0x52dce729;
+
+    k2 *= DXC_HASH_C2; k2 = DxcHash_Rotl(k2, 33); k2 *= DXC_HASH_C1; hasher->H2 ^= k2;
+    hasher->H2 = DxcHash_Rotl(hasher->H2, 31); hasher->H2 += hasher->H1; hasher->H2 = hasher->H2 * 5 + 0x38495ab5;
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline void DxcHasher_Init(DxcHasher *hasher, UINT64 seed) {
+    memset(hasher, 0, sizeof(DxcHasher));
+    hasher->H1 = seed;
+    hasher->H2 = seed;
+}
+
+static inline void DxcHasher_Update(DxcHasher *hasher, const void *pData, SIZE_T size) {
+    const BYTE *data = (const BYTE*)pData;
+    hasher->Length += size;
+
+    if (hasher->TailSize) {
+        SIZE_T fill = 16 - hasher->TailSize;
+        if (fill > size) {
+            fill = size;
+        }
+        memcpy(hasher->Tail + hasher->TailSize, data, fill);
+        hasher->TailSize += (UINT32)fill;
+        data += fill;
+        size -= fill;
+
+        if (hasher->TailSize < 16) {
+            return;
+        }
+        DxcHasher_Block(hasher, hasher->Tail);
+        hasher->TailSize = 0;
+    }
+
+    for (; size >= 16; data += 16, size -= 16) {
+        DxcHasher_Block(hasher, data);
+    }
+
+    memcpy(hasher->Tail, data, size);
+    hasher->TailSize = (UINT32)size;
+}
+
+// Hashes a length-prefixed field so that adjacent fields cannot alias
+static inline void DxcHasher_UpdateField(DxcHasher *hasher, const void *pData, SIZE_T size) {
+    UINT64 length = size;
+    DxcHasher_Update(hasher, &length, sizeof(length));
+    DxcHasher_Update(hasher, pData, size);
+}
+
+static inline void DxcHasher_UpdateWide(DxcHasher *hasher, LPCWSTR pString) {
+    DxcHasher_UpdateField(hasher, pString, pString ? wcslen(pString) * sizeof(WCHAR) : 0);
+}
+
+static inline DxcHash DxcHasher_Final(const DxcHasher *hasher) {
+    UINT64 h1 = hasher->H1;
+    UINT64 h2 = hasher->H2;
+    UINT64 k1 = 0;
+    UINT64 k2 = 0;
+    const BYTE *tail = hasher->Tail;
+
+    switch (hasher->TailSize) {
+    case 15: k2 ^= (UINT64)tail[14] << 48; // fallthrough
+    case 14: k2 ^= (UINT64)tail[13] << 40; // fallthrough
+    case 13: k2 ^= (UINT64)tail[12] << 32; // fallthrough
+    case 12: k2 ^= (UINT64)tail[11] << 24; // fallthrough
+    case 11: k2 ^= (UINT64)tail[10] << 16; // fallthrough
+    case 10: k2 ^= (UINT64)tail[9] << 8;   // fallthrough
+    case 9:  k2 ^= (UINT64)tail[8];
+             k2 *= DXC_HASH_C2; k2 = DxcHash_Rotl(k2, 33); k2 *= DXC_HASH_C1; h2 ^= k2; // fallthrough
+    case 8:  k1 ^= (UINT64)tail[7] << 56;  // fallthrough
+    case 7:  k1 ^= (UINT64)tail[6] << 48;  // fallthrough
+    case 6:  k1 ^= (UINT64)tail[5] << 40;  // fallthrough
+    case 5:  k1 ^= (UINT64)tail[4] << 32;  // fallthrough
+    case 4:  k1 ^= (UINT64)tail[3] << 24;  // fallthrough
+    case 3:  k1 ^= (UINT64)tail[2] << 16;  // fallthrough
+    case 2:  k1 ^= (UINT64)tail[1] << 8;   // fallthrough
+    case 1:  k1 ^= (UINT64)tail[0];
+             k1 *= DXC_HASH_C1; k1 = DxcHash_Rotl(k1, 31); k1 *= DXC_HASH_C2; h1 ^= k1;
+    default: break;
+    }
+
+    h1 ^= hasher->Length;
+    h2 ^= hasher->Length;
+    h1 += h2;
+    h2 += h1;
+    h1 = DxcHash_Mix(h1);
+    h2 = DxcHash_Mix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    DxcHash hash;
+    memcpy(hash.Digest, &h1, 8);
+    memcpy(hash.Digest + 8, &h2, 8);
+    return hash;
+}
+
+static inline DxcHash DxcHash_Compute(const void *pData, SIZE_T size, UINT64 seed) {
+    DxcHasher hasher;
+    DxcHasher_Init(&hasher, seed);
+    DxcHasher_Update(&hasher, pData, size);
+    return DxcHasher_Final(&hasher);
+}
+
+static inline BOOL DxcHash_Equal(const DxcHash *a, const DxcHash *b) {
+    return memcmp(a->Digest, b->Digest, sizeof(a->Digest)) == 0;
+}
+
+// Writes 32 lowercase hex digits plus a terminator into pBuffer
+static inline void DxcHash_ToHex(const DxcHash *hash, char pBuffer[33]) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 16; ++i) {
+        pBuffer[i * 2 + 0] = digits[hash->Digest[i] >> 4];
+        pBuffer[i * 2 + 1] = digits[hash->Digest[i] & 0xF];
+    }
+    pBuffer[32] = '\0';
+}
+
+static inline void DxcHashTable_Init(DxcHashTable *table, UINT32 entrySize) {
+    memset(table, 0, sizeof(DxcHashTable));
+    table->EntrySize = entrySize;
+}
+
+static inline void DxcHashTable_Destroy(DxcHashTable *table) {
+    free(table->pSlots);
+    free(table->pEntries);
+    DxcHashTable_Init(table, table->EntrySize);
+}
+
+// Removes every entry and keeps the allocations
+static inline void DxcHashTable_Clear(DxcHashTable *table) {
+    table->EntryCount = 0;
+    if (table->pSlots) {
+        memset(table->pSlots, 0, table->SlotCount * sizeof(UINT32));
+    }
+}
+
+static inline void *DxcHashTable_Entry(const DxcHashTable *table, UINT32 index) {
+    return table->pEntries + (SIZE_T)index * table->EntrySize;
+}
+
+// Returns the slot for key, which is either empty or holds the matching entry.
+// SlotCount must be non-zero.
+static inline UINT32 *DxcHashTable_Slot(const DxcHashTable *table, const BYTE key[16]) {
+    UINT32 index;
+    memcpy(&index, key, sizeof(index));
+    index &= table->SlotCount - 1;
+    while (table->pSlots[index] && memcmp(DxcHashTable_Entry(table, table->pSlots[index] - 1), key, 16) != 0) {
+        index = (index + 1) & (table->SlotCount - 1);
+    }
+    return &table->pSlots[index];
+}
+
+// Returns the entry for key, or NULL
+static inline void *DxcHashTable_Find(const DxcHashTable *table, const BYTE key[16]) {
+    UINT32 slot = table->SlotCount ? *DxcHashTable_Slot(table, key) : 0;
+    return slot ? DxcHashTable_Entry(table, slot - 1) : NULL;
+}
+
+// Copies pEntry in unless its key is present, in which case nothing changes
+// and S_FALSE is returned. Either way ppEntry, if given, receives the stored entry.
+static inline HRESULT DxcHashTable_Insert(DxcHashTable *table, const void *pEntry, void **ppEntry) {
+    if ((table->EntryCount + 1) * 2 > table->SlotCount) {
+        UINT32 slotCount = table->SlotCount ? table->SlotCount * 2 : 256;
+        UINT32 *slots = (UINT32*)calloc(slotCount, sizeof(UINT32));
+        if (!slots) {
+            return E_OUTOFMEMORY;
+        }
+        free(table->pSlots);
+        table->pSlots = slots;
+        table->SlotCount = slotCount;
+        for (UINT32 i = 0; i < table->EntryCount; ++i) {
+            *DxcHashTable_Slot(table, (const BYTE*)DxcHashTable_Entry(table, i)) = i + 1;
+        }
+    }
+
+    UINT32 *slot = DxcHashTable_Slot(table, (const BYTE*)pEntry);
+    if (*slot) {
+        if (ppEntry) {
+            *ppEntry = DxcHashTable_Entry(table, *slot - 1);
+        }
+        return S_FALSE;
+    }
+
+    if (table->EntryCount == table->EntryCapacity) {
+        UINT32 capacity = table->EntryCapacity ? table->EntryCapacity * 2 : 256;
+        BYTE *entries = (BYTE*)realloc(table->pEntries, (SIZE_T)capacity * table->EntrySize);
+        if (!entries) {
+            return E_OUTOFMEMORY;
+        }
+        table->pEntries = entries;
+        table->EntryCapacity = capacity;
+    }
+
+    void *entry = DxcHashTable_Entry(table, table->EntryCount);
+    memcpy(entry, pEntry, table->EntrySize);
+    *slot = ++table->EntryCount;
+    if (ppEntry) {
+        *ppEntry = entry;
+    }
+    return S_OK;
+}
+
+#endif /* __DXC_HASH_C__ */
@@ -0,0 +1,300 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_include.h                                                           //
+// Memoizing, zero-copy IDxcIncludeHandler implementation                    //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_INCLUDE_C__
+#define __DXC_INCLUDE_C__
+
+#include "dxc_c.h"
+#include "dxc_c_args.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX. Each file is mapped once, on first request, and
+// stays mapped until the handler is released; LoadSource hands out blobs
+// created with IDxcUtils_CreateBlobFromPinned over that mapping. Blobs must
+// therefore not outlive the handler. Failed lookups are memoized as well,
+// since DXC probes every include directory in turn. Files are assumed not to
+// change while the handler is alive. One handler may be shared by any number
+// of compiler threads.
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcMemoIncludeStats {
+    UINT64 Hits;        // Requests served from memory, including memoized failures
+    UINT64 Misses;      // Requests that went to the filesystem
+    UINT64 Files;       // Files currently mapped
+    UINT64 MappedBytes;
+} DxcMemoIncludeStats;
+
+typedef struct DxcMemoIncludeEntry {
+    DxcHash     Key;
+    WCHAR      *pFileName;
+    const void *pData; // NULL when the file could not be opened
+    SIZE_T      Size;
+    BOOL        Mapped;
+} DxcMemoIncludeEntry;
+
+typedef struct DxcMemoIncludeHandler {
+    void *const          *v;
+    atomic_uint           RefCount;
+    IDxcUtils            *pUtils;
+    UINT32                Encoding;
+    pthread_rwlock_t      Lock;      // Guards the table below
+    DxcMemoIncludeEntry **ppEntries; // Open addressing, power of two capacity
+    UINT32                Capacity;
+    UINT32                Count;
+    atomic_ullong         Hits;
+    atomic_ullong         Misses;
+    atomic_ullong         Files;
+    atomic_ullong         MappedBytes;
+} DxcMemoIncludeHandler;
+
+// --- Internals --------------------------------------------------------------
+static inline DxcMemoIncludeEntry *DxcMemoInclude_Find(DxcMemoIncludeHandler *self, const DxcHash *key, LPCWSTR pFileName) {
+    if (self->Capacity == 0) {
+        return NULL;
+    }
+
+    UINT32 mask = self->Capacity - 1;
+    UINT32 index;
+    memcpy(&index, key->Digest, sizeof(index));
+
+    for (index &= mask; self->ppEntries[index]; index = (index + 1) & mask) {
+        DxcMemoIncludeEntry *entry = self->ppEntries[index];
+        if (DxcHash_Equal(&entry->Key, key) && wcscmp(entry->pFileName, pFileName) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static inline BOOL DxcMemoInclude_Insert(DxcMemoIncludeHandler *self, DxcMemoIncludeEntry *entry) {
+    if ((self->Count + 1) * 2 > self->Capacity) {
+        UINT32 capacity = self->Capacity ? self->Capacity * 2 : 64;
+        DxcMemoIncludeEntry **entries = (DxcMemoIncludeEntry**)calloc(capacity, sizeof(DxcMemoIncludeEntry*));
+        if (!entries) {
+            return 0;
+        }
+        for (UINT32 i = 0; i < self->Capacity; ++i) {
+            if (self->ppEntries[i]) {
+                UINT32 index;
+                memcpy(&index, self->ppEntries[i]->Key.Digest, sizeof(index));
+                for (index &= capacity - 1; entries[index]; index = (index + 1) & (capacity - 1)) {}
+                entries[index] = self->ppEntries[i];
+            }
+        }
+        free(self->ppEntries);
+        self->ppEntries = entries;
+        self->Capacity = capacity;
+    }
+
+    UINT32 mask = self->Capacity - 1;
+    UINT32 index;
+    memcpy(&index, entry->Key.Digest, sizeof(index));
+    for (index &= mask; self->ppEntries[index]; index = (index + 1) & mask) {}
+    self->ppEntries[index] = entry;
+    self->Count++;
+    return 1;
+}
+
+static inline void DxcMemoInclude_FreeEntry(DxcMemoIncludeEntry *entry) {
+    if (entry->Mapped) {
+        munmap((void*)entry->pData, entry->Size);
+    }
+    free(entry->pFileName);
+    free(entry);
+}
+
+// Maps pFileName into a new entry. Unreadable files produce a negative entry.
+static inline DxcMemoIncludeEntry *DxcMemoInclude_Load(const DxcHash *key, LPCWSTR pFileName) {
+    static const char empty[1] = { 0 };
+    SIZE_T length = wcslen(pFileName);
+    DxcMemoIncludeEntry *entry = (DxcMemoIncludeEntry*)calloc(1, sizeof(DxcMemoIncludeEntry));
+    WCHAR *fileName = (WCHAR*)malloc((length + 1) * sizeof(WCHAR));
+    if (!entry || !fileName) {
+        free(fileName);
+        free(entry);
+        return NULL;
+    }
+
+    memcpy(fileName, pFileName, (length + 1) * sizeof(WCHAR));
+    entry->Key = *key;
+    entry->pFileName = fileName;
+
+    char *path = (char*)malloc(length * 4 + 1);
+    int fd = -1;
+    if (path) {
+        path[DxcUtf8_FromWide(pFileName, length, path)] = '\0';
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        free(path);
+    }
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            entry->pData = empty;
+        }
+        else {
+            void *data = mmap(NULL, (SIZE_T)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                entry->pData = data;
+                entry->Size = (SIZE_T)st.st_size;
+                entry->Mapped = 1;
+            }
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    return entry;
+}
+
+static inline ULONG __stdcall DxcMemoIncludeHandler_AddRef(DxcMemoIncludeHandler *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcMemoIncludeHandler_Release(DxcMemoIncludeHandler *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        for (UINT32 i = 0; i < self->Capacity; ++i) {
+            if (self->ppEntries[i]) {
+                DxcMemoInclude_FreeEntry(self->ppEntries[i]);
+            }
+        }
+        free(self->ppEntries);
+        pthread_rwlock_destroy(&self->Lock);
+        IDxcUtils_Release(self->pUtils);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcMemoIncludeHandler_QueryInterface(DxcMemoIncludeHandler *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcIncludeHandler, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcMemoIncludeHandler_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcMemoIncludeHandler_LoadSource(DxcMemoIncludeHandler *self, LPCWSTR pFilename, IDxcBlob **ppIncludeSource) {
+    if (!pFilename || !ppIncludeSource) {
+        return E_INVALIDARG;
+    }
+
+    *ppIncludeSource = NULL;
+
+    DxcHasher hasher;
+    DxcHasher_Init(&hasher, 0);
+    DxcHasher_UpdateWide(&hasher, pFilename);
+    DxcHash key = DxcHasher_Final(&hasher);
+
+    pthread_rwlock_rdlock(&self->Lock);
+    DxcMemoIncludeEntry *entry = DxcMemoInclude_Find(self, &key, pFilename);
+    pthread_rwlock_unlock(&self->Lock);
+
+    if (entry) {
+        atomic_fetch_add(&self->Hits, 1);
+    }
+    else {
+        // Map outside the lock; a racing thread that inserted first wins
+        DxcMemoIncludeEntry *loaded = DxcMemoInclude_Load(&key, pFilename);
+        if (!loaded) {
+            return E_OUTOFMEMORY;
+        }
+
+        pthread_rwlock_wrlock(&self->Lock);
+        entry = DxcMemoInclude_Find(self, &key, pFilename);
+        if (!entry && DxcMemoInclude_Insert(self, loaded)) {
+            entry = loaded;
+            loaded = NULL;
+        }
+        pthread_rwlock_unlock(&self->Lock);
+
+        if (loaded) {
+            DxcMemoInclude_FreeEntry(loaded);
+            if (!entry) {
+                return E_OUTOFMEMORY;
+            }
+            atomic_fetch_add(&self->Hits, 1);
+        }
+        else {
+            atomic_fetch_add(&self->Misses, 1);
+            if (entry->pData) {
+                atomic_fetch_add(&self->Files, 1);
+                atomic_fetch_add(&self->MappedBytes, entry->Size);
+            }
+        }
+    }
+
+    if (!entry->pData) {
+        return E_FAIL;
+    }
+
+    return IDxcUtils_CreateBlobFromPinned(self->pUtils, entry->pData, (UINT32)entry->Size, self->Encoding,
+                                          (IDxcBlobEncoding**)ppIncludeSource);
+}
+
+static void *const DxcMemoIncludeHandler_Vtbl[] = {
+    (void*)DxcMemoIncludeHandler_QueryInterface,
+    (void*)DxcMemoIncludeHandler_AddRef,
+    (void*)DxcMemoIncludeHandler_Release,
+    (void*)DxcMemoIncludeHandler_LoadSource,
+};
+
+// --- Methods ----------------------------------------------------------------
+// Creates a handler that serves includes through pUtils. encoding is the code
+// page reported for every file; DXC_CP_ACP lets DXC detect it from the BOM.
+static inline HRESULT DxcMemoIncludeHandler_Create(IDxcUtils *pUtils, UINT32 encoding, IDxcIncludeHandler **ppHandler) {
+    if (!pUtils || !ppHandler) {
+        return E_INVALIDARG;
+    }
+
+    DxcMemoIncludeHandler *self = (DxcMemoIncludeHandler*)calloc(1, sizeof(DxcMemoIncludeHandler));
+    if (!self) {
+        *ppHandler = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    self->v = DxcMemoIncludeHandler_Vtbl;
+    atomic_init(&self->RefCount, 1);
+    self->pUtils = pUtils;
+    self->Encoding = encoding;
+    pthread_rwlock_init(&self->Lock, NULL);
+    IDxcUtils_AddRef(pUtils);
+
+    *ppHandler = (IDxcIncludeHandler*)self;
+    return S_OK;
+}
+
+// pHandler must have been created by DxcMemoIncludeHandler_Create
+static inline DxcMemoIncludeStats DxcMemoIncludeHandler_GetStats(IDxcIncludeHandler *pHandler) {
+    DxcMemoIncludeHandler *self = (DxcMemoIncludeHandler*)pHandler;
+    DxcMemoIncludeStats stats;
+    stats.Hits = atomic_load(&self->Hits);
+    stats.Misses = atomic_load(&self->Misses);
+    stats.Files = atomic_load(&self->Files);
+    stats.MappedBytes = atomic_load(&self->MappedBytes);
+    return stats;
+}
+
+#endif /* __DXC_INCLUDE_C__ */
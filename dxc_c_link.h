@@ -0,0 +1,423 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_link.h                                                              //
+// Compile-once lib_6_x libraries linked into entry points with IDxcLinker   //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_LINK_C__
+#define __DXC_LINK_C__
+
+#include "dxc_c.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// NOTE: Requires POSIX threads. A DxcLinkCache keeps every compiled library
+// blob for the lifetime of the cache, keyed by name and a source hash, and
+// registers it with one long-lived IDxcLinker the first time a link needs it.
+// Adding a library whose hash is unchanged is a no-op, so shared code is
+// compiled once per process no matter how many entry points link against it.
+//
+// IDxcLinker_RegisterLibrary rejects a name that is already registered, so each
+// library is registered under "<name>@<hash>". A changed library therefore gets
+// a fresh registration while the superseded one lingers inside the linker; once
+// more than MaxStaleRegistrations have piled up the linker is replaced and the
+// current libraries are registered again from the cached blobs.
+//
+// The default source hash covers the library source, target profile and
+// arguments only. Libraries that include headers should pass pSourceHash, for
+// example the hash of the preprocessed text or of the include dependencies.
+
+#ifndef DXC_LINK_DEFAULT_MAX_STALE
+    #define DXC_LINK_DEFAULT_MAX_STALE 64
+#endif
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcLinkCacheDesc {
+    DxcCreateInstanceProc pfnCreateInstance;
+    UINT32                MaxStaleRegistrations; // 0 selects DXC_LINK_DEFAULT_MAX_STALE
+} DxcLinkCacheDesc;
+
+typedef struct DxcLinkLibraryDesc {
+    LPCWSTR             pName;           // Name passed to DxcLinkCache_Link
+    DxcBuffer           Source;
+    LPCWSTR             pTargetProfile;  // Library profile, e.g. L"lib_6_6"
+    LPCWSTR            *pArguments;      // Additional arguments, without -T
+    UINT32              ArgCount;
+    IDxcIncludeHandler *pIncludeHandler; // NULL uses the cache's default include handler
+    const DxcHash      *pSourceHash;     // NULL hashes Source, pTargetProfile and pArguments
+} DxcLinkLibraryDesc;
+
+typedef struct DxcLinkCacheStats {
+    UINT64 Compiles;           // Libraries compiled because they were new or changed
+    UINT64 Reuses;             // Library adds satisfied by an up-to-date cached library
+    UINT64 Registrations;      // IDxcLinker_RegisterLibrary calls
+    UINT64 Links;
+    UINT64 LinkFailures;
+    UINT64 LinkerResets;       // Linkers replaced to drop stale registrations
+    UINT64 CompileNanoseconds;
+    UINT64 LinkNanoseconds;
+    UINT32 LibraryCount;
+} DxcLinkCacheStats;
+
+typedef struct DxcLinkLibrary {
+    WCHAR    *pName;
+    WCHAR    *pRegisteredName; // pName + L"@" + hex hash
+    DxcHash   Hash;
+    IDxcBlob *pLibrary;
+    BOOL      Registered;      // Registered with the current pLinker
+} DxcLinkLibrary;
+
+typedef struct DxcLinkCache {
+    DxcCreateInstanceProc pfnCreateInstance;
+    IDxcCompiler3        *pCompiler;
+    IDxcUtils            *pUtils;
+    IDxcIncludeHandler   *pDefaultIncludeHandler;
+    IDxcLinker           *pLinker;
+    DxcLinkLibrary       *pLibraries;
+    UINT32                LibraryCount;
+    UINT32                LibraryCapacity;
+    UINT32                StaleCount;
+    UINT32                MaxStale;
+    DxcLinkCacheStats     Stats;
+    pthread_mutex_t       CompileLock; // Serializes pCompiler
+    pthread_mutex_t       Lock;        // Guards the library table, pLinker and Stats
+} DxcLinkCache;
+
+// --- Internals --------------------------------------------------------------
+static inline WCHAR *DxcLink_CopyName(LPCWSTR pName, const DxcHash *pHash) {
+    SIZE_T length = wcslen(pName);
+    WCHAR *copy = (WCHAR*)malloc((length + (pHash ? 34 : 1)) * sizeof(WCHAR));
+    if (!copy) {
+        return NULL;
+    }
+
+    memcpy(copy, pName, length * sizeof(WCHAR));
+    if (pHash) {
+        char hex[33];
+        DxcHash_ToHex(pHash, hex);
+        copy[length++] = L'@';
+        for (UINT32 i = 0; i < 32; ++i) {
+            copy[length++] = (WCHAR)hex[i];
+        }
+    }
+    copy[length] = 0;
+
+    return copy;
+}
+
+// Must be called with cache->Lock held
+static inline DxcLinkLibrary *DxcLinkCache_FindLocked(DxcLinkCache *cache, LPCWSTR pName) {
+    for (UINT32 i = 0; i < cache->LibraryCount; ++i) {
+        if (wcscmp(cache->pLibraries[i].pName, pName) == 0) {
+            return &cache->pLibraries[i];
+        }
+    }
+    return NULL;
+}
+
+// Must be called with cache->Lock held. Drops every registration, including
+// stale ones, by replacing the linker; libraries are registered again lazily.
+static inline HRESULT DxcLinkCache_ResetLinkerLocked(DxcLinkCache *cache) {
+    IDxcLinker *linker = NULL;
+    HRESULT hr = cache->pfnCreateInstance(&CLSID_DxcLinker, &IID_IDxcLinker, (LPVOID*)&linker);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    if (cache->pLinker) {
+        IDxcLinker_Release(cache->pLinker);
+        cache->Stats.LinkerResets++;
+    }
+    cache->pLinker = linker;
+    cache->StaleCount = 0;
+    for (UINT32 i = 0; i < cache->LibraryCount; ++i) {
+        cache->pLibraries[i].Registered = 0;
+    }
+
+    return S_OK;
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline void DxcLinkCache_Destroy(DxcLinkCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    for (UINT32 i = 0; i < cache->LibraryCount; ++i) {
+        IDxcBlob_Release(cache->pLibraries[i].pLibrary);
+        free(cache->pLibraries[i].pName);
+        free(cache->pLibraries[i].pRegisteredName);
+    }
+    free(cache->pLibraries);
+
+    if (cache->pLinker) {
+        IDxcLinker_Release(cache->pLinker);
+    }
+    if (cache->pDefaultIncludeHandler) {
+        IDxcIncludeHandler_Release(cache->pDefaultIncludeHandler);
+    }
+    if (cache->pUtils) {
+        IDxcUtils_Release(cache->pUtils);
+    }
+    if (cache->pCompiler) {
+        IDxcCompiler3_Release(cache->pCompiler);
+    }
+
+    pthread_mutex_destroy(&cache->CompileLock);
+    pthread_mutex_destroy(&cache->Lock);
+    free(cache);
+}
+
+static inline HRESULT DxcLinkCache_Create(const DxcLinkCacheDesc *pDesc, DxcLinkCache **ppCache) {
+    if (!pDesc || !pDesc->pfnCreateInstance || !ppCache) {
+        return E_INVALIDARG;
+    }
+
+    *ppCache = NULL;
+
+    DxcLinkCache *cache = (DxcLinkCache*)calloc(1, sizeof(DxcLinkCache));
+    if (!cache) {
+        return E_OUTOFMEMORY;
+    }
+
+    pthread_mutex_init(&cache->CompileLock, NULL);
+    pthread_mutex_init(&cache->Lock, NULL);
+    cache->pfnCreateInstance = pDesc->pfnCreateInstance;
+    cache->MaxStale = pDesc->MaxStaleRegistrations ? pDesc->MaxStaleRegistrations : DXC_LINK_DEFAULT_MAX_STALE;
+
+    HRESULT hr = cache->pfnCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, (LPVOID*)&cache->pCompiler);
+    if (SUCCEEDED(hr)) { hr = cache->pfnCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, (LPVOID*)&cache->pUtils); }
+    if (SUCCEEDED(hr)) { hr = IDxcUtils_CreateDefaultIncludeHandler(cache->pUtils, &cache->pDefaultIncludeHandler); }
+    if (SUCCEEDED(hr)) { hr = DxcLinkCache_ResetLinkerLocked(cache); }
+
+    if (FAILED(hr)) {
+        DxcLinkCache_Destroy(cache);
+        return hr;
+    }
+
+    *ppCache = cache;
+    return S_OK;
+}
+
+static inline DxcHash DxcLinkCache_HashLibrary(const DxcLinkLibraryDesc *pDesc) {
+    DxcHasher hasher;
+    DxcHasher_Init(&hasher, 0);
+    DxcHasher_UpdateField(&hasher, pDesc->Source.Ptr, pDesc->Source.Size);
+    DxcHasher_UpdateWide(&hasher, pDesc->pTargetProfile);
+    for (UINT32 i = 0; i < pDesc->ArgCount; ++i) {
+        DxcHasher_UpdateWide(&hasher, pDesc->pArguments[i]);
+    }
+    return DxcHasher_Final(&hasher);
+}
+
+// Returns TRUE when pName is cached with exactly this hash
+static inline BOOL DxcLinkCache_IsCurrent(DxcLinkCache *cache, LPCWSTR pName, const DxcHash *pHash) {
+    pthread_mutex_lock(&cache->Lock);
+    DxcLinkLibrary *library = DxcLinkCache_FindLocked(cache, pName);
+    BOOL current = library && DxcHash_Equal(&library->Hash, pHash);
+    pthread_mutex_unlock(&cache->Lock);
+
+    return current;
+}
+
+// Adds an already compiled library blob, for example one produced by a
+// DxcBatch or loaded from a DxcCache. Returns S_FALSE and keeps the existing
+// blob when pName is already cached with the same hash; otherwise the cache
+// takes its own reference to pLibrary and any previous version is superseded.
+static inline HRESULT DxcLinkCache_AddLibraryBlob(DxcLinkCache *cache, LPCWSTR pName, const DxcHash *pHash, IDxcBlob *pLibrary) {
+    if (!cache || !pName || !pHash || !pLibrary) {
+        return E_INVALIDARG;
+    }
+
+    HRESULT hr = S_OK;
+    pthread_mutex_lock(&cache->Lock);
+
+    DxcLinkLibrary *library = DxcLinkCache_FindLocked(cache, pName);
+    if (library && DxcHash_Equal(&library->Hash, pHash)) {
+        hr = S_FALSE;
+    } else {
+        WCHAR *registeredName = DxcLink_CopyName(pName, pHash);
+        WCHAR *name = library ? NULL : DxcLink_CopyName(pName, NULL);
+
+        if (!library && cache->LibraryCount == cache->LibraryCapacity) {
+            UINT32 capacity = cache->LibraryCapacity ? cache->LibraryCapacity * 2 : 16;
+            DxcLinkLibrary *libraries = (DxcLinkLibrary*)realloc(cache->pLibraries, capacity * sizeof(DxcLinkLibrary));
+            if (libraries) {
+                cache->pLibraries = libraries;
+                cache->LibraryCapacity = capacity;
+            }
+        }
+
+        if (!registeredName || (!library && (!name || cache->LibraryCount == cache->LibraryCapacity))) {
+            free(registeredName);
+            free(name);
+            hr = E_OUTOFMEMORY;
+        } else {
+            if (library) {
+                if (library->Registered) {
+                    cache->StaleCount++;
+                }
+                IDxcBlob_Release(library->pLibrary);
+                free(library->pRegisteredName);
+            } else {
+                library = &cache->pLibraries[cache->LibraryCount++];
+                library->pName = name;
+            }
+
+            IDxcBlob_AddRef(pLibrary);
+            library->pRegisteredName = registeredName;
+            library->Hash = *pHash;
+            library->pLibrary = pLibrary;
+            library->Registered = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&cache->Lock);
+    return hr;
+}
+
+// Compiles pDesc->Source as a library unless it is already cached with the
+// same hash, in which case S_FALSE is returned without touching the compiler.
+// A failed compile returns its status and leaves any cached version in place.
+// ppResult is optional and receives the compile result, or NULL when reused.
+static inline HRESULT DxcLinkCache_AddLibrary(DxcLinkCache *cache, const DxcLinkLibraryDesc *pDesc, IDxcResult **ppResult) {
+    if (ppResult) {
+        *ppResult = NULL;
+    }
+    if (!cache || !pDesc || !pDesc->pName || !pDesc->pTargetProfile) {
+        return E_INVALIDARG;
+    }
+
+    DxcHash hash = pDesc->pSourceHash ? *pDesc->pSourceHash : DxcLinkCache_HashLibrary(pDesc);
+    if (DxcLinkCache_IsCurrent(cache, pDesc->pName, &hash)) {
+        pthread_mutex_lock(&cache->Lock);
+        cache->Stats.Reuses++;
+        pthread_mutex_unlock(&cache->Lock);
+        return S_FALSE;
+    }
+
+    LPCWSTR *arguments = (LPCWSTR*)malloc((pDesc->ArgCount + 2) * sizeof(LPCWSTR));
+    if (!arguments) {
+        return E_OUTOFMEMORY;
+    }
+    arguments[0] = L"-T";
+    arguments[1] = pDesc->pTargetProfile;
+    if (pDesc->ArgCount) {
+        memcpy(arguments + 2, pDesc->pArguments, pDesc->ArgCount * sizeof(LPCWSTR));
+    }
+
+    IDxcIncludeHandler *includeHandler = pDesc->pIncludeHandler ? pDesc->pIncludeHandler : cache->pDefaultIncludeHandler;
+    IDxcResult *result = NULL;
+    IDxcBlob *library = NULL;
+    HRESULT status = E_FAIL;
+
+    pthread_mutex_lock(&cache->CompileLock);
+    UINT64 start = DxcUtil_Now();
+    HRESULT hr = IDxcCompiler3_Compile(cache->pCompiler, &pDesc->Source, arguments, pDesc->ArgCount + 2, includeHandler,
+                                       &IID_IDxcResult, (LPVOID*)&result);
+    UINT64 elapsed = DxcUtil_Now() - start;
+    pthread_mutex_unlock(&cache->CompileLock);
+    free(arguments);
+
+    if (SUCCEEDED(hr)) { hr = IDxcResult_GetStatus(result, &status); }
+    if (SUCCEEDED(hr)) { hr = status; }
+    if (SUCCEEDED(hr)) { hr = IDxcResult_GetResult(result, &library); }
+    if (SUCCEEDED(hr) && !library) { hr = E_FAIL; }
+    if (SUCCEEDED(hr)) { hr = DxcLinkCache_AddLibraryBlob(cache, pDesc->pName, &hash, library); }
+
+    pthread_mutex_lock(&cache->Lock);
+    cache->Stats.Compiles++;
+    cache->Stats.CompileNanoseconds += elapsed;
+    pthread_mutex_unlock(&cache->Lock);
+
+    if (library) {
+        IDxcBlob_Release(library);
+    }
+    if (ppResult) {
+        *ppResult = result;
+    } else if (result) {
+        IDxcResult_Release(result);
+    }
+
+    return FAILED(hr) ? hr : S_OK;
+}
+
+// Links pEntryName from cached libraries, registering any library that the
+// current linker has not seen yet. Fails with E_INVALIDARG if a name is not
+// cached. Links are serialized because IDxcLinker is not thread-safe.
+static inline HRESULT DxcLinkCache_Link(DxcLinkCache *cache, LPCWSTR pEntryName, LPCWSTR pTargetProfile, const LPCWSTR *pLibNames,
+                                        UINT32 libCount, const LPCWSTR *pArguments, UINT32 argCount, IDxcOperationResult **ppResult) {
+    if (!cache || !pEntryName || !pTargetProfile || (!pLibNames && libCount) || !ppResult) {
+        return E_INVALIDARG;
+    }
+
+    *ppResult = NULL;
+
+    LPCWSTR *registeredNames = (LPCWSTR*)malloc((libCount ? libCount : 1) * sizeof(LPCWSTR));
+    if (!registeredNames) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = S_OK;
+    pthread_mutex_lock(&cache->Lock);
+
+    if (cache->StaleCount > cache->MaxStale) {
+        hr = DxcLinkCache_ResetLinkerLocked(cache);
+    }
+
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < libCount; ++i) {
+        DxcLinkLibrary *library = DxcLinkCache_FindLocked(cache, pLibNames[i]);
+        if (!library) {
+            hr = E_INVALIDARG;
+            break;
+        }
+        if (!library->Registered) {
+            hr = IDxcLinker_RegisterLibrary(cache->pLinker, library->pRegisteredName, library->pLibrary);
+            if (SUCCEEDED(hr)) {
+                library->Registered = 1;
+                cache->Stats.Registrations++;
+            }
+        }
+        registeredNames[i] = library->pRegisteredName;
+    }
+
+    if (SUCCEEDED(hr)) {
+        UINT64 start = DxcUtil_Now();
+        hr = IDxcLinker_Link(cache->pLinker, pEntryName, pTargetProfile, registeredNames, libCount, pArguments, argCount, ppResult);
+        cache->Stats.LinkNanoseconds += DxcUtil_Now() - start;
+
+        HRESULT status = E_FAIL;
+        if (SUCCEEDED(hr) && *ppResult) {
+            IDxcOperationResult_GetStatus(*ppResult, &status);
+        }
+        cache->Stats.Links++;
+        cache->Stats.LinkFailures += FAILED(status);
+    }
+
+    pthread_mutex_unlock(&cache->Lock);
+    free(registeredNames);
+
+    return hr;
+}
+
+static inline DxcLinkCacheStats DxcLinkCache_GetStats(DxcLinkCache *cache) {
+    pthread_mutex_lock(&cache->Lock);
+    DxcLinkCacheStats stats = cache->Stats;
+    stats.LibraryCount = cache->LibraryCount;
+    pthread_mutex_unlock(&cache->Lock);
+
+    return stats;
+}
+
+#endif /* __DXC_LINK_C__ */
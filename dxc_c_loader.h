@@ -0,0 +1,283 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_loader.h                                                            //
+// Dynamic loader for libdxcompiler.so with pooled instances                 //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_LOADER_C__
+#define __DXC_LOADER_C__
+
+#include "dxc_c.h"
+#include "dxc_c_util.h"
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// NOTE: Requires POSIX (dlopen, POSIX threads). DxcLoader_Open loads DXC once
+// and resolves DxcCreateInstance and DxcCreateInstance2 into the proc typedefs
+// from dxc_c.h. The loader keeps a LIFO pool per interface kind; acquiring
+// takes a ready instance when one is pooled and creates one otherwise, and
+// returning puts it back unless the pool is full. Every pooled instance must be
+// returned or released before DxcLoader_Close, which unloads the library.
+
+#ifndef DXC_LOADER_DEFAULT_LIBRARY
+    #define DXC_LOADER_DEFAULT_LIBRARY "libdxcompiler.so"
+#endif
+
+typedef enum DxcLoaderKind {
+    DXC_LOADER_COMPILER3 = 0,
+    DXC_LOADER_UTILS     = 1,
+    DXC_LOADER_VALIDATOR = 2,
+    DXC_LOADER_KIND_COUNT
+} DxcLoaderKind;
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcLoaderDesc {
+    const char *pLibraryPath;          // NULL loads DXC_LOADER_DEFAULT_LIBRARY
+    const char *pValidatorLibraryPath; // Optional, e.g. "libdxil.so"; NULL uses the compiler library
+    UINT32      MaxPooled;             // Per kind; 0 selects 64
+} DxcLoaderDesc;
+
+typedef struct DxcLoaderStats {
+    UINT64 Hits;                  // Acquires served from the pool
+    UINT64 Misses;                // Acquires that created an instance
+    UINT64 Returns;               // Instances put back into the pool
+    UINT64 Discards;              // Instances released because the pool was full
+    UINT64 CreateFailures;
+    UINT64 TotalCreateNanoseconds;
+    UINT64 MaxCreateNanoseconds;
+    UINT32 Pooled;                // Instances currently in the pool
+} DxcLoaderStats;
+
+typedef struct DxcLoaderPool {
+    pthread_mutex_t Lock;
+    void          **ppItems;
+    UINT32          Count;
+    DxcLoaderStats  Stats;
+} DxcLoaderPool;
+
+typedef struct DxcLoader {
+    void                  *pLibrary;
+    void                  *pValidatorLibrary;
+    DxcCreateInstanceProc  DxcCreateInstance;
+    DxcCreateInstance2Proc DxcCreateInstance2; // NULL if the library does not export it
+    DxcCreateInstanceProc  ValidatorCreateInstance;
+    UINT32                 MaxPooled;
+    DxcLoaderPool          Pools[DXC_LOADER_KIND_COUNT];
+} DxcLoader;
+
+// --- Internals --------------------------------------------------------------
+// Every pooled interface derives from IUnknown, so Release is slot 2 in all of them
+static inline void DxcLoader_ReleaseInstance(void *pInstance) {
+    IDxcBlob *unknown = (IDxcBlob*)pInstance;
+    COM_CALL(unknown, 2, ULONG(__stdcall*)(IDxcBlob*), unknown);
+}
+
+static inline HRESULT DxcLoader_CreateInstance(DxcLoader *loader, DxcLoaderKind kind, void **ppInstance) {
+    switch (kind) {
+        case DXC_LOADER_COMPILER3: return loader->DxcCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, ppInstance);
+        case DXC_LOADER_UTILS:     return loader->DxcCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, ppInstance);
+        case DXC_LOADER_VALIDATOR: return loader->ValidatorCreateInstance(&CLSID_DxcValidator, &IID_IDxcValidator, ppInstance);
+        default:                   return E_INVALIDARG;
+    }
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline void DxcLoader_Close(DxcLoader *loader) {
+    if (!loader) {
+        return;
+    }
+
+    for (UINT32 kind = 0; kind < DXC_LOADER_KIND_COUNT; ++kind) {
+        DxcLoaderPool *pool = &loader->Pools[kind];
+        for (UINT32 i = 0; i < pool->Count; ++i) {
+            DxcLoader_ReleaseInstance(pool->ppItems[i]);
+        }
+        free(pool->ppItems);
+        pthread_mutex_destroy(&pool->Lock);
+    }
+
+    if (loader->pValidatorLibrary) {
+        dlclose(loader->pValidatorLibrary);
+    }
+    if (loader->pLibrary) {
+        dlclose(loader->pLibrary);
+    }
+    free(loader);
+}
+
+static inline HRESULT DxcLoader_Open(const DxcLoaderDesc *pDesc, DxcLoader **ppLoader) {
+    if (!ppLoader) {
+        return E_INVALIDARG;
+    }
+
+    *ppLoader = NULL;
+
+    DxcLoader *loader = (DxcLoader*)calloc(1, sizeof(DxcLoader));
+    if (!loader) {
+        return E_OUTOFMEMORY;
+    }
+
+    loader->MaxPooled = pDesc && pDesc->MaxPooled ? pDesc->MaxPooled : 64;
+    for (UINT32 kind = 0; kind < DXC_LOADER_KIND_COUNT; ++kind) {
+        pthread_mutex_init(&loader->Pools[kind].Lock, NULL);
+    }
+    for (UINT32 kind = 0; kind < DXC_LOADER_KIND_COUNT; ++kind) {
+        loader->Pools[kind].ppItems = (void**)malloc(loader->MaxPooled * sizeof(void*));
+        if (!loader->Pools[kind].ppItems) {
+            DxcLoader_Close(loader);
+            return E_OUTOFMEMORY;
+        }
+    }
+
+    const char *path = pDesc && pDesc->pLibraryPath ? pDesc->pLibraryPath : DXC_LOADER_DEFAULT_LIBRARY;
+    loader->pLibrary = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (loader->pLibrary) {
+        loader->DxcCreateInstance = (DxcCreateInstanceProc)dlsym(loader->pLibrary, "DxcCreateInstance");
+        loader->DxcCreateInstance2 = (DxcCreateInstance2Proc)dlsym(loader->pLibrary, "DxcCreateInstance2");
+    }
+    loader->ValidatorCreateInstance = loader->DxcCreateInstance;
+
+    if (loader->DxcCreateInstance && pDesc && pDesc->pValidatorLibraryPath) {
+        loader->pValidatorLibrary = dlopen(pDesc->pValidatorLibraryPath, RTLD_NOW | RTLD_LOCAL);
+        loader->ValidatorCreateInstance = loader->pValidatorLibrary ?
+            (DxcCreateInstanceProc)dlsym(loader->pValidatorLibrary, "DxcCreateInstance") : NULL;
+    }
+
+    if (!loader->DxcCreateInstance || !loader->ValidatorCreateInstance) {
+        DxcLoader_Close(loader);
+        return E_FAIL;
+    }
+
+    *ppLoader = loader;
+    return S_OK;
+}
+
+// Takes a pooled instance of the given kind or creates a new one. The caller
+// owns one reference and hands it back with DxcLoader_Return or releases it.
+static inline HRESULT DxcLoader_Acquire(DxcLoader *loader, DxcLoaderKind kind, void **ppInstance) {
+    if (!loader || kind >= DXC_LOADER_KIND_COUNT || !ppInstance) {
+        return E_INVALIDARG;
+    }
+
+    DxcLoaderPool *pool = &loader->Pools[kind];
+    pthread_mutex_lock(&pool->Lock);
+    if (pool->Count) {
+        *ppInstance = pool->ppItems[--pool->Count];
+        pool->Stats.Hits++;
+        pthread_mutex_unlock(&pool->Lock);
+        return S_OK;
+    }
+    pool->Stats.Misses++;
+    pthread_mutex_unlock(&pool->Lock);
+
+    UINT64 start = DxcUtil_Now();
+    void *instance = NULL;
+    HRESULT hr = DxcLoader_CreateInstance(loader, kind, &instance);
+    UINT64 elapsed = DxcUtil_Now() - start;
+
+    pthread_mutex_lock(&pool->Lock);
+    if (SUCCEEDED(hr)) {
+        pool->Stats.TotalCreateNanoseconds += elapsed;
+        if (elapsed > pool->Stats.MaxCreateNanoseconds) {
+            pool->Stats.MaxCreateNanoseconds = elapsed;
+        }
+    }
+    else {
+        pool->Stats.CreateFailures++;
+    }
+    pthread_mutex_unlock(&pool->Lock);
+
+    *ppInstance = SUCCEEDED(hr) ? instance : NULL;
+    return hr;
+}
+
+// Puts an instance obtained from DxcLoader_Acquire back into its pool
+static inline void DxcLoader_Return(DxcLoader *loader, DxcLoaderKind kind, void *pInstance) {
+    if (!pInstance) {
+        return;
+    }
+
+    DxcLoaderPool *pool = &loader->Pools[kind];
+    pthread_mutex_lock(&pool->Lock);
+    if (pool->Count < loader->MaxPooled) {
+        pool->ppItems[pool->Count++] = pInstance;
+        pool->Stats.Returns++;
+        pInstance = NULL;
+    }
+    else {
+        pool->Stats.Discards++;
+    }
+    pthread_mutex_unlock(&pool->Lock);
+
+    if (pInstance) {
+        DxcLoader_ReleaseInstance(pInstance);
+    }
+}
+
+// Creates instances until the pool holds at least count of them
+static inline HRESULT DxcLoader_Prewarm(DxcLoader *loader, DxcLoaderKind kind, UINT32 count) {
+    if (!loader || kind >= DXC_LOADER_KIND_COUNT) {
+        return E_INVALIDARG;
+    }
+
+    DxcLoaderPool *pool = &loader->Pools[kind];
+    count = count < loader->MaxPooled ? count : loader->MaxPooled;
+    for (;;) {
+        pthread_mutex_lock(&pool->Lock);
+        BOOL full = pool->Count >= count;
+        pthread_mutex_unlock(&pool->Lock);
+        if (full) {
+            return S_OK;
+        }
+
+        UINT64 start = DxcUtil_Now();
+        void *instance = NULL;
+        HRESULT hr = DxcLoader_CreateInstance(loader, kind, &instance);
+        UINT64 elapsed = DxcUtil_Now() - start;
+        if (FAILED(hr)) {
+            return hr;
+        }
+
+        pthread_mutex_lock(&pool->Lock);
+        pool->Stats.TotalCreateNanoseconds += elapsed;
+        if (elapsed > pool->Stats.MaxCreateNanoseconds) {
+            pool->Stats.MaxCreateNanoseconds = elapsed;
+        }
+        if (pool->Count < loader->MaxPooled) {
+            pool->ppItems[pool->Count++] = instance;
+            instance = NULL;
+        }
+        pthread_mutex_unlock(&pool->Lock);
+
+        if (instance) {
+            DxcLoader_ReleaseInstance(instance);
+        }
+    }
+}
+
+static inline DxcLoaderStats DxcLoader_GetStats(DxcLoader *loader, DxcLoaderKind kind) {
+    DxcLoaderPool *pool = &loader->Pools[kind];
+    pthread_mutex_lock(&pool->Lock);
+    DxcLoaderStats stats = pool->Stats;
+    stats.Pooled = pool->Count;
+    pthread_mutex_unlock(&pool->Lock);
+    return stats;
+}
+
+static inline HRESULT DxcLoader_AcquireCompiler3(DxcLoader *loader, IDxcCompiler3 **ppCompiler) { return DxcLoader_Acquire(loader, DXC_LOADER_COMPILER3, (void**)ppCompiler); }
+static inline HRESULT DxcLoader_AcquireUtils(DxcLoader *loader, IDxcUtils **ppUtils) { return DxcLoader_Acquire(loader, DXC_LOADER_UTILS, (void**)ppUtils); }
+static inline HRESULT DxcLoader_AcquireValidator(DxcLoader *loader, IDxcValidator **ppValidator) { return DxcLoader_Acquire(loader, DXC_LOADER_VALIDATOR, (void**)ppValidator); }
+static inline void DxcLoader_ReturnCompiler3(DxcLoader *loader, IDxcCompiler3 *pCompiler) { DxcLoader_Return(loader, DXC_LOADER_COMPILER3, pCompiler); }
+static inline void DxcLoader_ReturnUtils(DxcLoader *loader, IDxcUtils *pUtils) { DxcLoader_Return(loader, DXC_LOADER_UTILS, pUtils); }
+static inline void DxcLoader_ReturnValidator(DxcLoader *loader, IDxcValidator *pValidator) { DxcLoader_Return(loader, DXC_LOADER_VALIDATOR, pValidator); }
+
+#endif /* __DXC_LOADER_C__ */
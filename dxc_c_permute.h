@@ -0,0 +1,305 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_permute.h                                                           //
+// Shader permutation expansion with preprocess-level deduplication          //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_PERMUTE_C__
+#define __DXC_PERMUTE_C__
+
+#include "dxc_c.h"
+#include "dxc_c_batch.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// NOTE: Requires POSIX threads (through dxc_c_batch.h). A permutation matrix
+// is a list of axes; each axis offers a few options, and each option is a set
+// of DxcDefines (an empty set is the usual "off" keyword). Every variant of the
+// cross product goes through the cheap IDxcCompiler_Preprocess stage and its
+// preprocessed text is hashed. Defines only act through the preprocessor, so
+// variants with equal text compile to equal code: only the first variant of
+// each text is compiled, on a DxcBatch, and the others alias its IDxcResult.
+// Variants that fail to preprocess are compiled individually, so callers still
+// get a full result with diagnostics.
+//
+// Variant indices are mixed-radix over the axes, the first axis varying
+// fastest. The include handler is used by the batch workers concurrently and
+// must be thread-safe (dxc_c_include.h provides one); NULL uses DXC's default.
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcPermuteOption {
+    const DxcDefine *pDefines;
+    UINT32           DefineCount;
+} DxcPermuteOption;
+
+typedef struct DxcPermuteAxis {
+    const DxcPermuteOption *pOptions;
+    UINT32                  OptionCount;
+} DxcPermuteAxis;
+
+typedef struct DxcPermuteDesc {
+    IDxcCompiler         *pPreprocessor;
+    DxcBatch             *pBatch;
+    IDxcBlob             *pSource;
+    LPCWSTR               pSourceName;
+    LPCWSTR              *pArguments; // Shared by every variant, e.g. -E, -T, -O3
+    UINT32                ArgCount;
+    IDxcIncludeHandler   *pIncludeHandler;
+    const DxcPermuteAxis *pAxes;
+    UINT32                AxisCount;
+} DxcPermuteDesc;
+
+typedef struct DxcPermuteResult {
+    HRESULT     Status;      // Return value of IDxcCompiler3_Compile for the compiled variant
+    UINT32      UniqueIndex; // Variants with equal indices share the same compile
+    DxcHash     TextHash;    // Hash of the preprocessed text, zero if preprocessing failed
+    IDxcResult *pResult;     // One reference per variant, release with IDxcResult_Release
+} DxcPermuteResult;
+
+typedef struct DxcPermuteStats {
+    UINT32 VariantCount;
+    UINT32 UniqueTextCount;
+    UINT32 PreprocessFailures;
+    UINT32 CompileCount;
+    UINT32 CompilesAvoided; // VariantCount - CompileCount
+    UINT64 PreprocessNanoseconds;
+    UINT64 CompileNanoseconds;
+} DxcPermuteStats;
+
+typedef struct DxcPermuteText {
+    DxcHash TextHash;
+    UINT32  UniqueIndex;
+} DxcPermuteText;
+
+// --- Internals --------------------------------------------------------------
+static inline HRESULT DxcPermute_HashText(IDxcCompiler *pCompiler, const DxcPermuteDesc *pDesc, const DxcDefine *pDefines,
+                                          UINT32 defineCount, DxcHash *pHash) {
+    IDxcOperationResult *result = NULL;
+    IDxcBlob *text = NULL;
+    HRESULT status = E_FAIL;
+    HRESULT hr = IDxcCompiler_Preprocess(pCompiler, pDesc->pSource, pDesc->pSourceName, pDesc->pArguments, pDesc->ArgCount,
+                                         pDefines, defineCount, pDesc->pIncludeHandler, &result);
+
+    if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetStatus(result, &status); }
+    if (SUCCEEDED(hr)) { hr = status; }
+    if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetResult(result, &text); }
+    if (SUCCEEDED(hr) && !text) { hr = E_FAIL; }
+
+    if (SUCCEEDED(hr)) {
+        *pHash = DxcHash_Compute(IDxcBlob_GetBufferPointer(text), IDxcBlob_GetBufferSize(text), 0);
+    }
+
+    if (text)   { IDxcBlob_Release(text); }
+    if (result) { IDxcOperationResult_Release(result); }
+    return hr;
+}
+
+// --- Methods ----------------------------------------------------------------
+// Returns the number of variants, or 0 if an axis has no options or the
+// product does not fit in 32 bits
+static inline UINT32 DxcPermute_GetVariantCount(const DxcPermuteAxis *pAxes, UINT32 axisCount) {
+    UINT64 count = 1;
+    for (UINT32 i = 0; i < axisCount; ++i) {
+        count *= pAxes[i].OptionCount;
+        if (count == 0 || count > 0xFFFFFFFFull) {
+            return 0;
+        }
+    }
+    return (UINT32)count;
+}
+
+// Writes the defines of one variant into pDefines. Returns the number of
+// defines, or a larger number than capacity if they do not fit.
+static inline UINT32 DxcPermute_GetVariantDefines(const DxcPermuteAxis *pAxes, UINT32 axisCount, UINT32 variant,
+                                                  DxcDefine *pDefines, UINT32 capacity) {
+    UINT32 count = 0;
+    for (UINT32 i = 0; i < axisCount; ++i) {
+        const DxcPermuteOption *option = &pAxes[i].pOptions[variant % pAxes[i].OptionCount];
+        variant /= pAxes[i].OptionCount;
+        for (UINT32 j = 0; j < option->DefineCount; ++j, ++count) {
+            if (count < capacity) {
+                pDefines[count] = option->pDefines[j];
+            }
+        }
+    }
+    return count;
+}
+
+// Expands the matrix, deduplicates by preprocessed text and compiles each
+// unique variant once. pResults receives one entry per variant.
+static inline HRESULT DxcPermute_Run(const DxcPermuteDesc *pDesc, DxcPermuteResult *pResults, DxcPermuteStats *pStats) {
+    if (!pDesc || !pDesc->pPreprocessor || !pDesc->pBatch || !pDesc->pSource || !pResults) {
+        return E_INVALIDARG;
+    }
+
+    DxcPermuteStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.VariantCount = DxcPermute_GetVariantCount(pDesc->pAxes, pDesc->AxisCount);
+    if (!stats.VariantCount) {
+        return E_INVALIDARG;
+    }
+
+    UINT32 maxDefines = 0;
+    for (UINT32 i = 0; i < pDesc->AxisCount; ++i) {
+        UINT32 axisMax = 0;
+        for (UINT32 j = 0; j < pDesc->pAxes[i].OptionCount; ++j) {
+            axisMax = pDesc->pAxes[i].pOptions[j].DefineCount > axisMax ? pDesc->pAxes[i].pOptions[j].DefineCount : axisMax;
+        }
+        maxDefines += axisMax;
+    }
+
+    DxcHashTable texts; // DxcPermuteText of each distinct preprocessed text
+    DxcHashTable_Init(&texts, sizeof(DxcPermuteText));
+    DxcDefine *defines = (DxcDefine*)malloc((maxDefines + 1) * sizeof(DxcDefine));
+    UINT32 *compiled = (UINT32*)malloc(stats.VariantCount * sizeof(UINT32)); // Variant indices sent to the compiler
+    if (!defines || !compiled) {
+        free(compiled);
+        free(defines);
+        return E_OUTOFMEMORY;
+    }
+
+    // Preprocess every variant and assign unique indices
+    UINT64 start = DxcUtil_Now();
+    for (UINT32 variant = 0; variant < stats.VariantCount; ++variant) {
+        DxcPermuteResult *result = &pResults[variant];
+        UINT32 defineCount = DxcPermute_GetVariantDefines(pDesc->pAxes, pDesc->AxisCount, variant, defines, maxDefines);
+        memset(result, 0, sizeof(DxcPermuteResult));
+
+        if (FAILED(DxcPermute_HashText(pDesc->pPreprocessor, pDesc, defines, defineCount, &result->TextHash))) {
+            memset(&result->TextHash, 0, sizeof(DxcHash));
+            stats.PreprocessFailures++;
+            result->UniqueIndex = stats.CompileCount;
+            compiled[stats.CompileCount++] = variant;
+            continue;
+        }
+
+        DxcPermuteText text;
+        text.TextHash = result->TextHash;
+        text.UniqueIndex = stats.CompileCount;
+        DxcPermuteText *known = NULL;
+        HRESULT inserted = DxcHashTable_Insert(&texts, &text, (void**)&known);
+        if (inserted == S_FALSE) {
+            result->UniqueIndex = known->UniqueIndex;
+            continue;
+        }
+        if (FAILED(inserted)) {
+            DxcHashTable_Destroy(&texts);
+            free(compiled);
+            free(defines);
+            return inserted;
+        }
+
+        stats.UniqueTextCount++;
+        result->UniqueIndex = stats.CompileCount;
+        compiled[stats.CompileCount++] = variant;
+    }
+    stats.PreprocessNanoseconds = DxcUtil_Now() - start;
+    DxcHashTable_Destroy(&texts);
+
+    // Each job gets the source name, the shared arguments and one -D Name=Value pair per define
+    SIZE_T pointerCount = 0;
+    SIZE_T charCount = 0;
+    for (UINT32 i = 0; i < stats.CompileCount; ++i) {
+        UINT32 defineCount = DxcPermute_GetVariantDefines(pDesc->pAxes, pDesc->AxisCount, compiled[i], defines, maxDefines);
+        pointerCount += 1 + pDesc->ArgCount + 2 * defineCount;
+        for (UINT32 j = 0; j < defineCount; ++j) {
+            charCount += wcslen(defines[j].Name) + (defines[j].Value ? 1 + wcslen(defines[j].Value) : 0) + 1;
+        }
+    }
+
+    DxcBatchJob *jobs = (DxcBatchJob*)malloc(stats.CompileCount * sizeof(DxcBatchJob));
+    DxcBatchResult *batchResults = (DxcBatchResult*)malloc(stats.CompileCount * sizeof(DxcBatchResult));
+    LPCWSTR *pointers = (LPCWSTR*)malloc(pointerCount * sizeof(LPCWSTR));
+    wchar_t *chars = (wchar_t*)malloc((charCount + 1) * sizeof(wchar_t));
+    HRESULT hr = jobs && batchResults && pointers && chars ? S_OK : E_OUTOFMEMORY;
+
+    if (SUCCEEDED(hr)) {
+        // Keep the source code page so the compile sees the same text the preprocessor did
+        IDxcBlobEncoding *encoding = NULL;
+        BOOL known = 0;
+        UINT32 codePage = DXC_CP_ACP;
+        if (SUCCEEDED(IDxcBlob_QueryInterface(pDesc->pSource, &IID_IDxcBlobEncoding, (void**)&encoding)) && encoding) {
+            IDxcBlobEncoding_GetEncoding(encoding, &known, &codePage);
+            IDxcBlobEncoding_Release(encoding);
+        }
+
+        LPCWSTR *nextPointer = pointers;
+        wchar_t *nextChar = chars;
+        for (UINT32 i = 0; i < stats.CompileCount; ++i) {
+            UINT32 defineCount = DxcPermute_GetVariantDefines(pDesc->pAxes, pDesc->AxisCount, compiled[i], defines, maxDefines);
+            DxcBatchJob *job = &jobs[i];
+            job->Source.Ptr = IDxcBlob_GetBufferPointer(pDesc->pSource);
+            job->Source.Size = IDxcBlob_GetBufferSize(pDesc->pSource);
+            job->Source.Encoding = known ? codePage : DXC_CP_ACP;
+            job->pArguments = nextPointer;
+            job->pIncludeHandler = pDesc->pIncludeHandler;
+
+            if (pDesc->pSourceName) {
+                *nextPointer++ = pDesc->pSourceName;
+            }
+            for (UINT32 j = 0; j < pDesc->ArgCount; ++j) {
+                *nextPointer++ = pDesc->pArguments[j];
+            }
+            for (UINT32 j = 0; j < defineCount; ++j) {
+                SIZE_T nameLength = wcslen(defines[j].Name);
+                *nextPointer++ = L"-D";
+                *nextPointer++ = nextChar;
+                wmemcpy(nextChar, defines[j].Name, nameLength);
+                nextChar += nameLength;
+                if (defines[j].Value) {
+                    SIZE_T valueLength = wcslen(defines[j].Value);
+                    *nextChar++ = L'=';
+                    wmemcpy(nextChar, defines[j].Value, valueLength);
+                    nextChar += valueLength;
+                }
+                *nextChar++ = L'\0';
+            }
+            job->ArgCount = (UINT32)(nextPointer - job->pArguments);
+        }
+
+        start = DxcUtil_Now();
+        hr = DxcBatch_Compile(pDesc->pBatch, jobs, stats.CompileCount, batchResults);
+        stats.CompileNanoseconds = DxcUtil_Now() - start;
+    }
+
+    if (SUCCEEDED(hr)) {
+        for (UINT32 variant = 0; variant < stats.VariantCount; ++variant) {
+            const DxcBatchResult *batchResult = &batchResults[pResults[variant].UniqueIndex];
+            pResults[variant].Status = batchResult->Status;
+            pResults[variant].pResult = batchResult->pResult;
+            if (batchResult->pResult) {
+                IDxcResult_AddRef(batchResult->pResult);
+            }
+        }
+        for (UINT32 i = 0; i < stats.CompileCount; ++i) {
+            if (batchResults[i].pResult) {
+                IDxcResult_Release(batchResults[i].pResult);
+            }
+        }
+    }
+
+    stats.CompilesAvoided = stats.VariantCount - stats.CompileCount;
+    if (pStats) {
+        *pStats = stats;
+    }
+
+    free(chars);
+    free(pointers);
+    free(batchResults);
+    free(jobs);
+    free(compiled);
+    free(defines);
+    return hr;
+}
+
+#endif /* __DXC_PERMUTE_C__ */
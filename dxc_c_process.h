@@ -0,0 +1,1299 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_process.h                                                           //
+// Out-of-process batch compilation on forked workers over shared memory     //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_PROCESS_C__
+#define __DXC_PROCESS_C__
+
+#include "dxc_c.h"
+#include "dxc_c_batch.h"
+#include "dxc_c_util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <wchar.h>
+
+// NOTE: Requires POSIX (fork, shared mappings, AF_UNIX SOCK_SEQPACKET). Every
+// worker is a separate process with its own IDxcCompiler3, so compiles share no
+// locks or allocator with the caller or with each other, and a crashing shader
+// only takes down its worker. DxcProcessPool_Compile takes the same jobs and
+// returns the same results as DxcBatch_Compile.
+//
+// Workers are forked from a small zygote process that is itself forked in
+// DxcProcessPool_Create, before the pool starts any thread. Create the pool
+// early, before the application has threads of its own, since the zygote
+// inherits whatever locks those threads held at that moment.
+//
+// Each worker owns one shared mapping: a fixed header, an input arena the
+// parent fills with the job's arguments and source, and an output ring the
+// worker writes the result's outputs into. The sockets only carry small
+// control messages. Result blobs are served zero-copy from the ring and keep
+// their slice reserved until they are released; a result that does not fit in
+// the free part of the ring is written to an anonymous file whose descriptor
+// is passed over the socket instead.
+//
+// Include handlers run in the parent: the worker forwards each LoadSource to
+// the job's pIncludeHandler and receives the file in its input arena. Jobs
+// without one use a default include handler inside the worker.
+//
+// A worker that dies mid-job is respawned and the job that was running fails
+// with DXC_PROCESS_E_CRASHED; pfnCrash, if set, receives the job index and
+// the terminating signal. The job is not retried.
+
+#ifndef DXC_PROCESS_DEFAULT_INPUT_SIZE
+    #define DXC_PROCESS_DEFAULT_INPUT_SIZE (16ull << 20)
+#endif
+#ifndef DXC_PROCESS_DEFAULT_OUTPUT_SIZE
+    #define DXC_PROCESS_DEFAULT_OUTPUT_SIZE (64ull << 20)
+#endif
+
+#define DXC_PROCESS_E_CRASHED ((HRESULT)0x80DC0001) // The worker process died while compiling the job
+
+// --- Structs ----------------------------------------------------------------
+typedef void (*DxcProcessCrashProc)(void *pUserData, UINT32 jobIndex, int signal);
+
+typedef struct DxcProcessPoolDesc {
+    DxcCreateInstanceProc pfnCreateInstance;
+    UINT32                WorkerCount; // 0 uses the number of online CPUs
+    UINT64                InputSize;   // Per worker; 0 selects DXC_PROCESS_DEFAULT_INPUT_SIZE
+    UINT64                OutputSize;  // Per worker; 0 selects DXC_PROCESS_DEFAULT_OUTPUT_SIZE
+    DxcProcessCrashProc   pfnCrash;    // Optional, called from a pool thread
+    void                 *pUserData;
+} DxcProcessPoolDesc;
+
+typedef struct DxcProcessPoolStats {
+    UINT64 Jobs;
+    UINT64 Crashes;         // Jobs that failed with DXC_PROCESS_E_CRASHED
+    UINT64 Respawns;        // Workers started to replace a dead one
+    UINT64 IncludeRequests; // LoadSource calls forwarded to the parent
+    UINT64 OverflowResults; // Results passed in a separate mapping because the ring was full
+} DxcProcessPoolStats;
+
+enum {
+    DXC_PROCESS_MSG_COMPILE      = 1, // Parent to worker: job is in the input arena
+    DXC_PROCESS_MSG_INCLUDE      = 2, // Worker to parent: path at Offset in the input arena
+    DXC_PROCESS_MSG_INCLUDE_DONE = 3, // Parent to worker: file at Offset/Size, code page in Value
+    DXC_PROCESS_MSG_DONE         = 4, // Worker to parent: response at Offset/Size, or in the passed file
+    DXC_PROCESS_MSG_SPAWN        = 5, // Parent to zygote: worker index in Offset, previous pid in Value
+    DXC_PROCESS_MSG_SPAWNED      = 6, // Zygote to parent: new pid in Value, previous wait status in Size
+};
+
+typedef struct DxcProcessMessage {
+    UINT32  Type;
+    HRESULT Status;
+    UINT64  Offset;
+    UINT64  Size;
+    UINT64  Value;
+} DxcProcessMessage;
+
+// Start of every worker mapping, written by the parent before each job
+typedef struct DxcProcessShared {
+    UINT64 ArgsOffset;      // UINT64 offsets of ArgCount null-terminated strings
+    UINT32 ArgCount;
+    UINT32 SourceEncoding;
+    UINT64 SourceOffset;
+    UINT64 SourceSize;
+    UINT32 ForwardIncludes;
+    UINT32 Reserved;
+    UINT64 InputUsed;       // Bump offset into the input arena, advanced by whichever side writes
+    UINT64 OutputOffset;    // Free span of the output ring available to this job
+    UINT64 OutputCapacity;
+} DxcProcessShared;
+
+#define DXC_PROCESS_HEADER_SIZE 4096
+
+// Response written by the worker; offsets are relative to the response
+typedef struct DxcProcessResponse {
+    HRESULT Status;
+    UINT32  OutputCount;
+    UINT32  PrimaryOutput; // DXC_OUT_KIND
+    UINT32  Reserved;
+} DxcProcessResponse;
+
+#define DXC_PROCESS_OUTPUT_KNOWN_ENCODING 0x1
+
+typedef struct DxcProcessOutput {
+    UINT32 Kind;     // DXC_OUT_KIND
+    UINT32 CodePage;
+    UINT32 Flags;
+    UINT32 Reserved;
+    UINT64 DataOffset;
+    UINT64 DataSize;
+    UINT64 NameOffset; // Null-terminated wide string, NameSize 0 if unnamed
+    UINT64 NameSize;
+} DxcProcessOutput;
+
+typedef struct DxcProcessSegment DxcProcessSegment;
+
+// One worker's shared mapping. Outlives the pool while result blobs still
+// point into its output ring.
+typedef struct DxcProcessRegion {
+    BYTE              *pBase;
+    SIZE_T             Size;
+    UINT64             InputSize;
+    UINT64             OutputSize;
+    pthread_mutex_t    Lock;     // Guards the segment list
+    DxcProcessSegment *pOldest;  // Live ring segments in allocation order
+    DxcProcessSegment *pNewest;
+    atomic_uint        RefCount;
+} DxcProcessRegion;
+
+// Memory behind one result: a slice of a region's ring or a private mapping
+struct DxcProcessSegment {
+    DxcProcessRegion  *pRegion; // NULL for a private mapping
+    DxcProcessSegment *pNext;
+    BYTE              *pBase;
+    UINT64             Offset;
+    UINT64             Size;
+    BOOL               Released;
+    atomic_uint        RefCount;
+};
+
+typedef struct DxcProcessPool DxcProcessPool;
+
+typedef struct DxcProcessWorker {
+    DxcProcessPool   *pPool;
+    DxcProcessRegion *pRegion;
+    pthread_t         Thread;
+    pid_t             Pid;
+    int               Socket;
+    UINT32            Index;
+} DxcProcessWorker;
+
+struct DxcProcessPool {
+    DxcCreateInstanceProc pfnCreateInstance;
+    DxcProcessCrashProc   pfnCrash;
+    void                 *pUserData;
+    DxcProcessWorker     *pWorkers;
+    UINT32                WorkerCount;
+    pid_t                 ZygotePid;
+    int                   ZygoteSocket;
+    const DxcBatchJob    *pJobs;
+    DxcBatchResult       *pResults;
+    UINT32                JobCount;
+    atomic_uint           NextJob;
+    DxcProcessPoolStats   Stats;
+    pthread_mutex_t       SubmitLock; // Serializes DxcProcessPool_Compile callers
+    pthread_mutex_t       SpawnLock;  // Serializes requests to the zygote
+    pthread_mutex_t       Lock;       // Guards Stats
+};
+
+// --- Internals --------------------------------------------------------------
+static inline UINT64 DxcProcess_Align(UINT64 value) { return (value + 7) & ~7ull; }
+
+static inline BOOL DxcProcess_Send(int socket, const DxcProcessMessage *pMessage, int fd) {
+    union {
+        struct cmsghdr Header;
+        char           Buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = { (void*)pMessage, sizeof(DxcProcessMessage) };
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+
+    if (fd >= 0) {
+        memset(&control, 0, sizeof(control));
+        header.msg_control = control.Buffer;
+        header.msg_controllen = sizeof(control.Buffer);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    ssize_t written;
+    do {
+        written = sendmsg(socket, &header, MSG_NOSIGNAL);
+    } while (written < 0 && errno == EINTR);
+
+    return written == (ssize_t)sizeof(DxcProcessMessage);
+}
+
+// Returns FALSE when the peer is gone. pFd receives a passed descriptor or -1.
+static inline BOOL DxcProcess_Receive(int socket, DxcProcessMessage *pMessage, int *pFd) {
+    union {
+        struct cmsghdr Header;
+        char           Buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = { pMessage, sizeof(DxcProcessMessage) };
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control.Buffer;
+    header.msg_controllen = sizeof(control.Buffer);
+
+    ssize_t received;
+    do {
+        received = recvmsg(socket, &header, 0);
+    } while (received < 0 && errno == EINTR);
+
+    int fd = -1;
+    struct cmsghdr *cmsg = received > 0 ? CMSG_FIRSTHDR(&header) : NULL;
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    if (pFd) {
+        *pFd = fd;
+    } else if (fd >= 0) {
+        close(fd);
+    }
+
+    return received == (ssize_t)sizeof(DxcProcessMessage);
+}
+
+// Anonymous file for results that do not fit in the ring
+static inline int DxcProcess_CreateTempFile(UINT64 size) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("dxc-result", MFD_CLOEXEC);
+#else
+    char path[] = "/tmp/dxc-result-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+#endif
+    if (fd >= 0 && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static inline BYTE *DxcProcessRegion_Input(DxcProcessRegion *region) { return region->pBase + DXC_PROCESS_HEADER_SIZE; }
+static inline BYTE *DxcProcessRegion_Output(DxcProcessRegion *region) { return region->pBase + DXC_PROCESS_HEADER_SIZE + region->InputSize; }
+
+static inline void DxcProcessRegion_Release(DxcProcessRegion *region) {
+    if (atomic_fetch_sub(&region->RefCount, 1) == 1) {
+        munmap(region->pBase, region->Size);
+        pthread_mutex_destroy(&region->Lock);
+        free(region);
+    }
+}
+
+// Largest contiguous free span of the output ring
+static inline void DxcProcessRegion_FreeSpan(DxcProcessRegion *region, UINT64 *pOffset, UINT64 *pCapacity) {
+    pthread_mutex_lock(&region->Lock);
+    if (!region->pOldest) {
+        *pOffset = 0;
+        *pCapacity = region->OutputSize;
+    } else {
+        UINT64 head = region->pNewest->Offset + region->pNewest->Size;
+        UINT64 tail = region->pOldest->Offset;
+        if (head > tail) {
+            BOOL useEnd = region->OutputSize - head >= tail;
+            *pOffset = useEnd ? head : 0;
+            *pCapacity = useEnd ? region->OutputSize - head : tail;
+        } else {
+            *pOffset = head;
+            *pCapacity = tail - head;
+        }
+    }
+    pthread_mutex_unlock(&region->Lock);
+}
+
+static inline void DxcProcessSegment_Release(DxcProcessSegment *segment) {
+    if (atomic_fetch_sub(&segment->RefCount, 1) != 1) {
+        return;
+    }
+
+    DxcProcessRegion *region = segment->pRegion;
+    if (!region) {
+        munmap(segment->pBase, segment->Size);
+        free(segment);
+        return;
+    }
+
+    // Ring space is reclaimed in allocation order once the oldest slices are free
+    pthread_mutex_lock(&region->Lock);
+    segment->Released = 1;
+    while (region->pOldest && region->pOldest->Released) {
+        DxcProcessSegment *oldest = region->pOldest;
+        region->pOldest = oldest->pNext;
+        free(oldest);
+    }
+    if (!region->pOldest) {
+        region->pNewest = NULL;
+    }
+    pthread_mutex_unlock(&region->Lock);
+
+    DxcProcessRegion_Release(region);
+}
+
+// IDxcBlobUtf8/IDxcBlobWide over a slice of a segment
+typedef struct DxcProcessBlob {
+    void *const       *v;
+    DxcProcessSegment *pSegment;
+    const BYTE        *pData;
+    SIZE_T             Size;
+    UINT32             CodePage;
+    BOOL               KnownEncoding;
+    atomic_uint        RefCount;
+} DxcProcessBlob;
+
+static inline ULONG __stdcall DxcProcessBlob_AddRef(DxcProcessBlob *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcProcessBlob_Release(DxcProcessBlob *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        DxcProcessSegment_Release(self->pSegment);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcProcessBlob_QueryInterface(DxcProcessBlob *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+
+    BOOL supported = memcmp(riid, &IID_IDxcBlob, sizeof(IID)) == 0 || memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) == 0;
+    if (self->KnownEncoding) {
+        supported = supported || memcmp(riid, &IID_IDxcBlobEncoding, sizeof(IID)) == 0;
+        supported = supported || (self->CodePage == DXC_CP_UTF8 && memcmp(riid, &IID_IDxcBlobUtf8, sizeof(IID)) == 0);
+        supported = supported || (self->CodePage == DXC_CP_WIDE && memcmp(riid, &IID_IDxcBlobWide, sizeof(IID)) == 0);
+    }
+    if (!supported) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+
+    DxcProcessBlob_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline LPVOID __stdcall DxcProcessBlob_GetBufferPointer(DxcProcessBlob *self) { return (LPVOID)self->pData; }
+static inline SIZE_T __stdcall DxcProcessBlob_GetBufferSize(DxcProcessBlob *self) { return self->Size; }
+
+static inline HRESULT __stdcall DxcProcessBlob_GetEncoding(DxcProcessBlob *self, BOOL *pKnown, UINT32 *pCodePage) {
+    if (!pKnown || !pCodePage) {
+        return E_POINTER;
+    }
+    *pKnown = self->KnownEncoding;
+    *pCodePage = self->CodePage;
+    return S_OK;
+}
+
+static inline LPCVOID __stdcall DxcProcessBlob_GetStringPointer(DxcProcessBlob *self) { return self->pData; }
+
+// Length in characters, excluding the null terminator DXC stores in text blobs
+static inline SIZE_T __stdcall DxcProcessBlob_GetStringLength(DxcProcessBlob *self) {
+    SIZE_T unit = self->CodePage == DXC_CP_WIDE ? sizeof(WCHAR) : 1;
+    SIZE_T length = self->Size / unit;
+    if (length > 0) {
+        const BYTE *last = self->pData + (length - 1) * unit;
+        BOOL terminated = unit == 1 ? *last == 0 : *(const WCHAR*)last == 0;
+        length -= terminated;
+    }
+    return length;
+}
+
+static void *const DxcProcessBlob_Vtbl[] = {
+    (void*)DxcProcessBlob_QueryInterface,
+    (void*)DxcProcessBlob_AddRef,
+    (void*)DxcProcessBlob_Release,
+    (void*)DxcProcessBlob_GetBufferPointer,
+    (void*)DxcProcessBlob_GetBufferSize,
+    (void*)DxcProcessBlob_GetEncoding,
+    (void*)DxcProcessBlob_GetStringPointer,
+    (void*)DxcProcessBlob_GetStringLength,
+};
+
+static inline IDxcBlob *DxcProcessBlob_Create(DxcProcessSegment *segment, const BYTE *pData, SIZE_T size, UINT32 codePage, BOOL knownEncoding) {
+    DxcProcessBlob *blob = (DxcProcessBlob*)malloc(sizeof(DxcProcessBlob));
+    if (!blob) {
+        return NULL;
+    }
+    blob->v = DxcProcessBlob_Vtbl;
+    blob->pSegment = segment;
+    blob->pData = pData;
+    blob->Size = size;
+    blob->CodePage = codePage;
+    blob->KnownEncoding = knownEncoding;
+    atomic_init(&blob->RefCount, 1);
+    atomic_fetch_add(&segment->RefCount, 1);
+    return (IDxcBlob*)blob;
+}
+
+// IDxcResult rebuilt in the parent from a worker response
+typedef struct DxcProcessResult {
+    void *const  *v;
+    HRESULT       Status;
+    UINT32        OutputCount;
+    DXC_OUT_KIND  PrimaryOutput;
+    DXC_OUT_KIND *pKinds;
+    IDxcBlob    **ppBlobs;
+    IDxcBlob    **ppNames; // Entries are NULL for unnamed outputs
+    atomic_uint   RefCount;
+} DxcProcessResult;
+
+static inline ULONG __stdcall DxcProcessResult_AddRef(DxcProcessResult *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcProcessResult_Release(DxcProcessResult *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        for (UINT32 i = 0; i < self->OutputCount; ++i) {
+            if (self->ppBlobs[i]) { IDxcBlob_Release(self->ppBlobs[i]); }
+            if (self->ppNames[i]) { IDxcBlob_Release(self->ppNames[i]); }
+        }
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcProcessResult_QueryInterface(DxcProcessResult *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcResult, sizeof(IID)) != 0 && memcmp(riid, &IID_IDxcOperationResult, sizeof(IID)) != 0 &&
+        memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcProcessResult_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline IDxcBlob *DxcProcessResult_Find(DxcProcessResult *self, DXC_OUT_KIND kind, IDxcBlob **ppName) {
+    for (UINT32 i = 0; i < self->OutputCount; ++i) {
+        if (self->pKinds[i] == kind) {
+            if (ppName) {
+                *ppName = self->ppNames[i];
+            }
+            return self->ppBlobs[i];
+        }
+    }
+    return NULL;
+}
+
+static inline HRESULT __stdcall DxcProcessResult_GetStatus(DxcProcessResult *self, HRESULT *pStatus) {
+    if (!pStatus) {
+        return E_INVALIDARG;
+    }
+    *pStatus = self->Status;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcProcessResult_GetResult(DxcProcessResult *self, IDxcBlob **ppResult) {
+    if (!ppResult) {
+        return E_INVALIDARG;
+    }
+    *ppResult = DxcProcessResult_Find(self, self->PrimaryOutput, NULL);
+    if (*ppResult) {
+        IDxcBlob_AddRef(*ppResult);
+    }
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcProcessResult_GetErrorBuffer(DxcProcessResult *self, IDxcBlobEncoding **ppErrors) {
+    if (!ppErrors) {
+        return E_INVALIDARG;
+    }
+    *ppErrors = NULL;
+    IDxcBlob *errors = DxcProcessResult_Find(self, DXC_OUT_ERRORS, NULL);
+    return errors ? IDxcBlob_QueryInterface(errors, &IID_IDxcBlobEncoding, (void**)ppErrors) : S_OK;
+}
+
+static inline BOOL __stdcall DxcProcessResult_HasOutput(DxcProcessResult *self, DXC_OUT_KIND kind) {
+    return DxcProcessResult_Find(self, kind, NULL) != NULL;
+}
+
+static inline HRESULT __stdcall DxcProcessResult_GetOutput(DxcProcessResult *self, DXC_OUT_KIND kind, REFIID iid, void **ppvObject,
+                                                           IDxcBlobWide **ppOutputName) {
+    if (!ppvObject) {
+        return E_INVALIDARG;
+    }
+    *ppvObject = NULL;
+    if (ppOutputName) {
+        *ppOutputName = NULL;
+    }
+
+    IDxcBlob *name = NULL;
+    IDxcBlob *blob = DxcProcessResult_Find(self, kind, &name);
+    if (!blob) {
+        return E_INVALIDARG;
+    }
+
+    HRESULT hr = IDxcBlob_QueryInterface(blob, iid, ppvObject);
+    if (SUCCEEDED(hr) && ppOutputName && name) {
+        IDxcBlob_AddRef(name);
+        *ppOutputName = (IDxcBlobWide*)name;
+    }
+    return hr;
+}
+
+static inline UINT32 __stdcall DxcProcessResult_GetNumOutputs(DxcProcessResult *self) { return self->OutputCount; }
+
+static inline DXC_OUT_KIND __stdcall DxcProcessResult_GetOutputByIndex(DxcProcessResult *self, UINT32 index) {
+    return index < self->OutputCount ? self->pKinds[index] : DXC_OUT_NONE;
+}
+
+static inline DXC_OUT_KIND __stdcall DxcProcessResult_PrimaryOutput(DxcProcessResult *self) { return self->PrimaryOutput; }
+
+static void *const DxcProcessResult_Vtbl[] = {
+    (void*)DxcProcessResult_QueryInterface,
+    (void*)DxcProcessResult_AddRef,
+    (void*)DxcProcessResult_Release,
+    (void*)DxcProcessResult_GetStatus,
+    (void*)DxcProcessResult_GetResult,
+    (void*)DxcProcessResult_GetErrorBuffer,
+    (void*)DxcProcessResult_HasOutput,
+    (void*)DxcProcessResult_GetOutput,
+    (void*)DxcProcessResult_GetNumOutputs,
+    (void*)DxcProcessResult_GetOutputByIndex,
+    (void*)DxcProcessResult_PrimaryOutput,
+};
+
+// Wraps a response; takes over the caller's reference to segment. The
+// response was written by another process, so every range is checked.
+static inline HRESULT DxcProcessResult_Create(DxcProcessSegment *segment, IDxcResult **ppResult) {
+    const BYTE *base = segment->pBase;
+    UINT64 size = segment->Size;
+    const DxcProcessResponse *response = (const DxcProcessResponse*)base;
+    const DxcProcessOutput *outputs = (const DxcProcessOutput*)(response + 1);
+
+    HRESULT hr = size >= sizeof(DxcProcessResponse) &&
+                 response->OutputCount <= (size - sizeof(DxcProcessResponse)) / sizeof(DxcProcessOutput) ? S_OK : E_FAIL;
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < response->OutputCount; ++i) {
+        const DxcProcessOutput *output = &outputs[i];
+        if (output->DataOffset > size || output->DataSize > size - output->DataOffset ||
+            output->NameOffset > size || output->NameSize > size - output->NameOffset || output->NameSize % sizeof(WCHAR)) {
+            hr = E_FAIL;
+        }
+    }
+
+    UINT32 count = SUCCEEDED(hr) ? response->OutputCount : 0;
+    DxcProcessResult *result = NULL;
+    if (SUCCEEDED(hr)) {
+        result = (DxcProcessResult*)calloc(1, sizeof(DxcProcessResult) + count * (sizeof(DXC_OUT_KIND) + 2 * sizeof(IDxcBlob*)));
+        hr = result ? S_OK : E_OUTOFMEMORY;
+    }
+
+    if (SUCCEEDED(hr)) {
+        result->v = DxcProcessResult_Vtbl;
+        result->Status = response->Status;
+        result->PrimaryOutput = (DXC_OUT_KIND)response->PrimaryOutput;
+        result->ppBlobs = (IDxcBlob**)(result + 1);
+        result->ppNames = result->ppBlobs + count;
+        result->pKinds = (DXC_OUT_KIND*)(result->ppNames + count);
+        atomic_init(&result->RefCount, 1);
+
+        for (UINT32 i = 0; i < count && SUCCEEDED(hr); ++i) {
+            const DxcProcessOutput *output = &outputs[i];
+            result->OutputCount = i + 1;
+            result->pKinds[i] = (DXC_OUT_KIND)output->Kind;
+            result->ppBlobs[i] = DxcProcessBlob_Create(segment, base + output->DataOffset, (SIZE_T)output->DataSize, output->CodePage,
+                                                       (output->Flags & DXC_PROCESS_OUTPUT_KNOWN_ENCODING) != 0);
+            if (output->NameSize) {
+                result->ppNames[i] = DxcProcessBlob_Create(segment, base + output->NameOffset, (SIZE_T)output->NameSize, DXC_CP_WIDE, 1);
+            }
+            if (!result->ppBlobs[i] || (output->NameSize && !result->ppNames[i])) {
+                hr = E_OUTOFMEMORY;
+            }
+        }
+    }
+
+    if (FAILED(hr) && result) {
+        DxcProcessResult_Release(result);
+        result = NULL;
+    }
+    DxcProcessSegment_Release(segment);
+
+    *ppResult = (IDxcResult*)result;
+    return hr;
+}
+
+// --- Worker process ---------------------------------------------------------
+typedef struct DxcProcessChild {
+    DxcProcessRegion *pRegion;
+    int               Socket;
+    IDxcUtils        *pUtils;
+} DxcProcessChild;
+
+// Forwards LoadSource to the parent; lives on the worker's stack
+typedef struct DxcProcessIncludeProxy {
+    void *const     *v;
+    DxcProcessChild *pChild;
+} DxcProcessIncludeProxy;
+
+static inline HRESULT __stdcall DxcProcessIncludeProxy_QueryInterface(DxcProcessIncludeProxy *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcIncludeHandler, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    *ppv = self;
+    return S_OK;
+}
+
+static inline ULONG __stdcall DxcProcessIncludeProxy_AddRef(DxcProcessIncludeProxy *self) { (void)self; return 1; }
+static inline ULONG __stdcall DxcProcessIncludeProxy_Release(DxcProcessIncludeProxy *self) { (void)self; return 1; }
+
+static inline HRESULT __stdcall DxcProcessIncludeProxy_LoadSource(DxcProcessIncludeProxy *self, LPCWSTR pFilename, IDxcBlob **ppIncludeSource) {
+    if (!pFilename || !ppIncludeSource) {
+        return E_INVALIDARG;
+    }
+    *ppIncludeSource = NULL;
+
+    DxcProcessChild *child = self->pChild;
+    DxcProcessRegion *region = child->pRegion;
+    DxcProcessShared *shared = (DxcProcessShared*)region->pBase;
+    UINT64 size = (wcslen(pFilename) + 1) * sizeof(WCHAR);
+    UINT64 offset = DxcProcess_Align(shared->InputUsed);
+    if (offset > region->InputSize || size > region->InputSize - offset) {
+        return E_OUTOFMEMORY;
+    }
+
+    memcpy(DxcProcessRegion_Input(region) + offset, pFilename, size);
+    shared->InputUsed = offset + size;
+
+    DxcProcessMessage message = { DXC_PROCESS_MSG_INCLUDE, S_OK, offset, size, 0 };
+    if (!DxcProcess_Send(child->Socket, &message, -1) || !DxcProcess_Receive(child->Socket, &message, NULL)) {
+        _exit(0); // The parent is gone
+    }
+    if (FAILED(message.Status)) {
+        return message.Status;
+    }
+    if (message.Offset > region->InputSize || message.Size > region->InputSize - message.Offset || message.Size > 0xFFFFFFFFull) {
+        return E_FAIL;
+    }
+
+    return IDxcUtils_CreateBlobFromPinned(child->pUtils, DxcProcessRegion_Input(region) + message.Offset, (UINT32)message.Size,
+                                          (UINT32)message.Value, (IDxcBlobEncoding**)ppIncludeSource);
+}
+
+static void *const DxcProcessIncludeProxy_Vtbl[] = {
+    (void*)DxcProcessIncludeProxy_QueryInterface,
+    (void*)DxcProcessIncludeProxy_AddRef,
+    (void*)DxcProcessIncludeProxy_Release,
+    (void*)DxcProcessIncludeProxy_LoadSource,
+};
+
+// Serializes a compile result into the free ring span or, if it does not
+// fit, into an anonymous file that is passed to the parent
+static inline void DxcProcessChild_Respond(DxcProcessChild *child, HRESULT compileStatus, IDxcResult *pResult) {
+    DxcProcessRegion *region = child->pRegion;
+    DxcProcessShared *shared = (DxcProcessShared*)region->pBase;
+    UINT32 count = pResult ? IDxcResult_GetNumOutputs(pResult) : 0;
+    IDxcBlob **blobs = count ? (IDxcBlob**)calloc(count, sizeof(IDxcBlob*)) : NULL;
+    IDxcBlobWide **names = count ? (IDxcBlobWide**)calloc(count, sizeof(IDxcBlobWide*)) : NULL;
+    if (count && (!blobs || !names)) {
+        count = 0;
+        compileStatus = E_OUTOFMEMORY;
+    }
+
+    DxcProcessResponse response = { compileStatus, count, DXC_OUT_NONE, 0 };
+    if (pResult) {
+        IDxcResult_GetStatus(pResult, &response.Status);
+        response.PrimaryOutput = IDxcResult_PrimaryOutput(pResult);
+    }
+
+    UINT64 total = sizeof(DxcProcessResponse) + count * sizeof(DxcProcessOutput);
+    for (UINT32 i = 0; i < count; ++i) {
+        DXC_OUT_KIND kind = IDxcResult_GetOutputByIndex(pResult, i);
+        if (FAILED(IDxcResult_GetOutput(pResult, kind, &IID_IDxcBlob, (void**)&blobs[i], &names[i])) || !blobs[i]) {
+            blobs[i] = NULL;
+            continue;
+        }
+        total += DxcProcess_Align(IDxcBlob_GetBufferSize(blobs[i]));
+        if (names[i]) {
+            total += DxcProcess_Align((IDxcBlobWide_GetStringLength(names[i]) + 1) * sizeof(WCHAR));
+        }
+    }
+
+    int fd = -1;
+    BYTE *base = NULL;
+    DxcProcessMessage message = { DXC_PROCESS_MSG_DONE, pResult ? S_OK : compileStatus, shared->OutputOffset, total, 0 };
+    if (total <= shared->OutputCapacity) {
+        base = DxcProcessRegion_Output(region) + shared->OutputOffset;
+    } else {
+        fd = DxcProcess_CreateTempFile(total);
+        base = fd >= 0 ? (BYTE*)mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : NULL;
+        if (base == MAP_FAILED) {
+            base = NULL;
+        }
+        message.Offset = 0;
+    }
+
+    if (base) {
+        DxcProcessOutput *outputs = (DxcProcessOutput*)(base + sizeof(DxcProcessResponse));
+        UINT64 offset = sizeof(DxcProcessResponse) + count * sizeof(DxcProcessOutput);
+        UINT32 written = 0;
+        for (UINT32 i = 0; i < count; ++i) {
+            if (!blobs[i]) {
+                continue;
+            }
+            DxcProcessOutput *output = &outputs[written++];
+            IDxcBlobEncoding *encoding = NULL;
+            BOOL known = 0;
+            UINT32 codePage = DXC_CP_ACP;
+            if (SUCCEEDED(IDxcBlob_QueryInterface(blobs[i], &IID_IDxcBlobEncoding, (void**)&encoding)) && encoding) {
+                IDxcBlobEncoding_GetEncoding(encoding, &known, &codePage);
+                IDxcBlobEncoding_Release(encoding);
+            }
+
+            memset(output, 0, sizeof(DxcProcessOutput));
+            output->Kind = IDxcResult_GetOutputByIndex(pResult, i);
+            output->CodePage = codePage;
+            output->Flags = known ? DXC_PROCESS_OUTPUT_KNOWN_ENCODING : 0;
+            output->DataOffset = offset;
+            output->DataSize = IDxcBlob_GetBufferSize(blobs[i]);
+            memcpy(base + offset, IDxcBlob_GetBufferPointer(blobs[i]), output->DataSize);
+            offset += DxcProcess_Align(output->DataSize);
+
+            if (names[i]) {
+                output->NameOffset = offset;
+                output->NameSize = (IDxcBlobWide_GetStringLength(names[i]) + 1) * sizeof(WCHAR);
+                memcpy(base + offset, IDxcBlobWide_GetStringPointer(names[i]), output->NameSize - sizeof(WCHAR));
+                memset(base + offset + output->NameSize - sizeof(WCHAR), 0, sizeof(WCHAR));
+                offset += DxcProcess_Align(output->NameSize);
+            }
+        }
+        response.OutputCount = written;
+        memcpy(base, &response, sizeof(DxcProcessResponse));
+    } else {
+        message.Status = E_OUTOFMEMORY;
+    }
+
+    DxcProcess_Send(child->Socket, &message, fd);
+
+    if (fd >= 0) {
+        if (base) {
+            munmap(base, total);
+        }
+        close(fd);
+    }
+    for (UINT32 i = 0; i < count; ++i) {
+        if (blobs[i]) { IDxcBlob_Release(blobs[i]); }
+        if (names[i]) { IDxcBlobWide_Release(names[i]); }
+    }
+    free(names);
+    free(blobs);
+}
+
+static inline void DxcProcessChild_Compile(DxcProcessChild *child, IDxcCompiler3 *pCompiler, IDxcIncludeHandler *pDefaultIncludeHandler) {
+    DxcProcessRegion *region = child->pRegion;
+    DxcProcessShared *shared = (DxcProcessShared*)region->pBase;
+    BYTE *input = DxcProcessRegion_Input(region);
+    DxcProcessIncludeProxy proxy = { DxcProcessIncludeProxy_Vtbl, child };
+    IDxcResult *result = NULL;
+    HRESULT hr = pCompiler ? S_OK : E_FAIL;
+
+    LPCWSTR *arguments = (LPCWSTR*)malloc((shared->ArgCount ? shared->ArgCount : 1) * sizeof(LPCWSTR));
+    if (SUCCEEDED(hr) && !arguments) {
+        hr = E_OUTOFMEMORY;
+    }
+
+    if (SUCCEEDED(hr)) {
+        const UINT64 *argOffsets = (const UINT64*)(input + shared->ArgsOffset);
+        for (UINT32 i = 0; i < shared->ArgCount; ++i) {
+            arguments[i] = (LPCWSTR)(input + argOffsets[i]);
+        }
+
+        DxcBuffer source = { input + shared->SourceOffset, (SIZE_T)shared->SourceSize, shared->SourceEncoding };
+        IDxcIncludeHandler *includeHandler = shared->ForwardIncludes ? (IDxcIncludeHandler*)&proxy : pDefaultIncludeHandler;
+        hr = IDxcCompiler3_Compile(pCompiler, &source, arguments, shared->ArgCount, includeHandler, &IID_IDxcResult, (void**)&result);
+    }
+    free(arguments);
+
+    DxcProcessChild_Respond(child, hr, SUCCEEDED(hr) ? result : NULL);
+    if (result) {
+        IDxcResult_Release(result);
+    }
+}
+
+static inline void DxcProcessChild_Main(DxcProcessPool *pool, DxcProcessRegion *region, int socket) {
+    DxcProcessChild child = { region, socket, NULL };
+    IDxcCompiler3 *compiler = NULL;
+    IDxcIncludeHandler *defaultIncludeHandler = NULL;
+
+    // Creation failures are reported per job instead of crashing into a respawn loop
+    HRESULT hr = pool->pfnCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, (LPVOID*)&compiler);
+    if (SUCCEEDED(hr)) { hr = pool->pfnCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, (LPVOID*)&child.pUtils); }
+    if (SUCCEEDED(hr)) { hr = IDxcUtils_CreateDefaultIncludeHandler(child.pUtils, &defaultIncludeHandler); }
+
+    DxcProcessMessage message;
+    while (DxcProcess_Receive(socket, &message, NULL)) {
+        if (message.Type != DXC_PROCESS_MSG_COMPILE) {
+            continue;
+        }
+        if (FAILED(hr)) {
+            DxcProcessChild_Respond(&child, hr, NULL);
+        } else {
+            DxcProcessChild_Compile(&child, compiler, defaultIncludeHandler);
+        }
+    }
+
+    if (defaultIncludeHandler) { IDxcIncludeHandler_Release(defaultIncludeHandler); }
+    if (child.pUtils)          { IDxcUtils_Release(child.pUtils); }
+    if (compiler)              { IDxcCompiler3_Release(compiler); }
+}
+
+// Single-threaded fork server. It only forks and reaps, so workers never
+// inherit a lock held by one of the pool's threads.
+static inline void DxcProcessPool_ZygoteMain(DxcProcessPool *pool, int control) {
+    DxcProcessMessage message;
+    while (DxcProcess_Receive(control, &message, NULL)) {
+        DxcProcessMessage reply = { DXC_PROCESS_MSG_SPAWNED, E_FAIL, 0, 0, 0 };
+        int status = 0;
+        if (message.Value) {
+            while (waitpid((pid_t)message.Value, &status, 0) < 0 && errno == EINTR) {
+            }
+            reply.Size = (UINT32)status;
+        }
+
+        int sockets[2] = { -1, -1 };
+        if (message.Offset < pool->WorkerCount && socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) == 0) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(control);
+                close(sockets[0]);
+                DxcProcessChild_Main(pool, pool->pWorkers[message.Offset].pRegion, sockets[1]);
+                _exit(0);
+            }
+            close(sockets[1]);
+            if (pid > 0) {
+                reply.Status = S_OK;
+                reply.Value = (UINT64)pid;
+            }
+        }
+
+        DxcProcess_Send(control, &reply, reply.Status == S_OK ? sockets[0] : -1);
+        if (sockets[0] >= 0) {
+            close(sockets[0]);
+        }
+    }
+
+    while (wait(NULL) > 0 || errno == EINTR) {
+    }
+    _exit(0);
+}
+
+// Starts a worker process, reaping the previous one first. pWaitStatus
+// receives the previous process' wait status.
+static inline HRESULT DxcProcessPool_Spawn(DxcProcessPool *pool, DxcProcessWorker *worker, int *pWaitStatus) {
+    DxcProcessMessage message = { DXC_PROCESS_MSG_SPAWN, S_OK, worker->Index, 0, (UINT64)worker->Pid };
+    int fd = -1;
+
+    if (worker->Socket >= 0) {
+        close(worker->Socket);
+        worker->Socket = -1;
+    }
+
+    pthread_mutex_lock(&pool->SpawnLock);
+    BOOL sent = DxcProcess_Send(pool->ZygoteSocket, &message, -1) && DxcProcess_Receive(pool->ZygoteSocket, &message, &fd);
+    pthread_mutex_unlock(&pool->SpawnLock);
+
+    if (pWaitStatus) {
+        *pWaitStatus = sent ? (int)message.Size : 0;
+    }
+    if (!sent || FAILED(message.Status) || fd < 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        worker->Pid = 0;
+        return E_FAIL;
+    }
+
+    worker->Pid = (pid_t)message.Value;
+    worker->Socket = fd;
+    return S_OK;
+}
+
+// Copies arguments and source into the worker's input arena
+static inline HRESULT DxcProcessWorker_WriteJob(DxcProcessWorker *worker, const DxcBatchJob *job) {
+    DxcProcessRegion *region = worker->pRegion;
+    DxcProcessShared *shared = (DxcProcessShared*)region->pBase;
+    BYTE *input = DxcProcessRegion_Input(region);
+
+    UINT64 total = DxcProcess_Align((UINT64)job->ArgCount * sizeof(UINT64));
+    for (UINT32 i = 0; i < job->ArgCount; ++i) {
+        total += DxcProcess_Align((wcslen(job->pArguments[i]) + 1) * sizeof(WCHAR));
+    }
+    total += job->Source.Size;
+    if (total > region->InputSize) {
+        return E_OUTOFMEMORY;
+    }
+
+    UINT64 *argOffsets = (UINT64*)input;
+    UINT64 offset = DxcProcess_Align((UINT64)job->ArgCount * sizeof(UINT64));
+    for (UINT32 i = 0; i < job->ArgCount; ++i) {
+        UINT64 size = (wcslen(job->pArguments[i]) + 1) * sizeof(WCHAR);
+        memcpy(input + offset, job->pArguments[i], size);
+        argOffsets[i] = offset;
+        offset += DxcProcess_Align(size);
+    }
+    if (job->Source.Size) {
+        memcpy(input + offset, job->Source.Ptr, job->Source.Size);
+    }
+
+    shared->ArgsOffset = 0;
+    shared->ArgCount = job->ArgCount;
+    shared->SourceOffset = offset;
+    shared->SourceSize = job->Source.Size;
+    shared->SourceEncoding = job->Source.Encoding;
+    shared->ForwardIncludes = job->pIncludeHandler != NULL;
+    shared->InputUsed = offset + job->Source.Size;
+    DxcProcessRegion_FreeSpan(region, &shared->OutputOffset, &shared->OutputCapacity);
+    return S_OK;
+}
+
+// Runs the job's include handler for the worker and places the file after
+// everything already in the input arena
+static inline HRESULT DxcProcessWorker_LoadInclude(DxcProcessWorker *worker, const DxcBatchJob *job, const DxcProcessMessage *pRequest,
+                                                   DxcProcessMessage *pReply) {
+    DxcProcessRegion *region = worker->pRegion;
+    DxcProcessShared *shared = (DxcProcessShared*)region->pBase;
+    BYTE *input = DxcProcessRegion_Input(region);
+
+    if (pRequest->Offset > region->InputSize || pRequest->Size < sizeof(WCHAR) || pRequest->Size > region->InputSize - pRequest->Offset ||
+        ((const WCHAR*)(input + pRequest->Offset))[pRequest->Size / sizeof(WCHAR) - 1] != 0) {
+        return E_INVALIDARG;
+    }
+
+    IDxcBlob *blob = NULL;
+    HRESULT hr = IDxcIncludeHandler_LoadSource(job->pIncludeHandler, (LPCWSTR)(input + pRequest->Offset), &blob);
+    if (SUCCEEDED(hr) && !blob) {
+        hr = E_FAIL;
+    }
+
+    if (SUCCEEDED(hr)) {
+        SIZE_T size = IDxcBlob_GetBufferSize(blob);
+        UINT64 offset = DxcProcess_Align(shared->InputUsed);
+        IDxcBlobEncoding *encoding = NULL;
+        BOOL known = 0;
+        UINT32 codePage = DXC_CP_ACP;
+        if (SUCCEEDED(IDxcBlob_QueryInterface(blob, &IID_IDxcBlobEncoding, (void**)&encoding)) && encoding) {
+            IDxcBlobEncoding_GetEncoding(encoding, &known, &codePage);
+            IDxcBlobEncoding_Release(encoding);
+        }
+
+        if (offset > region->InputSize || size > region->InputSize - offset) {
+            hr = E_OUTOFMEMORY;
+        } else {
+            memcpy(input + offset, IDxcBlob_GetBufferPointer(blob), size);
+            shared->InputUsed = offset + size;
+            pReply->Offset = offset;
+            pReply->Size = size;
+            pReply->Value = known ? codePage : DXC_CP_ACP;
+        }
+    }
+
+    if (blob) {
+        IDxcBlob_Release(blob);
+    }
+    return hr;
+}
+
+// Turns a DONE message into a result backed by the ring or the passed file
+static inline HRESULT DxcProcessWorker_ReadResult(DxcProcessWorker *worker, const DxcProcessMessage *pMessage, int fd, IDxcResult **ppResult) {
+    DxcProcessRegion *region = worker->pRegion;
+    DxcProcessShared *shared = (DxcProcessShared*)region->pBase;
+    DxcProcessSegment *segment = (DxcProcessSegment*)calloc(1, sizeof(DxcProcessSegment));
+    if (!segment) {
+        return E_OUTOFMEMORY;
+    }
+    atomic_init(&segment->RefCount, 1);
+    segment->Size = pMessage->Size;
+
+    if (fd >= 0) {
+        void *base = pMessage->Size ? mmap(NULL, pMessage->Size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if (base == MAP_FAILED) {
+            free(segment);
+            return E_FAIL;
+        }
+        segment->pBase = (BYTE*)base;
+    } else {
+        if (pMessage->Offset != shared->OutputOffset || pMessage->Size > shared->OutputCapacity) {
+            free(segment);
+            return E_FAIL;
+        }
+        segment->pRegion = region;
+        segment->Offset = pMessage->Offset;
+        segment->Size = DxcProcess_Align(pMessage->Size);
+        segment->pBase = DxcProcessRegion_Output(region) + pMessage->Offset;
+        atomic_fetch_add(&region->RefCount, 1);
+
+        pthread_mutex_lock(&region->Lock);
+        if (region->pNewest) {
+            region->pNewest->pNext = segment;
+        } else {
+            region->pOldest = segment;
+        }
+        region->pNewest = segment;
+        pthread_mutex_unlock(&region->Lock);
+    }
+
+    return DxcProcessResult_Create(segment, ppResult);
+}
+
+static inline void DxcProcessWorker_RunJob(DxcProcessWorker *worker, UINT32 jobIndex) {
+    DxcProcessPool *pool = worker->pPool;
+    const DxcBatchJob *job = &pool->pJobs[jobIndex];
+    DxcBatchResult *result = &pool->pResults[jobIndex];
+    UINT64 includeRequests = 0;
+    BOOL overflow = 0;
+    BOOL crashed = 0;
+
+    result->pResult = NULL;
+    result->Status = worker->Socket >= 0 ? S_OK : DxcProcessPool_Spawn(pool, worker, NULL);
+    if (SUCCEEDED(result->Status)) {
+        result->Status = DxcProcessWorker_WriteJob(worker, job);
+    }
+
+    DxcProcessMessage message = { DXC_PROCESS_MSG_COMPILE, S_OK, 0, 0, 0 };
+    if (SUCCEEDED(result->Status)) {
+        crashed = !DxcProcess_Send(worker->Socket, &message, -1);
+    }
+
+    while (SUCCEEDED(result->Status) && !crashed) {
+        int fd = -1;
+        if (!DxcProcess_Receive(worker->Socket, &message, &fd)) {
+            crashed = 1;
+            break;
+        }
+
+        if (message.Type == DXC_PROCESS_MSG_INCLUDE && job->pIncludeHandler) {
+            DxcProcessMessage reply = { DXC_PROCESS_MSG_INCLUDE_DONE, S_OK, 0, 0, 0 };
+            reply.Status = DxcProcessWorker_LoadInclude(worker, job, &message, &reply);
+            includeRequests++;
+            crashed = !DxcProcess_Send(worker->Socket, &reply, -1);
+        } else if (message.Type == DXC_PROCESS_MSG_DONE) {
+            overflow = fd >= 0;
+            result->Status = SUCCEEDED(message.Status) ? DxcProcessWorker_ReadResult(worker, &message, fd, &result->pResult) : message.Status;
+            if (fd >= 0) {
+                close(fd);
+            }
+            break;
+        } else if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    int signal = 0;
+    if (crashed) {
+        int waitStatus = 0;
+        DxcProcessPool_Spawn(pool, worker, &waitStatus); // On failure the next job retries
+        signal = WIFSIGNALED(waitStatus) ? WTERMSIG(waitStatus) : 0;
+        result->Status = DXC_PROCESS_E_CRASHED;
+    }
+
+    pthread_mutex_lock(&pool->Lock);
+    pool->Stats.Jobs++;
+    pool->Stats.Crashes += crashed;
+    pool->Stats.Respawns += crashed;
+    pool->Stats.IncludeRequests += includeRequests;
+    pool->Stats.OverflowResults += overflow;
+    pthread_mutex_unlock(&pool->Lock);
+
+    if (crashed && pool->pfnCrash) {
+        pool->pfnCrash(pool->pUserData, jobIndex, signal);
+    }
+}
+
+static inline void *DxcProcessWorker_ThreadMain(void *arg) {
+    DxcProcessWorker *worker = (DxcProcessWorker*)arg;
+    DxcProcessPool *pool = worker->pPool;
+
+    for (;;) {
+        UINT32 jobIndex = atomic_fetch_add(&pool->NextJob, 1);
+        if (jobIndex >= pool->JobCount) {
+            return NULL;
+        }
+        DxcProcessWorker_RunJob(worker, jobIndex);
+    }
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline void DxcProcessPool_Destroy(DxcProcessPool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    // Workers exit when their socket closes, the zygote when its control
+    // socket closes, after reaping every worker
+    for (UINT32 i = 0; i < pool->WorkerCount; ++i) {
+        if (pool->pWorkers[i].Socket >= 0) {
+            close(pool->pWorkers[i].Socket);
+        }
+    }
+    if (pool->ZygoteSocket >= 0) {
+        close(pool->ZygoteSocket);
+    }
+    if (pool->ZygotePid > 0) {
+        while (waitpid(pool->ZygotePid, NULL, 0) < 0 && errno == EINTR) {
+        }
+    }
+
+    for (UINT32 i = 0; i < pool->WorkerCount; ++i) {
+        if (pool->pWorkers[i].pRegion) {
+            DxcProcessRegion_Release(pool->pWorkers[i].pRegion);
+        }
+    }
+
+    pthread_mutex_destroy(&pool->Lock);
+    pthread_mutex_destroy(&pool->SpawnLock);
+    pthread_mutex_destroy(&pool->SubmitLock);
+    free(pool->pWorkers);
+    free(pool);
+}
+
+static inline HRESULT DxcProcessPool_Create(const DxcProcessPoolDesc *pDesc, DxcProcessPool **ppPool) {
+    if (!pDesc || !pDesc->pfnCreateInstance || !ppPool) {
+        return E_INVALIDARG;
+    }
+
+    *ppPool = NULL;
+
+    UINT32 workerCount = pDesc->WorkerCount;
+    if (workerCount == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = cpus > 0 ? (UINT32)cpus : 1;
+    }
+    UINT64 inputSize = DxcProcess_Align(pDesc->InputSize ? pDesc->InputSize : DXC_PROCESS_DEFAULT_INPUT_SIZE);
+    UINT64 outputSize = DxcProcess_Align(pDesc->OutputSize ? pDesc->OutputSize : DXC_PROCESS_DEFAULT_OUTPUT_SIZE);
+
+    DxcProcessPool *pool = (DxcProcessPool*)calloc(1, sizeof(DxcProcessPool));
+    DxcProcessWorker *workers = (DxcProcessWorker*)calloc(workerCount, sizeof(DxcProcessWorker));
+    if (!pool || !workers) {
+        free(workers);
+        free(pool);
+        return E_OUTOFMEMORY;
+    }
+
+    pool->pfnCreateInstance = pDesc->pfnCreateInstance;
+    pool->pfnCrash = pDesc->pfnCrash;
+    pool->pUserData = pDesc->pUserData;
+    pool->pWorkers = workers;
+    pool->WorkerCount = workerCount;
+    pool->ZygoteSocket = -1;
+    pthread_mutex_init(&pool->SubmitLock, NULL);
+    pthread_mutex_init(&pool->SpawnLock, NULL);
+    pthread_mutex_init(&pool->Lock, NULL);
+
+    HRESULT hr = S_OK;
+    for (UINT32 i = 0; i < workerCount && SUCCEEDED(hr); ++i) {
+        DxcProcessWorker *worker = &workers[i];
+        worker->pPool = pool;
+        worker->Index = i;
+        worker->Socket = -1;
+
+        DxcProcessRegion *region = (DxcProcessRegion*)calloc(1, sizeof(DxcProcessRegion));
+        SIZE_T size = DXC_PROCESS_HEADER_SIZE + inputSize + outputSize;
+        void *base = region ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+        if (base == MAP_FAILED) {
+            free(region);
+            hr = E_OUTOFMEMORY;
+            break;
+        }
+
+        region->pBase = (BYTE*)base;
+        region->Size = size;
+        region->InputSize = inputSize;
+        region->OutputSize = outputSize;
+        pthread_mutex_init(&region->Lock, NULL);
+        atomic_init(&region->RefCount, 1);
+        worker->pRegion = region;
+    }
+
+    // The zygote inherits every region, so it must be forked after they exist
+    int control[2] = { -1, -1 };
+    if (SUCCEEDED(hr) && socketpair(AF_UNIX, SOCK_SEQPACKET, 0, control) != 0) {
+        hr = E_FAIL;
+    }
+    if (SUCCEEDED(hr)) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(control[0]);
+            DxcProcessPool_ZygoteMain(pool, control[1]);
+        }
+        close(control[1]);
+        pool->ZygoteSocket = control[0];
+        pool->ZygotePid = pid;
+        hr = pid > 0 ? S_OK : E_FAIL;
+    }
+
+    for (UINT32 i = 0; i < workerCount && SUCCEEDED(hr); ++i) {
+        hr = DxcProcessPool_Spawn(pool, &workers[i], NULL);
+    }
+
+    if (FAILED(hr)) {
+        DxcProcessPool_Destroy(pool);
+        return hr;
+    }
+
+    *ppPool = pool;
+    return S_OK;
+}
+
+// Compiles pJobs[0..jobCount) on the worker processes and writes pResults[i]
+// for pJobs[i], like DxcBatch_Compile. Per-job failures, including crashes,
+// are reported through pResults; the return value only covers invalid
+// arguments and thread creation.
+static inline HRESULT DxcProcessPool_Compile(DxcProcessPool *pool, const DxcBatchJob *pJobs, UINT32 jobCount, DxcBatchResult *pResults) {
+    if (!pool || (jobCount && (!pJobs || !pResults))) {
+        return E_INVALIDARG;
+    }
+    if (jobCount == 0) {
+        return S_OK;
+    }
+
+    pthread_mutex_lock(&pool->SubmitLock);
+    pool->pJobs = pJobs;
+    pool->pResults = pResults;
+    pool->JobCount = jobCount;
+    atomic_store(&pool->NextJob, 0);
+
+    UINT32 threadCount = pool->WorkerCount < jobCount ? pool->WorkerCount : jobCount;
+    UINT32 started = 0;
+    for (; started < threadCount; ++started) {
+        DxcProcessWorker *worker = &pool->pWorkers[started];
+        if (pthread_create(&worker->Thread, NULL, DxcProcessWorker_ThreadMain, worker) != 0) {
+            break;
+        }
+    }
+    for (UINT32 i = 0; i < started; ++i) {
+        pthread_join(pool->pWorkers[i].Thread, NULL);
+    }
+
+    pool->pJobs = NULL;
+    pool->pResults = NULL;
+    pool->JobCount = 0;
+    pthread_mutex_unlock(&pool->SubmitLock);
+
+    return started ? S_OK : E_FAIL;
+}
+
+static inline DxcProcessPoolStats DxcProcessPool_GetStats(DxcProcessPool *pool) {
+    pthread_mutex_lock(&pool->Lock);
+    DxcProcessPoolStats stats = pool->Stats;
+    pthread_mutex_unlock(&pool->Lock);
+
+    return stats;
+}
+
+#endif /* __DXC_PROCESS_C__ */
@@ -0,0 +1,604 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_profile.h                                                           //
+// Build-wide compile profiling merged into one Chrome trace                 //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_PROFILE_C__
+#define __DXC_PROFILE_C__
+
+#include "dxc_c.h"
+#include "dxc_c_args.h"
+#include "dxc_c_util.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// NOTE: Requires POSIX threads. A DxcProfiler collects one record per compile
+// plus wrapper-level spans (queue wait, argument building, include I/O,
+// validation, or anything else the caller measures). DxcProfiler_Compile3
+// adds -ftime-report and -ftime-trace to the arguments, so DXC fills
+// DXC_OUT_TIME_REPORT and DXC_OUT_TIME_TRACE; both are copied out of the
+// result when the compile ends. DxcProfiler_WriteTrace merges everything into
+// a single Chrome trace (chrome://tracing, ui.perfetto.dev): DXC's own events
+// are rebased onto the thread and start time of the compile that produced
+// them. DxcProfiler_WriteSummary prints the slowest shaders of the build.
+//
+// Spans recorded on a thread while a compile is open on it, such as include
+// loads through DxcProfiler_CreateIncludeHandler, are attributed to that
+// compile. The profiler must outlive every handler created from it.
+
+#define DXC_PROFILE_ARG_TIME_REPORT L"-ftime-report"
+#define DXC_PROFILE_ARG_TIME_TRACE  L"-ftime-trace"
+#define DXC_PROFILE_NO_COMPILE      0xFFFFFFFFu
+
+typedef enum DxcProfileCategory {
+    DXC_PROFILE_QUEUE    = 0, // Time between submission and the start of the compile
+    DXC_PROFILE_ARGS     = 1,
+    DXC_PROFILE_INCLUDE  = 2,
+    DXC_PROFILE_COMPILE  = 3,
+    DXC_PROFILE_VALIDATE = 4,
+    DXC_PROFILE_OTHER    = 5,
+    DXC_PROFILE_CATEGORY_COUNT
+} DxcProfileCategory;
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcProfileSpan {
+    UINT64             StartNs;
+    UINT64             EndNs;
+    UINT32             CompileId; // DXC_PROFILE_NO_COMPILE if not attributed
+    UINT32             ThreadId;
+    DxcProfileCategory Category;
+    char              *pDetail;   // Optional, e.g. the include file name
+} DxcProfileSpan;
+
+typedef struct DxcProfileCompile {
+    char   *pName;
+    UINT64  StartNs;
+    UINT64  EndNs;
+    UINT32  ThreadId;
+    HRESULT Status;
+    char   *pTimeTrace;  // DXC_OUT_TIME_TRACE, NUL-terminated, or NULL
+    char   *pTimeReport; // DXC_OUT_TIME_REPORT, NUL-terminated, or NULL
+    UINT64  CategoryNs[DXC_PROFILE_CATEGORY_COUNT];
+} DxcProfileCompile;
+
+typedef struct DxcProfiler {
+    pthread_mutex_t    Lock; // Guards everything below
+    UINT64             OriginNs;
+    DxcProfileCompile *pCompiles;
+    UINT32             CompileCount;
+    UINT32             CompileCapacity;
+    DxcProfileSpan    *pSpans;
+    UINT32             SpanCount;
+    UINT32             SpanCapacity;
+} DxcProfiler;
+
+typedef struct DxcProfileIncludeHandler {
+    void *const        *v;
+    atomic_uint         RefCount;
+    DxcProfiler        *pProfiler;
+    IDxcIncludeHandler *pInner;
+} DxcProfileIncludeHandler;
+
+// --- Internals --------------------------------------------------------------
+static atomic_uint DxcProfile_NextThreadId;
+static _Thread_local UINT32 DxcProfile_ThreadId;
+static _Thread_local DxcProfiler *DxcProfile_CurrentProfiler;
+static _Thread_local UINT32 DxcProfile_CurrentCompile = DXC_PROFILE_NO_COMPILE;
+
+static const char *const DxcProfile_CategoryNames[DXC_PROFILE_CATEGORY_COUNT] = {
+    "queue", "args", "include", "compile", "validate", "other",
+};
+
+static inline UINT32 DxcProfile_GetThreadId(void) {
+    if (!DxcProfile_ThreadId) {
+        DxcProfile_ThreadId = atomic_fetch_add(&DxcProfile_NextThreadId, 1) + 1;
+    }
+    return DxcProfile_ThreadId;
+}
+
+static inline char *DxcProfile_CopyString(const char *pText, SIZE_T size) {
+    char *copy = (char*)malloc(size + 1);
+    if (copy) {
+        memcpy(copy, pText, size);
+        copy[size] = '\0';
+    }
+    return copy;
+}
+
+// Copies a text output of the result, or returns NULL if it is absent
+static inline char *DxcProfile_CopyOutput(IDxcResult *pResult, DXC_OUT_KIND kind) {
+    IDxcBlob *blob = NULL;
+    char *copy = NULL;
+    if (SUCCEEDED(IDxcResult_GetOutput(pResult, kind, &IID_IDxcBlob, (void**)&blob, NULL)) && blob) {
+        copy = DxcProfile_CopyString((const char*)IDxcBlob_GetBufferPointer(blob), IDxcBlob_GetBufferSize(blob));
+        IDxcBlob_Release(blob);
+    }
+    return copy;
+}
+
+static inline void DxcProfile_WriteEscaped(FILE *file, const char *pText) {
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char*)pText; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        }
+        else if (*p == '\n') {
+            fputs("\\n", file);
+        }
+        else if (*p < 0x20) {
+            fprintf(file, "\\u%04x", *p);
+        }
+        else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static inline const char *DxcProfile_SkipSpace(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the end of the JSON value starting at p, or NULL if it is malformed
+static inline const char *DxcProfile_SkipValue(const char *p, const char *end) {
+    UINT32 depth = 0;
+    while (p < end) {
+        if (*p == '"') {
+            for (++p; p < end && *p != '"'; ++p) {
+                if (*p == '\\' && p + 1 < end) {
+                    ++p;
+                }
+            }
+            if (p >= end) {
+                return NULL;
+            }
+            ++p;
+            if (!depth) {
+                return p;
+            }
+        }
+        else if (*p == '{' || *p == '[') {
+            ++depth;
+            ++p;
+        }
+        else if (*p == '}' || *p == ']') {
+            if (!depth) {
+                return p;
+            }
+            ++p;
+            if (--depth == 0) {
+                return p;
+            }
+        }
+        else if (!depth && (*p == ',' || *p == ':' || *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            return p;
+        }
+        else {
+            ++p;
+        }
+    }
+    return depth ? NULL : p;
+}
+
+// Re-emits the "traceEvents" of a DXC time trace with ts rebased to baseUs
+// and pid/tid replaced by the compile's thread
+static inline void DxcProfile_WriteDxcEvents(FILE *file, const char *pTrace, double baseUs, UINT32 threadId) {
+    const char *end = pTrace + strlen(pTrace);
+    const char *p = strstr(pTrace, "\"traceEvents\"");
+    if (!p) {
+        return;
+    }
+    p = DxcProfile_SkipSpace(p + 13, end);
+    if (p >= end || *p != ':') {
+        return;
+    }
+    p = DxcProfile_SkipSpace(p + 1, end);
+    if (p >= end || *p != '[') {
+        return;
+    }
+    ++p;
+
+    for (;;) {
+        p = DxcProfile_SkipSpace(p, end);
+        if (p < end && *p == ',') {
+            p = DxcProfile_SkipSpace(p + 1, end);
+        }
+        if (p >= end || *p != '{') {
+            return;
+        }
+        ++p;
+
+        fputs(",\n{", file);
+        BOOL firstMember = 1;
+        for (;;) {
+            p = DxcProfile_SkipSpace(p, end);
+            if (p < end && *p == ',') {
+                p = DxcProfile_SkipSpace(p + 1, end);
+            }
+            if (p < end && *p == '}') {
+                ++p;
+                break;
+            }
+
+            const char *key = p;
+            const char *keyEnd = p < end && *p == '"' ? DxcProfile_SkipValue(p, end) : NULL;
+            const char *value = keyEnd ? DxcProfile_SkipSpace(keyEnd, end) : NULL;
+            if (!value || value >= end || *value != ':') {
+                fputs("}", file);
+                return;
+            }
+            value = DxcProfile_SkipSpace(value + 1, end);
+            const char *valueEnd = DxcProfile_SkipValue(value, end);
+            if (!valueEnd) {
+                fputs("}", file);
+                return;
+            }
+
+            if (!firstMember) {
+                fputc(',', file);
+            }
+            firstMember = 0;
+
+            SIZE_T keyLength = (SIZE_T)(keyEnd - key);
+            if (keyLength == 4 && memcmp(key, "\"ts\"", 4) == 0) {
+                fprintf(file, "\"ts\":%.3f", baseUs + strtod(value, NULL));
+            }
+            else if (keyLength == 5 && memcmp(key, "\"pid\"", 5) == 0) {
+                fputs("\"pid\":1", file);
+            }
+            else if (keyLength == 5 && memcmp(key, "\"tid\"", 5) == 0) {
+                fprintf(file, "\"tid\":%u", threadId);
+            }
+            else {
+                fwrite(key, 1, keyLength, file);
+                fputc(':', file);
+                fwrite(value, 1, (SIZE_T)(valueEnd - value), file);
+            }
+            p = valueEnd;
+        }
+        fputc('}', file);
+    }
+}
+
+static inline int DxcProfile_CompareDuration(const void *a, const void *b) {
+    const DxcProfileCompile *x = *(const DxcProfileCompile *const*)a;
+    const DxcProfileCompile *y = *(const DxcProfileCompile *const*)b;
+    UINT64 dx = x->EndNs - x->StartNs;
+    UINT64 dy = y->EndNs - y->StartNs;
+    return dx < dy ? 1 : (dx > dy ? -1 : 0);
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline HRESULT DxcProfiler_Create(DxcProfiler **ppProfiler) {
+    if (!ppProfiler) {
+        return E_INVALIDARG;
+    }
+    *ppProfiler = (DxcProfiler*)calloc(1, sizeof(DxcProfiler));
+    if (!*ppProfiler) {
+        return E_OUTOFMEMORY;
+    }
+    pthread_mutex_init(&(*ppProfiler)->Lock, NULL);
+    (*ppProfiler)->OriginNs = DxcUtil_Now();
+    return S_OK;
+}
+
+static inline void DxcProfiler_Destroy(DxcProfiler *profiler) {
+    if (!profiler) {
+        return;
+    }
+    for (UINT32 i = 0; i < profiler->CompileCount; ++i) {
+        free(profiler->pCompiles[i].pName);
+        free(profiler->pCompiles[i].pTimeTrace);
+        free(profiler->pCompiles[i].pTimeReport);
+    }
+    for (UINT32 i = 0; i < profiler->SpanCount; ++i) {
+        free(profiler->pSpans[i].pDetail);
+    }
+    free(profiler->pCompiles);
+    free(profiler->pSpans);
+    pthread_mutex_destroy(&profiler->Lock);
+    free(profiler);
+}
+
+// Opens a compile record on the calling thread and returns its id, or
+// DXC_PROFILE_NO_COMPILE if out of memory
+static inline UINT32 DxcProfiler_BeginCompile(DxcProfiler *profiler, const char *pName) {
+    UINT32 id = DXC_PROFILE_NO_COMPILE;
+    char *name = DxcProfile_CopyString(pName ? pName : "<unnamed>", strlen(pName ? pName : "<unnamed>"));
+
+    pthread_mutex_lock(&profiler->Lock);
+    if (name && profiler->CompileCount == profiler->CompileCapacity) {
+        UINT32 capacity = profiler->CompileCapacity ? profiler->CompileCapacity * 2 : 64;
+        DxcProfileCompile *compiles = (DxcProfileCompile*)realloc(profiler->pCompiles, capacity * sizeof(DxcProfileCompile));
+        if (compiles) {
+            profiler->pCompiles = compiles;
+            profiler->CompileCapacity = capacity;
+        }
+    }
+    if (name && profiler->CompileCount < profiler->CompileCapacity) {
+        id = profiler->CompileCount++;
+        DxcProfileCompile *compile = &profiler->pCompiles[id];
+        memset(compile, 0, sizeof(DxcProfileCompile));
+        compile->pName = name;
+        compile->ThreadId = DxcProfile_GetThreadId();
+        compile->StartNs = DxcUtil_Now();
+        compile->EndNs = compile->StartNs;
+        name = NULL;
+    }
+    pthread_mutex_unlock(&profiler->Lock);
+
+    free(name);
+    DxcProfile_CurrentProfiler = profiler;
+    DxcProfile_CurrentCompile = id;
+    return id;
+}
+
+// Records a span. compileId may be DXC_PROFILE_NO_COMPILE to attribute it to
+// the compile currently open on this thread, if any. pDetail is copied.
+static inline void DxcProfiler_AddSpan(DxcProfiler *profiler, UINT32 compileId, DxcProfileCategory category, const char *pDetail,
+                                       UINT64 startNs, UINT64 endNs) {
+    if (compileId == DXC_PROFILE_NO_COMPILE && DxcProfile_CurrentProfiler == profiler) {
+        compileId = DxcProfile_CurrentCompile;
+    }
+    char *detail = pDetail ? DxcProfile_CopyString(pDetail, strlen(pDetail)) : NULL;
+
+    pthread_mutex_lock(&profiler->Lock);
+    if (profiler->SpanCount == profiler->SpanCapacity) {
+        UINT32 capacity = profiler->SpanCapacity ? profiler->SpanCapacity * 2 : 256;
+        DxcProfileSpan *spans = (DxcProfileSpan*)realloc(profiler->pSpans, capacity * sizeof(DxcProfileSpan));
+        if (spans) {
+            profiler->pSpans = spans;
+            profiler->SpanCapacity = capacity;
+        }
+    }
+    if (profiler->SpanCount < profiler->SpanCapacity) {
+        DxcProfileSpan *span = &profiler->pSpans[profiler->SpanCount++];
+        span->StartNs = startNs;
+        span->EndNs = endNs;
+        span->CompileId = compileId < profiler->CompileCount ? compileId : DXC_PROFILE_NO_COMPILE;
+        span->ThreadId = DxcProfile_GetThreadId();
+        span->Category = category;
+        span->pDetail = detail;
+        detail = NULL;
+        if (span->CompileId != DXC_PROFILE_NO_COMPILE) {
+            profiler->pCompiles[span->CompileId].CategoryNs[category] += endNs - startNs;
+        }
+    }
+    pthread_mutex_unlock(&profiler->Lock);
+
+    free(detail);
+}
+
+// Closes a compile record and copies DXC_OUT_TIME_TRACE and DXC_OUT_TIME_REPORT
+// out of pResult, which may be NULL if the compile call itself failed
+static inline void DxcProfiler_EndCompile(DxcProfiler *profiler, UINT32 compileId, IDxcResult *pResult) {
+    UINT64 endNs = DxcUtil_Now();
+    HRESULT status = E_FAIL;
+    char *trace = NULL;
+    char *report = NULL;
+    if (pResult) {
+        IDxcResult_GetStatus(pResult, &status);
+        trace = DxcProfile_CopyOutput(pResult, DXC_OUT_TIME_TRACE);
+        report = DxcProfile_CopyOutput(pResult, DXC_OUT_TIME_REPORT);
+    }
+
+    if (DxcProfile_CurrentProfiler == profiler && DxcProfile_CurrentCompile == compileId) {
+        DxcProfile_CurrentProfiler = NULL;
+        DxcProfile_CurrentCompile = DXC_PROFILE_NO_COMPILE;
+    }
+
+    pthread_mutex_lock(&profiler->Lock);
+    if (compileId < profiler->CompileCount) {
+        DxcProfileCompile *compile = &profiler->pCompiles[compileId];
+        compile->EndNs = endNs;
+        compile->Status = status;
+        compile->pTimeTrace = trace;
+        compile->pTimeReport = report;
+        trace = NULL;
+        report = NULL;
+    }
+    pthread_mutex_unlock(&profiler->Lock);
+
+    free(trace);
+    free(report);
+}
+
+// IDxcCompiler3_Compile with time report and trace enabled and recorded under pName
+static inline HRESULT DxcProfiler_Compile3(DxcProfiler *profiler, IDxcCompiler3 *pCompiler, const char *pName, const DxcBuffer *pSource,
+                                           LPCWSTR *pArguments, UINT32 argCount, IDxcIncludeHandler *pIncludeHandler, IDxcResult **ppResult) {
+    *ppResult = NULL;
+    UINT32 id = DxcProfiler_BeginCompile(profiler, pName);
+
+    UINT64 argsStart = DxcUtil_Now();
+    LPCWSTR *arguments = (LPCWSTR*)malloc((argCount + 2) * sizeof(LPCWSTR));
+    if (!arguments) {
+        DxcProfiler_EndCompile(profiler, id, NULL);
+        return E_OUTOFMEMORY;
+    }
+    memcpy(arguments, pArguments, argCount * sizeof(LPCWSTR));
+    arguments[argCount] = DXC_PROFILE_ARG_TIME_REPORT;
+    arguments[argCount + 1] = DXC_PROFILE_ARG_TIME_TRACE;
+    UINT64 compileStart = DxcUtil_Now();
+    DxcProfiler_AddSpan(profiler, id, DXC_PROFILE_ARGS, NULL, argsStart, compileStart);
+
+    HRESULT hr = IDxcCompiler3_Compile(pCompiler, pSource, arguments, argCount + 2, pIncludeHandler, &IID_IDxcResult, (void**)ppResult);
+    DxcProfiler_AddSpan(profiler, id, DXC_PROFILE_COMPILE, NULL, compileStart, DxcUtil_Now());
+    free(arguments);
+
+    DxcProfiler_EndCompile(profiler, id, SUCCEEDED(hr) ? *ppResult : NULL);
+    return hr;
+}
+
+static inline ULONG __stdcall DxcProfileIncludeHandler_AddRef(DxcProfileIncludeHandler *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcProfileIncludeHandler_Release(DxcProfileIncludeHandler *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        IDxcIncludeHandler_Release(self->pInner);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcProfileIncludeHandler_QueryInterface(DxcProfileIncludeHandler *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcIncludeHandler, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcProfileIncludeHandler_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcProfileIncludeHandler_LoadSource(DxcProfileIncludeHandler *self, LPCWSTR pFilename, IDxcBlob **ppIncludeSource) {
+    UINT64 start = DxcUtil_Now();
+    HRESULT hr = IDxcIncludeHandler_LoadSource(self->pInner, pFilename, ppIncludeSource);
+    UINT64 end = DxcUtil_Now();
+
+    char *name = NULL;
+    if (pFilename) {
+        SIZE_T length = wcslen(pFilename);
+        name = (char*)malloc(length * 4 + 1);
+        if (name) {
+            name[DxcUtf8_FromWide(pFilename, length, name)] = '\0';
+        }
+    }
+    DxcProfiler_AddSpan(self->pProfiler, DXC_PROFILE_NO_COMPILE, DXC_PROFILE_INCLUDE, name, start, end);
+    free(name);
+    return hr;
+}
+
+static void *const DxcProfileIncludeHandler_Vtbl[] = {
+    (void*)DxcProfileIncludeHandler_QueryInterface,
+    (void*)DxcProfileIncludeHandler_AddRef,
+    (void*)DxcProfileIncludeHandler_Release,
+    (void*)DxcProfileIncludeHandler_LoadSource,
+};
+
+// Wraps pInner so every include load is recorded as a DXC_PROFILE_INCLUDE span
+static inline HRESULT DxcProfiler_CreateIncludeHandler(DxcProfiler *profiler, IDxcIncludeHandler *pInner, IDxcIncludeHandler **ppHandler) {
+    if (!profiler || !pInner || !ppHandler) {
+        return E_INVALIDARG;
+    }
+
+    DxcProfileIncludeHandler *self = (DxcProfileIncludeHandler*)calloc(1, sizeof(DxcProfileIncludeHandler));
+    if (!self) {
+        *ppHandler = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    self->v = DxcProfileIncludeHandler_Vtbl;
+    atomic_init(&self->RefCount, 1);
+    self->pProfiler = profiler;
+    self->pInner = pInner;
+    IDxcIncludeHandler_AddRef(pInner);
+
+    *ppHandler = (IDxcIncludeHandler*)self;
+    return S_OK;
+}
+
+// Writes every compile, span and DXC time trace event as one Chrome trace
+static inline HRESULT DxcProfiler_WriteTrace(DxcProfiler *profiler, const char *pPath) {
+    FILE *file = fopen(pPath, "w");
+    if (!file) {
+        return E_FAIL;
+    }
+
+    pthread_mutex_lock(&profiler->Lock);
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    fputs("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"dxc\"}}", file);
+
+    for (UINT32 i = 0; i < profiler->CompileCount; ++i) {
+        const DxcProfileCompile *compile = &profiler->pCompiles[i];
+        double startUs = (double)(compile->StartNs - profiler->OriginNs) / 1000.0;
+
+        fputs(",\n{\"ph\":\"X\",\"cat\":\"shader\",\"name\":", file);
+        DxcProfile_WriteEscaped(file, compile->pName);
+        fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"status\":\"0x%08x\"",
+                compile->ThreadId, startUs, (double)(compile->EndNs - compile->StartNs) / 1000.0, (unsigned)compile->Status);
+        if (compile->pTimeReport) {
+            fputs(",\"timeReport\":", file);
+            DxcProfile_WriteEscaped(file, compile->pTimeReport);
+        }
+        fputs("}}", file);
+
+        if (compile->pTimeTrace) {
+            DxcProfile_WriteDxcEvents(file, compile->pTimeTrace, startUs, compile->ThreadId);
+        }
+    }
+
+    for (UINT32 i = 0; i < profiler->SpanCount; ++i) {
+        const DxcProfileSpan *span = &profiler->pSpans[i];
+        fprintf(file, ",\n{\"ph\":\"X\",\"cat\":\"%s\",\"name\":", DxcProfile_CategoryNames[span->Category]);
+        DxcProfile_WriteEscaped(file, span->pDetail ? span->pDetail : DxcProfile_CategoryNames[span->Category]);
+        fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", span->ThreadId,
+                (double)(span->StartNs - profiler->OriginNs) / 1000.0, (double)(span->EndNs - span->StartNs) / 1000.0);
+        if (span->CompileId != DXC_PROFILE_NO_COMPILE) {
+            fputs(",\"args\":{\"shader\":", file);
+            DxcProfile_WriteEscaped(file, profiler->pCompiles[span->CompileId].pName);
+            fputc('}', file);
+        }
+        fputc('}', file);
+    }
+
+    fputs("\n]}\n", file);
+    pthread_mutex_unlock(&profiler->Lock);
+
+    return fclose(file) == 0 ? S_OK : E_FAIL;
+}
+
+// Prints the topCount slowest compiles with their per-category breakdown
+static inline HRESULT DxcProfiler_WriteSummary(DxcProfiler *profiler, FILE *pFile, UINT32 topCount) {
+    pthread_mutex_lock(&profiler->Lock);
+
+    const DxcProfileCompile **sorted = (const DxcProfileCompile**)malloc((profiler->CompileCount + 1) * sizeof(DxcProfileCompile*));
+    if (!sorted) {
+        pthread_mutex_unlock(&profiler->Lock);
+        return E_OUTOFMEMORY;
+    }
+
+    UINT64 totalNs = 0;
+    for (UINT32 i = 0; i < profiler->CompileCount; ++i) {
+        sorted[i] = &profiler->pCompiles[i];
+        totalNs += profiler->pCompiles[i].EndNs - profiler->pCompiles[i].StartNs;
+    }
+    qsort(sorted, profiler->CompileCount, sizeof(DxcProfileCompile*), DxcProfile_CompareDuration);
+
+    fprintf(pFile, "%u compiles, %.3f ms total compile time\n", profiler->CompileCount, (double)totalNs / 1e6);
+    fprintf(pFile, "%10s %10s %10s %10s %10s %10s  %s\n", "total ms", "queue", "args", "include", "compile", "validate", "shader");
+    for (UINT32 i = 0; i < profiler->CompileCount && i < topCount; ++i) {
+        const DxcProfileCompile *compile = sorted[i];
+        fprintf(pFile, "%10.3f %10.3f %10.3f %10.3f %10.3f %10.3f  %s%s\n",
+                (double)(compile->EndNs - compile->StartNs) / 1e6,
+                (double)compile->CategoryNs[DXC_PROFILE_QUEUE] / 1e6,
+                (double)compile->CategoryNs[DXC_PROFILE_ARGS] / 1e6,
+                (double)compile->CategoryNs[DXC_PROFILE_INCLUDE] / 1e6,
+                (double)compile->CategoryNs[DXC_PROFILE_COMPILE] / 1e6,
+                (double)compile->CategoryNs[DXC_PROFILE_VALIDATE] / 1e6,
+                compile->pName, SUCCEEDED(compile->Status) ? "" : " (failed)");
+    }
+
+    pthread_mutex_unlock(&profiler->Lock);
+    free(sorted);
+    return S_OK;
+}
+
+#endif /* __DXC_PROFILE_C__ */
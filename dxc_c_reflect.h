@@ -0,0 +1,644 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_reflect.h                                                           //
+// Flat signature, binding and root signature tables for pipeline creation   //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_REFLECT_C__
+#define __DXC_REFLECT_C__
+
+#include "dxc_c.h"
+#include "dxc_c_container.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// NOTE: Decodes the parts of a DXIL container that pipeline creation needs
+// into one relocatable block of structure-of-arrays tables, without COM or
+// the DXC library. DxcReflect_Build runs once at build time, next to the
+// compile. The block contains no pointers, so it can be written to disk as is
+// and later handed to DxcReflect_Open, which only checks bounds before the
+// tables are used in place.
+//
+// Every table is a Count followed by column offsets. Each column is an array
+// of Count values starting at that byte offset from the DxcReflectTables
+// header, aligned to DXC_REFLECT_ALIGNMENT. Read columns with
+// DxcReflect_GetU32, DxcReflect_GetU8 or DxcReflect_GetF32.
+//
+// Input, output and patch constant signatures come from ISG1, OSG1 and PSG1.
+// Resource bindings come from PSV0, because STAT holds LLVM bitcode that
+// cannot be read without the DXC library; PSV0 does not record resource
+// names. The RTS0 part is decoded into parameter, range and static sampler
+// tables and is also kept verbatim for ID3D12Device::CreateRootSignature.
+
+#define DXC_REFLECT_MAGIC     DXC_FOURCC('D', 'X', 'R', 'T')
+#define DXC_REFLECT_VERSION   1
+#define DXC_REFLECT_ALIGNMENT 16
+
+#define DXC_REFLECT_SHADER_KIND_UNKNOWN 0xFFFFFFFFu
+
+// DxcReflectTables::Flags
+#define DXC_REFLECT_FLAG_HAS_BINDINGS       1 // PSV0 was present
+#define DXC_REFLECT_FLAG_HAS_ROOT_SIGNATURE 2 // RTS0 was present
+
+// --- Structs ----------------------------------------------------------------
+// Each field after Count is the offset of a column
+typedef struct DxcReflectSignatureTable {
+    UINT32 Count;
+    UINT32 SemanticName;  // UINT32, offset into the string pool, see DxcReflect_GetString
+    UINT32 SemanticIndex; // UINT32
+    UINT32 SystemValue;   // UINT32, D3D_NAME
+    UINT32 ComponentType; // UINT32, D3D_REGISTER_COMPONENT_TYPE
+    UINT32 Register;      // UINT32
+    UINT32 Stream;        // UINT32
+    UINT32 MinPrecision;  // UINT32, D3D_MIN_PRECISION
+    UINT32 Mask;          // BYTE
+    UINT32 ReadWriteMask; // BYTE, never-written components of outputs, always-read components of inputs
+} DxcReflectSignatureTable;
+
+typedef struct DxcReflectBindingTable {
+    UINT32 Count;
+    UINT32 Type;       // UINT32, PSVResourceType
+    UINT32 Space;      // UINT32
+    UINT32 LowerBound; // UINT32
+    UINT32 UpperBound; // UINT32, 0xFFFFFFFF when unbounded
+    UINT32 Kind;       // UINT32, PSVResourceKind, 0 before PSV0 recorded it
+    UINT32 Flags;      // UINT32, PSVResourceFlags, 0 before PSV0 recorded it
+} DxcReflectBindingTable;
+
+typedef struct DxcReflectRootParameterTable {
+    UINT32 Count;
+    UINT32 Type;           // UINT32, D3D12_ROOT_PARAMETER_TYPE
+    UINT32 Visibility;     // UINT32, D3D12_SHADER_VISIBILITY
+    UINT32 Register;       // UINT32, constants and root descriptors
+    UINT32 Space;          // UINT32, constants and root descriptors
+    UINT32 Num32BitValues; // UINT32, constants
+    UINT32 Flags;          // UINT32, D3D12_ROOT_DESCRIPTOR_FLAGS, 0 in version 1.0
+    UINT32 RangeStart;     // UINT32, descriptor tables, first row of DescriptorRanges
+    UINT32 RangeCount;     // UINT32, descriptor tables
+} DxcReflectRootParameterTable;
+
+typedef struct DxcReflectDescriptorRangeTable {
+    UINT32 Count;
+    UINT32 Type;           // UINT32, D3D12_DESCRIPTOR_RANGE_TYPE
+    UINT32 NumDescriptors; // UINT32
+    UINT32 BaseRegister;   // UINT32
+    UINT32 Space;          // UINT32
+    UINT32 Flags;          // UINT32, D3D12_DESCRIPTOR_RANGE_FLAGS, 0 in version 1.0
+    UINT32 TableOffset;    // UINT32, OffsetInDescriptorsFromTableStart
+} DxcReflectDescriptorRangeTable;
+
+typedef struct DxcReflectStaticSamplerTable {
+    UINT32 Count;
+    UINT32 Filter;         // UINT32, D3D12_FILTER
+    UINT32 AddressU;       // UINT32, D3D12_TEXTURE_ADDRESS_MODE
+    UINT32 AddressV;       // UINT32
+    UINT32 AddressW;       // UINT32
+    UINT32 MipLODBias;     // float
+    UINT32 MaxAnisotropy;  // UINT32
+    UINT32 ComparisonFunc; // UINT32, D3D12_COMPARISON_FUNC
+    UINT32 BorderColor;    // UINT32, D3D12_STATIC_BORDER_COLOR
+    UINT32 MinLOD;         // float
+    UINT32 MaxLOD;         // float
+    UINT32 Register;       // UINT32
+    UINT32 Space;          // UINT32
+    UINT32 Visibility;     // UINT32, D3D12_SHADER_VISIBILITY
+    UINT32 Flags;          // UINT32, D3D12_SAMPLER_FLAGS, 0 before version 1.2
+} DxcReflectStaticSamplerTable;
+
+typedef struct DxcReflectTables {
+    UINT32                         Magic;
+    UINT32                         Version;
+    UINT32                         Size;                 // Whole block, including this header
+    UINT32                         Flags;                // DXC_REFLECT_FLAG_*
+    BYTE                           ShaderHash[16];       // DXC_PART_SHADER_HASH digest, zero when absent
+    UINT32                         ShaderKind;           // DXIL shader kind or DXC_REFLECT_SHADER_KIND_UNKNOWN
+    UINT32                         NumThreads[3];        // From PSV0 for compute, mesh and amplification shaders
+    UINT32                         StringsOffset;
+    UINT32                         StringsSize;          // Including the terminating NULs
+    UINT32                         RootSignatureOffset;  // Verbatim RTS0 part
+    UINT32                         RootSignatureSize;
+    UINT32                         RootSignatureVersion; // D3D_ROOT_SIGNATURE_VERSION
+    UINT32                         RootSignatureFlags;   // D3D12_ROOT_SIGNATURE_FLAGS
+    UINT32                         Reserved[2];
+    DxcReflectSignatureTable       Inputs;
+    DxcReflectSignatureTable       Outputs;
+    DxcReflectSignatureTable       PatchConstants;
+    DxcReflectBindingTable         Bindings;
+    DxcReflectRootParameterTable   RootParameters;
+    DxcReflectDescriptorRangeTable DescriptorRanges;
+    DxcReflectStaticSamplerTable   StaticSamplers;
+} DxcReflectTables;
+
+// --- Internals --------------------------------------------------------------
+typedef struct DxcReflectLayout {
+    UINT32 TableOffset;    // Offset of the table in DxcReflectTables
+    UINT32 ColumnCount;
+    UINT32 ByteColumnMask; // Bit i set when column i holds BYTE values
+} DxcReflectLayout;
+
+#define DXC_REFLECT_COLUMN_COUNT(type) ((UINT32)(sizeof(type) / sizeof(UINT32) - 1))
+#define DXC_REFLECT_SIGNATURE_BYTE_COLUMNS ((1u << 7) | (1u << 8))
+
+enum {
+    DXC_REFLECT_TABLE_INPUTS,
+    DXC_REFLECT_TABLE_OUTPUTS,
+    DXC_REFLECT_TABLE_PATCH_CONSTANTS,
+    DXC_REFLECT_TABLE_BINDINGS,
+    DXC_REFLECT_TABLE_ROOT_PARAMETERS,
+    DXC_REFLECT_TABLE_DESCRIPTOR_RANGES,
+    DXC_REFLECT_TABLE_STATIC_SAMPLERS,
+    DXC_REFLECT_TABLE_COUNT
+};
+
+static const DxcReflectLayout DxcReflect_Layouts[DXC_REFLECT_TABLE_COUNT] = {
+    { offsetof(DxcReflectTables, Inputs), DXC_REFLECT_COLUMN_COUNT(DxcReflectSignatureTable), DXC_REFLECT_SIGNATURE_BYTE_COLUMNS },
+    { offsetof(DxcReflectTables, Outputs), DXC_REFLECT_COLUMN_COUNT(DxcReflectSignatureTable), DXC_REFLECT_SIGNATURE_BYTE_COLUMNS },
+    { offsetof(DxcReflectTables, PatchConstants), DXC_REFLECT_COLUMN_COUNT(DxcReflectSignatureTable), DXC_REFLECT_SIGNATURE_BYTE_COLUMNS },
+    { offsetof(DxcReflectTables, Bindings), DXC_REFLECT_COLUMN_COUNT(DxcReflectBindingTable), 0 },
+    { offsetof(DxcReflectTables, RootParameters), DXC_REFLECT_COLUMN_COUNT(DxcReflectRootParameterTable), 0 },
+    { offsetof(DxcReflectTables, DescriptorRanges), DXC_REFLECT_COLUMN_COUNT(DxcReflectDescriptorRangeTable), 0 },
+    { offsetof(DxcReflectTables, StaticSamplers), DXC_REFLECT_COLUMN_COUNT(DxcReflectStaticSamplerTable), 0 },
+};
+
+// Part layouts, see DxilContainer.h, DxilPipelineStateValidation.h and
+// DxilRootSignature.h
+#define DXC_REFLECT_SIGNATURE_ELEMENT_SIZE 32
+#define DXC_REFLECT_ROOT_HEADER_SIZE       24
+#define DXC_REFLECT_ROOT_PARAMETER_SIZE    12
+#define DXC_REFLECT_PSV_NUM_THREADS_OFFSET 36 // PSVRuntimeInfo2::NumThreadsX
+#define DXC_REFLECT_PSV_STAGE_OFFSET       24 // PSVRuntimeInfo1::ShaderStage
+
+#define DXC_REFLECT_ROOT_PARAMETER_DESCRIPTOR_TABLE 0
+#define DXC_REFLECT_ROOT_PARAMETER_32BIT_CONSTANTS  1
+
+// What DxcReflect_Scan found in the container
+typedef struct DxcReflectScan {
+    DxcPartView Signatures[3];
+    BOOL        HasSignature[3];
+    DxcPartView Psv;
+    BOOL        HasPsv;
+    UINT32      PsvRuntimeInfoSize;
+    UINT32      PsvBindInfoSize;
+    DxcPartView Root;
+    BOOL        HasRoot;
+    UINT32      Counts[DXC_REFLECT_TABLE_COUNT];
+    UINT64      StringsSize;
+} DxcReflectScan;
+
+static inline UINT64 DxcReflect_Align(UINT64 value) {
+    return (value + DXC_REFLECT_ALIGNMENT - 1) & ~(UINT64)(DXC_REFLECT_ALIGNMENT - 1);
+}
+
+static inline UINT32 *DxcReflect_Table(DxcReflectTables *tables, UINT32 table) {
+    return (UINT32*)((BYTE*)tables + DxcReflect_Layouts[table].TableOffset);
+}
+
+static inline const UINT32 *DxcReflect_ReadTable(const DxcReflectTables *tables, UINT32 table) {
+    return (const UINT32*)((const BYTE*)tables + DxcReflect_Layouts[table].TableOffset);
+}
+
+static inline UINT64 DxcReflect_ColumnSize(UINT32 table, UINT32 column, UINT32 count) {
+    return (UINT64)count * ((DxcReflect_Layouts[table].ByteColumnMask >> column & 1) ? 1 : sizeof(UINT32));
+}
+
+static inline UINT32 *DxcReflect_WriteU32(DxcReflectTables *tables, UINT32 column) { return (UINT32*)((BYTE*)tables + column); }
+static inline BYTE   *DxcReflect_WriteU8(DxcReflectTables *tables, UINT32 column)  { return (BYTE*)tables + column; }
+
+// Validates a signature part and counts its elements and name bytes
+static inline BOOL DxcReflect_ScanSignature(const DxcPartView *pPart, UINT32 *pCount, UINT64 *pStringsSize) {
+    const BYTE *data = (const BYTE*)pPart->pData;
+    if (pPart->Size < 8) {
+        return 0;
+    }
+
+    UINT32 count = DxcContainer_ReadU32(data);
+    UINT64 offset = DxcContainer_ReadU32(data + 4);
+    if (offset + (UINT64)count * DXC_REFLECT_SIGNATURE_ELEMENT_SIZE > pPart->Size) {
+        return 0;
+    }
+
+    for (UINT32 i = 0; i < count; ++i) {
+        UINT32 name = DxcContainer_ReadU32(data + offset + i * DXC_REFLECT_SIGNATURE_ELEMENT_SIZE + 4);
+        const BYTE *end = name < pPart->Size ? (const BYTE*)memchr(data + name, 0, pPart->Size - name) : NULL;
+        if (!end) {
+            return 0;
+        }
+        // Elements may share one name, so the total can exceed the part size
+        *pStringsSize += (UINT64)(end - (data + name)) + 1;
+        if (*pStringsSize > UINT32_MAX) {
+            return 0;
+        }
+    }
+
+    *pCount = count;
+    return 1;
+}
+
+static inline BOOL DxcReflect_ScanPsv(DxcReflectScan *scan) {
+    const BYTE *data = (const BYTE*)scan->Psv.pData;
+    UINT32 size = scan->Psv.Size;
+    if (size < 4) {
+        return 0;
+    }
+
+    UINT64 offset = 4 + (UINT64)DxcContainer_ReadU32(data);
+    if (offset + 4 > size) {
+        return 0;
+    }
+    scan->PsvRuntimeInfoSize = (UINT32)offset - 4;
+
+    UINT32 count = DxcContainer_ReadU32(data + offset);
+    offset += 4;
+    if (count) {
+        if (offset + 4 > size) {
+            return 0;
+        }
+        scan->PsvBindInfoSize = DxcContainer_ReadU32(data + offset);
+        offset += 4;
+        if (scan->PsvBindInfoSize < 16 || offset + (UINT64)count * scan->PsvBindInfoSize > size) {
+            return 0;
+        }
+    }
+
+    scan->Counts[DXC_REFLECT_TABLE_BINDINGS] = count;
+    return 1;
+}
+
+static inline UINT32 DxcReflect_RootRangeSize(UINT32 version)      { return version == 1 ? 20 : 24; }
+static inline UINT32 DxcReflect_RootDescriptorSize(UINT32 version) { return version == 1 ? 8 : 12; }
+static inline UINT32 DxcReflect_RootSamplerSize(UINT32 version)    { return version >= 3 ? 56 : 52; }
+
+static inline BOOL DxcReflect_ScanRoot(DxcReflectScan *scan) {
+    const BYTE *data = (const BYTE*)scan->Root.pData;
+    UINT32 size = scan->Root.Size;
+    if (size < DXC_REFLECT_ROOT_HEADER_SIZE) {
+        return 0;
+    }
+
+    UINT32 version = DxcContainer_ReadU32(data);
+    UINT32 parameterCount = DxcContainer_ReadU32(data + 4);
+    UINT64 parameterOffset = DxcContainer_ReadU32(data + 8);
+    UINT32 samplerCount = DxcContainer_ReadU32(data + 12);
+    UINT64 samplerOffset = DxcContainer_ReadU32(data + 16);
+    if (version < 1 || version > 3 ||
+        parameterOffset + (UINT64)parameterCount * DXC_REFLECT_ROOT_PARAMETER_SIZE > size ||
+        samplerOffset + (UINT64)samplerCount * DxcReflect_RootSamplerSize(version) > size) {
+        return 0;
+    }
+
+    UINT32 rangeCount = 0;
+    for (UINT32 i = 0; i < parameterCount; ++i) {
+        const BYTE *parameter = data + parameterOffset + i * DXC_REFLECT_ROOT_PARAMETER_SIZE;
+        UINT32 type = DxcContainer_ReadU32(parameter);
+        UINT64 payload = DxcContainer_ReadU32(parameter + 8);
+        if (type == DXC_REFLECT_ROOT_PARAMETER_DESCRIPTOR_TABLE) {
+            if (payload + 8 > size) {
+                return 0;
+            }
+            UINT32 ranges = DxcContainer_ReadU32(data + payload);
+            UINT64 rangeOffset = DxcContainer_ReadU32(data + payload + 4);
+            if (rangeOffset + (UINT64)ranges * DxcReflect_RootRangeSize(version) > size || rangeCount + (UINT64)ranges > UINT32_MAX) {
+                return 0;
+            }
+            rangeCount += ranges;
+        } else if (type == DXC_REFLECT_ROOT_PARAMETER_32BIT_CONSTANTS) {
+            if (payload + 12 > size) {
+                return 0;
+            }
+        } else if (payload + DxcReflect_RootDescriptorSize(version) > size) {
+            return 0;
+        }
+    }
+
+    scan->Counts[DXC_REFLECT_TABLE_ROOT_PARAMETERS] = parameterCount;
+    scan->Counts[DXC_REFLECT_TABLE_DESCRIPTOR_RANGES] = rangeCount;
+    scan->Counts[DXC_REFLECT_TABLE_STATIC_SAMPLERS] = samplerCount;
+    return 1;
+}
+
+static inline UINT64 DxcReflect_ComputeSize(const DxcReflectScan *scan) {
+    UINT64 size = DxcReflect_Align(sizeof(DxcReflectTables));
+    for (UINT32 table = 0; table < DXC_REFLECT_TABLE_COUNT; ++table) {
+        for (UINT32 column = 0; column < DxcReflect_Layouts[table].ColumnCount; ++column) {
+            size += DxcReflect_Align(DxcReflect_ColumnSize(table, column, scan->Counts[table]));
+        }
+    }
+    size += DxcReflect_Align(scan->StringsSize);
+    size += DxcReflect_Align(scan->HasRoot ? scan->Root.Size : 0);
+    return size;
+}
+
+static inline HRESULT DxcReflect_Scan(const DxcContainerView *pView, DxcReflectScan *scan) {
+    static const UINT32 signatureParts[3] = {
+        DXC_PART_INPUT_SIGNATURE, DXC_PART_OUTPUT_SIGNATURE, DXC_PART_PATCH_CONSTANT_SIGNATURE
+    };
+
+    memset(scan, 0, sizeof(*scan));
+    for (UINT32 i = 0; i < 3; ++i) {
+        scan->HasSignature[i] = DxcContainer_FindPart(pView, signatureParts[i], &scan->Signatures[i]);
+        if (scan->HasSignature[i] &&
+            !DxcReflect_ScanSignature(&scan->Signatures[i], &scan->Counts[DXC_REFLECT_TABLE_INPUTS + i], &scan->StringsSize)) {
+            return E_INVALIDARG;
+        }
+    }
+
+    scan->HasPsv = DxcContainer_FindPart(pView, DXC_PART_PIPELINE_STATE_VALIDATION, &scan->Psv);
+    if (scan->HasPsv && !DxcReflect_ScanPsv(scan)) {
+        return E_INVALIDARG;
+    }
+
+    scan->HasRoot = DxcContainer_FindPart(pView, DXC_PART_ROOT_SIGNATURE, &scan->Root);
+    if (scan->HasRoot && !DxcReflect_ScanRoot(scan)) {
+        return E_INVALIDARG;
+    }
+
+    // Parameters may share one range list, so the block can outgrow the part
+    if (DxcReflect_ComputeSize(scan) > UINT32_MAX) {
+        return E_INVALIDARG;
+    }
+    return S_OK;
+}
+
+static inline void DxcReflect_FillSignature(DxcReflectTables *tables, UINT32 table, const DxcPartView *pPart, UINT32 *pStringsUsed) {
+    const DxcReflectSignatureTable *columns = (const DxcReflectSignatureTable*)DxcReflect_Table(tables, table);
+    const BYTE *data = (const BYTE*)pPart->pData;
+    const BYTE *elements = data + DxcContainer_ReadU32(data + 4);
+    char *strings = (char*)tables + tables->StringsOffset;
+
+    for (UINT32 i = 0; i < columns->Count; ++i) {
+        const BYTE *element = elements + i * DXC_REFLECT_SIGNATURE_ELEMENT_SIZE;
+        const char *name = (const char*)data + DxcContainer_ReadU32(element + 4);
+        SIZE_T length = strlen(name) + 1;
+
+        memcpy(strings + *pStringsUsed, name, length);
+        DxcReflect_WriteU32(tables, columns->SemanticName)[i] = *pStringsUsed;
+        *pStringsUsed += (UINT32)length;
+
+        DxcReflect_WriteU32(tables, columns->Stream)[i] = DxcContainer_ReadU32(element);
+        DxcReflect_WriteU32(tables, columns->SemanticIndex)[i] = DxcContainer_ReadU32(element + 8);
+        DxcReflect_WriteU32(tables, columns->SystemValue)[i] = DxcContainer_ReadU32(element + 12);
+        DxcReflect_WriteU32(tables, columns->ComponentType)[i] = DxcContainer_ReadU32(element + 16);
+        DxcReflect_WriteU32(tables, columns->Register)[i] = DxcContainer_ReadU32(element + 20);
+        DxcReflect_WriteU8(tables, columns->Mask)[i] = element[24];
+        DxcReflect_WriteU8(tables, columns->ReadWriteMask)[i] = element[25];
+        DxcReflect_WriteU32(tables, columns->MinPrecision)[i] = DxcContainer_ReadU32(element + 28);
+    }
+}
+
+static inline void DxcReflect_FillBindings(DxcReflectTables *tables, const DxcReflectScan *scan) {
+    const DxcReflectBindingTable *columns = &tables->Bindings;
+    const BYTE *records = (const BYTE*)scan->Psv.pData + 4 + scan->PsvRuntimeInfoSize + 8;
+
+    for (UINT32 i = 0; i < columns->Count; ++i) {
+        const BYTE *record = records + i * scan->PsvBindInfoSize;
+        BOOL hasKind = scan->PsvBindInfoSize >= 24;
+        DxcReflect_WriteU32(tables, columns->Type)[i] = DxcContainer_ReadU32(record);
+        DxcReflect_WriteU32(tables, columns->Space)[i] = DxcContainer_ReadU32(record + 4);
+        DxcReflect_WriteU32(tables, columns->LowerBound)[i] = DxcContainer_ReadU32(record + 8);
+        DxcReflect_WriteU32(tables, columns->UpperBound)[i] = DxcContainer_ReadU32(record + 12);
+        DxcReflect_WriteU32(tables, columns->Kind)[i] = hasKind ? DxcContainer_ReadU32(record + 16) : 0;
+        DxcReflect_WriteU32(tables, columns->Flags)[i] = hasKind ? DxcContainer_ReadU32(record + 20) : 0;
+    }
+
+    if (scan->PsvRuntimeInfoSize >= DXC_REFLECT_PSV_NUM_THREADS_OFFSET + 12) {
+        const BYTE *info = (const BYTE*)scan->Psv.pData + 4;
+        for (UINT32 i = 0; i < 3; ++i) {
+            tables->NumThreads[i] = DxcContainer_ReadU32(info + DXC_REFLECT_PSV_NUM_THREADS_OFFSET + i * 4);
+        }
+    }
+    if (tables->ShaderKind == DXC_REFLECT_SHADER_KIND_UNKNOWN && scan->PsvRuntimeInfoSize > DXC_REFLECT_PSV_STAGE_OFFSET) {
+        tables->ShaderKind = ((const BYTE*)scan->Psv.pData)[4 + DXC_REFLECT_PSV_STAGE_OFFSET];
+    }
+}
+
+static inline void DxcReflect_FillRoot(DxcReflectTables *tables, const DxcReflectScan *scan) {
+    const BYTE *data = (const BYTE*)scan->Root.pData;
+    UINT32 version = DxcContainer_ReadU32(data);
+    const BYTE *parameters = data + DxcContainer_ReadU32(data + 8);
+    const BYTE *samplers = data + DxcContainer_ReadU32(data + 16);
+    const DxcReflectRootParameterTable *params = &tables->RootParameters;
+    const DxcReflectDescriptorRangeTable *ranges = &tables->DescriptorRanges;
+    const DxcReflectStaticSamplerTable *statics = &tables->StaticSamplers;
+
+    memcpy((BYTE*)tables + tables->RootSignatureOffset, data, scan->Root.Size);
+    tables->RootSignatureSize = scan->Root.Size;
+    tables->RootSignatureVersion = version;
+    tables->RootSignatureFlags = DxcContainer_ReadU32(data + 20);
+
+    UINT32 rangeRow = 0;
+    for (UINT32 i = 0; i < params->Count; ++i) {
+        const BYTE *parameter = parameters + i * DXC_REFLECT_ROOT_PARAMETER_SIZE;
+        const BYTE *payload = data + DxcContainer_ReadU32(parameter + 8);
+        UINT32 type = DxcContainer_ReadU32(parameter);
+        UINT32 reg = 0, space = 0, values = 0, flags = 0, rangeStart = rangeRow, rangeCount = 0;
+
+        if (type == DXC_REFLECT_ROOT_PARAMETER_DESCRIPTOR_TABLE) {
+            const BYTE *range = data + DxcContainer_ReadU32(payload + 4);
+            BOOL hasFlags = version != 1;
+            rangeCount = DxcContainer_ReadU32(payload);
+            for (UINT32 r = 0; r < rangeCount; ++r, ++rangeRow, range += DxcReflect_RootRangeSize(version)) {
+                DxcReflect_WriteU32(tables, ranges->Type)[rangeRow] = DxcContainer_ReadU32(range);
+                DxcReflect_WriteU32(tables, ranges->NumDescriptors)[rangeRow] = DxcContainer_ReadU32(range + 4);
+                DxcReflect_WriteU32(tables, ranges->BaseRegister)[rangeRow] = DxcContainer_ReadU32(range + 8);
+                DxcReflect_WriteU32(tables, ranges->Space)[rangeRow] = DxcContainer_ReadU32(range + 12);
+                DxcReflect_WriteU32(tables, ranges->Flags)[rangeRow] = hasFlags ? DxcContainer_ReadU32(range + 16) : 0;
+                DxcReflect_WriteU32(tables, ranges->TableOffset)[rangeRow] = DxcContainer_ReadU32(range + (hasFlags ? 20 : 16));
+            }
+        } else {
+            reg = DxcContainer_ReadU32(payload);
+            space = DxcContainer_ReadU32(payload + 4);
+            if (type == DXC_REFLECT_ROOT_PARAMETER_32BIT_CONSTANTS) {
+                values = DxcContainer_ReadU32(payload + 8);
+            } else if (version != 1) {
+                flags = DxcContainer_ReadU32(payload + 8);
+            }
+        }
+
+        DxcReflect_WriteU32(tables, params->Type)[i] = type;
+        DxcReflect_WriteU32(tables, params->Visibility)[i] = DxcContainer_ReadU32(parameter + 4);
+        DxcReflect_WriteU32(tables, params->Register)[i] = reg;
+        DxcReflect_WriteU32(tables, params->Space)[i] = space;
+        DxcReflect_WriteU32(tables, params->Num32BitValues)[i] = values;
+        DxcReflect_WriteU32(tables, params->Flags)[i] = flags;
+        DxcReflect_WriteU32(tables, params->RangeStart)[i] = rangeStart;
+        DxcReflect_WriteU32(tables, params->RangeCount)[i] = rangeCount;
+    }
+
+    // The sampler columns follow the field order of the serialized sampler
+    for (UINT32 i = 0; i < statics->Count; ++i) {
+        const BYTE *sampler = samplers + i * DxcReflect_RootSamplerSize(version);
+        const UINT32 *columns = DxcReflect_Table(tables, DXC_REFLECT_TABLE_STATIC_SAMPLERS) + 1;
+        for (UINT32 c = 0; c < 13; ++c) {
+            DxcReflect_WriteU32(tables, columns[c])[i] = DxcContainer_ReadU32(sampler + c * 4);
+        }
+        DxcReflect_WriteU32(tables, statics->Flags)[i] = version >= 3 ? DxcContainer_ReadU32(sampler + 52) : 0;
+    }
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline const UINT32 *DxcReflect_GetU32(const DxcReflectTables *tables, UINT32 column) { return (const UINT32*)((const BYTE*)tables + column); }
+static inline const BYTE   *DxcReflect_GetU8(const DxcReflectTables *tables, UINT32 column)  { return (const BYTE*)tables + column; }
+static inline const float  *DxcReflect_GetF32(const DxcReflectTables *tables, UINT32 column) { return (const float*)((const BYTE*)tables + column); }
+
+// Returns the number of bytes DxcReflect_Build needs for the container
+static inline HRESULT DxcReflect_GetRequiredSize(const DxcContainerView *pView, UINT32 *pSize) {
+    if (!pView || !pSize) {
+        return E_INVALIDARG;
+    }
+
+    DxcReflectScan scan;
+    HRESULT hr = DxcReflect_Scan(pView, &scan);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    UINT64 size = DxcReflect_ComputeSize(&scan);
+    if (size > UINT32_MAX) {
+        return E_INVALIDARG;
+    }
+    *pSize = (UINT32)size;
+    return S_OK;
+}
+
+// Writes the tables for the container into pMemory, which must be aligned to
+// DXC_REFLECT_ALIGNMENT. The result is usable in place, and the first
+// (*ppTables)->Size bytes can be stored and reopened with DxcReflect_Open.
+static inline HRESULT DxcReflect_Build(const DxcContainerView *pView, void *pMemory, UINT32 size, DxcReflectTables **ppTables) {
+    if (!pView || !pMemory || !ppTables || ((uintptr_t)pMemory & (DXC_REFLECT_ALIGNMENT - 1))) {
+        return E_INVALIDARG;
+    }
+
+    DxcReflectScan scan;
+    HRESULT hr = DxcReflect_Scan(pView, &scan);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    UINT64 required = DxcReflect_ComputeSize(&scan);
+    if (required > size) {
+        return E_OUTOFMEMORY;
+    }
+
+    DxcReflectTables *tables = (DxcReflectTables*)pMemory;
+    memset(tables, 0, (SIZE_T)required);
+    tables->Magic = DXC_REFLECT_MAGIC;
+    tables->Version = DXC_REFLECT_VERSION;
+    tables->Size = (UINT32)required;
+    tables->ShaderKind = DXC_REFLECT_SHADER_KIND_UNKNOWN;
+
+    UINT64 offset = DxcReflect_Align(sizeof(DxcReflectTables));
+    for (UINT32 table = 0; table < DXC_REFLECT_TABLE_COUNT; ++table) {
+        UINT32 *columns = DxcReflect_Table(tables, table);
+        columns[0] = scan.Counts[table];
+        for (UINT32 column = 0; column < DxcReflect_Layouts[table].ColumnCount; ++column) {
+            columns[1 + column] = (UINT32)offset;
+            offset += DxcReflect_Align(DxcReflect_ColumnSize(table, column, scan.Counts[table]));
+        }
+    }
+    tables->StringsOffset = (UINT32)offset;
+    tables->StringsSize = (UINT32)scan.StringsSize;
+    tables->RootSignatureOffset = (UINT32)(offset + DxcReflect_Align(scan.StringsSize));
+
+    DxcShaderHash hash;
+    DxcProgramView program;
+    if (DxcContainer_GetShaderHash(pView, &hash)) {
+        memcpy(tables->ShaderHash, hash.HashDigest, sizeof(tables->ShaderHash));
+    }
+    if (DxcContainer_GetProgram(pView, &program)) {
+        tables->ShaderKind = program.ShaderKind;
+    }
+
+    UINT32 stringsUsed = 0;
+    for (UINT32 i = 0; i < 3; ++i) {
+        if (scan.HasSignature[i]) {
+            DxcReflect_FillSignature(tables, DXC_REFLECT_TABLE_INPUTS + i, &scan.Signatures[i], &stringsUsed);
+        }
+    }
+    if (scan.HasPsv) {
+        tables->Flags |= DXC_REFLECT_FLAG_HAS_BINDINGS;
+        DxcReflect_FillBindings(tables, &scan);
+    }
+    if (scan.HasRoot) {
+        tables->Flags |= DXC_REFLECT_FLAG_HAS_ROOT_SIGNATURE;
+        DxcReflect_FillRoot(tables, &scan);
+    }
+
+    *ppTables = tables;
+    return S_OK;
+}
+
+// Checks a stored block before its tables are used in place. The cost depends
+// on the number of columns and signature elements, not on decoding anything.
+static inline HRESULT DxcReflect_Open(const void *pData, SIZE_T size, const DxcReflectTables **ppTables) {
+    if (!pData || !ppTables || ((uintptr_t)pData & (DXC_REFLECT_ALIGNMENT - 1)) || size < sizeof(DxcReflectTables)) {
+        return E_INVALIDARG;
+    }
+
+    const DxcReflectTables *tables = (const DxcReflectTables*)pData;
+    if (tables->Magic != DXC_REFLECT_MAGIC || tables->Version != DXC_REFLECT_VERSION || tables->Size > size ||
+        tables->Size < sizeof(DxcReflectTables)) {
+        return E_INVALIDARG;
+    }
+
+    for (UINT32 table = 0; table < DXC_REFLECT_TABLE_COUNT; ++table) {
+        const UINT32 *columns = DxcReflect_ReadTable(tables, table);
+        for (UINT32 column = 0; column < DxcReflect_Layouts[table].ColumnCount; ++column) {
+            UINT64 end = (UINT64)columns[1 + column] + (UINT64)DxcReflect_ColumnSize(table, column, 1) * columns[0];
+            if ((columns[1 + column] & (DXC_REFLECT_ALIGNMENT - 1)) || end > tables->Size) {
+                return E_INVALIDARG;
+            }
+        }
+    }
+
+    UINT64 stringsEnd = (UINT64)tables->StringsOffset + tables->StringsSize;
+    if (stringsEnd > tables->Size || (tables->StringsSize && ((const char*)tables)[stringsEnd - 1] != '\0') ||
+        (UINT64)tables->RootSignatureOffset + tables->RootSignatureSize > tables->Size) {
+        return E_INVALIDARG;
+    }
+
+    const DxcReflectSignatureTable *signatures[3] = { &tables->Inputs, &tables->Outputs, &tables->PatchConstants };
+    for (UINT32 i = 0; i < 3; ++i) {
+        const UINT32 *names = DxcReflect_GetU32(tables, signatures[i]->SemanticName);
+        for (UINT32 e = 0; e < signatures[i]->Count; ++e) {
+            if (names[e] >= tables->StringsSize) {
+                return E_INVALIDARG;
+            }
+        }
+    }
+
+    const UINT32 *rangeStart = DxcReflect_GetU32(tables, tables->RootParameters.RangeStart);
+    const UINT32 *rangeCount = DxcReflect_GetU32(tables, tables->RootParameters.RangeCount);
+    for (UINT32 i = 0; i < tables->RootParameters.Count; ++i) {
+        if ((UINT64)rangeStart[i] + rangeCount[i] > tables->DescriptorRanges.Count) {
+            return E_INVALIDARG;
+        }
+    }
+
+    *ppTables = tables;
+    return S_OK;
+}
+
+// Returns the NUL-terminated string at an offset taken from a SemanticName column
+static inline const char *DxcReflect_GetString(const DxcReflectTables *tables, UINT32 offset) {
+    return (const char*)tables + tables->StringsOffset + offset;
+}
+
+// Returns the serialized root signature for ID3D12Device::CreateRootSignature
+static inline BOOL DxcReflect_GetRootSignature(const DxcReflectTables *tables, const void **ppData, UINT32 *pSize) {
+    if (!(tables->Flags & DXC_REFLECT_FLAG_HAS_ROOT_SIGNATURE)) {
+        return 0;
+    }
+
+    *ppData = (const BYTE*)tables + tables->RootSignatureOffset;
+    *pSize = tables->RootSignatureSize;
+    return 1;
+}
+
+#endif /* __DXC_REFLECT_C__ */
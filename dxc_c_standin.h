@@ -0,0 +1,945 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_standin.h                                                           //
+// Stand-in DXC implementing the core COM vtables with configurable latency  //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_STANDIN_C__
+#define __DXC_STANDIN_C__
+
+#include "dxc_c.h"
+#include "dxc_c_args.h"
+#include "dxc_c_container.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+
+// NOTE: A local replacement for libdxcompiler that implements the vtables
+// COM_CALL dispatches through for IDxcCompiler3, IDxcUtils, IDxcResult,
+// IDxcIncludeHandler and the IDxcBlob family, so wrapper overhead can be
+// measured and regressions caught without a real compiler. Pass
+// DxcStandIn_CreateInstance wherever a DxcCreateInstanceProc is expected.
+//
+// Compiling burns (or, with Sleep set, sleeps for) a fixed latency plus a
+// per-KiB latency, resolves #include "..." lines through the include handler
+// and returns a well-formed container with DXC_PART_SHADER_HASH and
+// DXC_PART_DXIL parts; the DXIL part carries the source instead of bitcode.
+// Sources containing "#error" fail. DXC_ARG_DEBUG adds a DXC_OUT_PDB output.
+//
+// Defining DXC_STANDIN_EXPORT before including this header also defines
+// exported DxcCreateInstance and DxcCreateInstance2, so a translation unit
+// that does so (with INITGUID) can be built as a shared library and loaded
+// in place of libdxcompiler.so. That library takes its settings from the
+// DXC_STANDIN_COMPILE_NS, DXC_STANDIN_NS_PER_KIB and DXC_STANDIN_SLEEP
+// environment variables.
+
+#define DXC_STANDIN_E_CLASSNOTAVAILABLE ((HRESULT)0x80040111)
+
+#define DXC_STANDIN_MAX_OUTPUTS 4
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcStandInDesc {
+    UINT64 CompileNanoseconds; // Fixed latency of every IDxcCompiler3_Compile
+    UINT64 NanosecondsPerKiB;  // Added per KiB of source, includes counted
+    BOOL   Sleep;              // Sleep instead of spinning; spinning occupies a core like a real compile
+} DxcStandInDesc;
+
+typedef struct DxcStandInStats {
+    UINT64 Compiles;
+    UINT64 BlobsCreated;
+    INT64  LiveObjects; // Created and not yet released, 0 once every reference is dropped
+} DxcStandInStats;
+
+// IDxcBlobEncoding/IDxcBlobUtf8/IDxcBlobWide over owned, borrowed or moved memory
+typedef struct DxcStandInBlob {
+    void *const *v;
+    atomic_uint  RefCount;
+    const BYTE  *pData;
+    SIZE_T       Size;
+    UINT32       CodePage;
+    BOOL         KnownEncoding;
+    IDxcBlob    *pParent; // Keeps pData alive for views of another blob
+    IMalloc     *pMalloc; // Frees pData for IDxcUtils_MoveToBlob
+    BOOL         Moved;   // pData came from IDxcUtils_MoveToBlob
+    BYTE         Storage[];
+} DxcStandInBlob;
+
+typedef struct DxcStandInResult {
+    void *const  *v;
+    atomic_uint   RefCount;
+    HRESULT       Status;
+    UINT32        OutputCount;
+    DXC_OUT_KIND  Kinds[DXC_STANDIN_MAX_OUTPUTS];
+    IDxcBlob     *pBlobs[DXC_STANDIN_MAX_OUTPUTS];
+} DxcStandInResult;
+
+// Compiler, utils and include handler; none of them has state
+typedef struct DxcStandInObject {
+    void *const *v;
+    atomic_uint  RefCount;
+    const IID   *pIid;
+} DxcStandInObject;
+
+typedef struct DxcStandInState {
+    DxcStandInDesc Desc;
+    atomic_ullong  Compiles;
+    atomic_ullong  BlobsCreated;
+    atomic_llong   LiveObjects;
+} DxcStandInState;
+
+static DxcStandInState DxcStandIn_State;
+
+// --- Internals --------------------------------------------------------------
+static inline void DxcStandIn_Wait(UINT64 start, UINT64 nanoseconds) {
+    if (DxcStandIn_State.Desc.Sleep) {
+        UINT64 elapsed = DxcUtil_Now() - start;
+        if (elapsed < nanoseconds) {
+            UINT64 remaining = nanoseconds - elapsed;
+            struct timespec ts = { (time_t)(remaining / 1000000000ull), (long)(remaining % 1000000000ull) };
+            nanosleep(&ts, NULL);
+        }
+        return;
+    }
+    while (DxcUtil_Now() - start < nanoseconds) {
+    }
+}
+
+static inline BOOL DxcStandIn_IsIid(REFIID riid, const IID *pIid) { return memcmp(riid, pIid, sizeof(IID)) == 0; }
+
+// IMalloc derives from IUnknown; Free is slot 5
+static inline void DxcStandIn_MallocFree(IMalloc *pMalloc, void *pData) {
+    IDxcBlob *allocator = (IDxcBlob*)pMalloc;
+    if (pMalloc) {
+        COM_CALL(allocator, 5, void(__stdcall*)(IDxcBlob*, void*), allocator, pData);
+        COM_CALL(allocator, 2, ULONG(__stdcall*)(IDxcBlob*), allocator);
+    } else {
+        free(pData);
+    }
+}
+
+static inline const BYTE *DxcStandIn_Find(const BYTE *pData, SIZE_T size, const char *pNeedle) {
+    SIZE_T length = strlen(pNeedle);
+    for (SIZE_T i = 0; i + length <= size; ++i) {
+        if (pData[i] == (BYTE)pNeedle[0] && memcmp(pData + i, pNeedle, length) == 0) {
+            return pData + i;
+        }
+    }
+    return NULL;
+}
+
+static inline ULONG __stdcall DxcStandInBlob_AddRef(DxcStandInBlob *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcStandInBlob_Release(DxcStandInBlob *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        if (self->pParent) {
+            IDxcBlob_Release(self->pParent);
+        }
+        if (self->Moved) {
+            DxcStandIn_MallocFree(self->pMalloc, (void*)self->pData);
+        }
+        free(self);
+        atomic_fetch_sub(&DxcStandIn_State.LiveObjects, 1);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcStandInBlob_QueryInterface(DxcStandInBlob *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+
+    BOOL supported = DxcStandIn_IsIid(riid, &IID_IDxcBlob) || DxcStandIn_IsIid(riid, &DxcUtil_IID_IUnknown);
+    if (self->KnownEncoding) {
+        supported = supported || DxcStandIn_IsIid(riid, &IID_IDxcBlobEncoding);
+        supported = supported || (self->CodePage == DXC_CP_UTF8 && DxcStandIn_IsIid(riid, &IID_IDxcBlobUtf8));
+        supported = supported || (self->CodePage == DXC_CP_WIDE && DxcStandIn_IsIid(riid, &IID_IDxcBlobWide));
+    }
+    if (!supported) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+
+    DxcStandInBlob_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline LPVOID __stdcall DxcStandInBlob_GetBufferPointer(DxcStandInBlob *self) { return (LPVOID)self->pData; }
+static inline SIZE_T __stdcall DxcStandInBlob_GetBufferSize(DxcStandInBlob *self) { return self->Size; }
+
+static inline HRESULT __stdcall DxcStandInBlob_GetEncoding(DxcStandInBlob *self, BOOL *pKnown, UINT32 *pCodePage) {
+    if (!pKnown || !pCodePage) {
+        return E_POINTER;
+    }
+    *pKnown = self->KnownEncoding;
+    *pCodePage = self->CodePage;
+    return S_OK;
+}
+
+static inline LPCVOID __stdcall DxcStandInBlob_GetStringPointer(DxcStandInBlob *self) { return self->pData; }
+
+// Length in characters, excluding the null terminator DXC stores in text blobs
+static inline SIZE_T __stdcall DxcStandInBlob_GetStringLength(DxcStandInBlob *self) {
+    SIZE_T unit = self->CodePage == DXC_CP_WIDE ? sizeof(WCHAR) : 1;
+    SIZE_T length = self->Size / unit;
+    if (length > 0) {
+        const BYTE *last = self->pData + (length - 1) * unit;
+        BOOL terminated = unit == 1 ? *last == 0 : *(const WCHAR*)last == 0;
+        length -= terminated;
+    }
+    return length;
+}
+
+static void *const DxcStandInBlob_Vtbl[] = {
+    (void*)DxcStandInBlob_QueryInterface,
+    (void*)DxcStandInBlob_AddRef,
+    (void*)DxcStandInBlob_Release,
+    (void*)DxcStandInBlob_GetBufferPointer,
+    (void*)DxcStandInBlob_GetBufferSize,
+    (void*)DxcStandInBlob_GetEncoding,
+    (void*)DxcStandInBlob_GetStringPointer,
+    (void*)DxcStandInBlob_GetStringLength,
+};
+
+// Allocates a blob with storageSize bytes of inline storage; pData points at it
+static inline DxcStandInBlob *DxcStandInBlob_Alloc(SIZE_T storageSize, UINT32 codePage, BOOL knownEncoding) {
+    DxcStandInBlob *blob = (DxcStandInBlob*)calloc(1, sizeof(DxcStandInBlob) + storageSize);
+    if (!blob) {
+        return NULL;
+    }
+    blob->v = DxcStandInBlob_Vtbl;
+    blob->pData = blob->Storage;
+    blob->Size = storageSize;
+    blob->CodePage = codePage;
+    blob->KnownEncoding = knownEncoding;
+    atomic_init(&blob->RefCount, 1);
+    atomic_fetch_add(&DxcStandIn_State.BlobsCreated, 1);
+    atomic_fetch_add(&DxcStandIn_State.LiveObjects, 1);
+    return blob;
+}
+
+static inline IDxcBlob *DxcStandInBlob_Copy(const void *pData, SIZE_T size, UINT32 codePage, BOOL knownEncoding) {
+    DxcStandInBlob *blob = DxcStandInBlob_Alloc(size, codePage, knownEncoding);
+    if (blob && size) {
+        memcpy(blob->Storage, pData, size);
+    }
+    return (IDxcBlob*)blob;
+}
+
+// UTF-8 text output including its terminator, like DXC's text blobs
+static inline IDxcBlob *DxcStandInBlob_Text(const char *pText) {
+    return DxcStandInBlob_Copy(pText, strlen(pText) + 1, DXC_CP_UTF8, 1);
+}
+
+static inline IDxcBlob *DxcStandInBlob_View(const void *pData, SIZE_T size, UINT32 codePage, BOOL knownEncoding, IDxcBlob *pParent) {
+    DxcStandInBlob *blob = DxcStandInBlob_Alloc(0, codePage, knownEncoding);
+    if (!blob) {
+        return NULL;
+    }
+    blob->pData = (const BYTE*)pData;
+    blob->Size = size;
+    blob->pParent = pParent;
+    if (pParent) {
+        IDxcBlob_AddRef(pParent);
+    }
+    return (IDxcBlob*)blob;
+}
+
+static inline ULONG __stdcall DxcStandInResult_AddRef(DxcStandInResult *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcStandInResult_Release(DxcStandInResult *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        for (UINT32 i = 0; i < self->OutputCount; ++i) {
+            IDxcBlob_Release(self->pBlobs[i]);
+        }
+        free(self);
+        atomic_fetch_sub(&DxcStandIn_State.LiveObjects, 1);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcStandInResult_QueryInterface(DxcStandInResult *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (!DxcStandIn_IsIid(riid, &IID_IDxcResult) && !DxcStandIn_IsIid(riid, &IID_IDxcOperationResult) && !DxcStandIn_IsIid(riid, &DxcUtil_IID_IUnknown)) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcStandInResult_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline IDxcBlob *DxcStandInResult_Find(DxcStandInResult *self, DXC_OUT_KIND kind) {
+    for (UINT32 i = 0; i < self->OutputCount; ++i) {
+        if (self->Kinds[i] == kind) {
+            return self->pBlobs[i];
+        }
+    }
+    return NULL;
+}
+
+static inline HRESULT __stdcall DxcStandInResult_GetStatus(DxcStandInResult *self, HRESULT *pStatus) {
+    if (!pStatus) {
+        return E_INVALIDARG;
+    }
+    *pStatus = self->Status;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInResult_GetResult(DxcStandInResult *self, IDxcBlob **ppResult) {
+    if (!ppResult) {
+        return E_INVALIDARG;
+    }
+    *ppResult = self->OutputCount ? self->pBlobs[0] : NULL;
+    if (*ppResult) {
+        IDxcBlob_AddRef(*ppResult);
+    }
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInResult_GetErrorBuffer(DxcStandInResult *self, IDxcBlobEncoding **ppErrors) {
+    if (!ppErrors) {
+        return E_INVALIDARG;
+    }
+    *ppErrors = NULL;
+    IDxcBlob *errors = DxcStandInResult_Find(self, DXC_OUT_ERRORS);
+    return errors ? IDxcBlob_QueryInterface(errors, &IID_IDxcBlobEncoding, (void**)ppErrors) : S_OK;
+}
+
+static inline BOOL __stdcall DxcStandInResult_HasOutput(DxcStandInResult *self, DXC_OUT_KIND kind) {
+    return DxcStandInResult_Find(self, kind) != NULL;
+}
+
+static inline HRESULT __stdcall DxcStandInResult_GetOutput(DxcStandInResult *self, DXC_OUT_KIND kind, REFIID iid, void **ppvObject,
+                                                           IDxcBlobWide **ppOutputName) {
+    if (!ppvObject) {
+        return E_INVALIDARG;
+    }
+    *ppvObject = NULL;
+    if (ppOutputName) {
+        *ppOutputName = NULL;
+    }
+
+    IDxcBlob *blob = DxcStandInResult_Find(self, kind);
+    return blob ? IDxcBlob_QueryInterface(blob, iid, ppvObject) : E_INVALIDARG;
+}
+
+static inline UINT32 __stdcall DxcStandInResult_GetNumOutputs(DxcStandInResult *self) { return self->OutputCount; }
+
+static inline DXC_OUT_KIND __stdcall DxcStandInResult_GetOutputByIndex(DxcStandInResult *self, UINT32 index) {
+    return index < self->OutputCount ? self->Kinds[index] : DXC_OUT_NONE;
+}
+
+// The first output is the primary one
+static inline DXC_OUT_KIND __stdcall DxcStandInResult_PrimaryOutput(DxcStandInResult *self) {
+    return self->OutputCount ? self->Kinds[0] : DXC_OUT_NONE;
+}
+
+static void *const DxcStandInResult_Vtbl[] = {
+    (void*)DxcStandInResult_QueryInterface,
+    (void*)DxcStandInResult_AddRef,
+    (void*)DxcStandInResult_Release,
+    (void*)DxcStandInResult_GetStatus,
+    (void*)DxcStandInResult_GetResult,
+    (void*)DxcStandInResult_GetErrorBuffer,
+    (void*)DxcStandInResult_HasOutput,
+    (void*)DxcStandInResult_GetOutput,
+    (void*)DxcStandInResult_GetNumOutputs,
+    (void*)DxcStandInResult_GetOutputByIndex,
+    (void*)DxcStandInResult_PrimaryOutput,
+};
+
+static inline DxcStandInResult *DxcStandInResult_Create(HRESULT status) {
+    DxcStandInResult *result = (DxcStandInResult*)calloc(1, sizeof(DxcStandInResult));
+    if (!result) {
+        return NULL;
+    }
+    result->v = DxcStandInResult_Vtbl;
+    result->Status = status;
+    atomic_init(&result->RefCount, 1);
+    atomic_fetch_add(&DxcStandIn_State.LiveObjects, 1);
+    return result;
+}
+
+// Takes over the reference to pBlob; a NULL blob means allocation failed
+static inline HRESULT DxcStandInResult_Add(DxcStandInResult *result, DXC_OUT_KIND kind, IDxcBlob *pBlob) {
+    if (!pBlob) {
+        return E_OUTOFMEMORY;
+    }
+    result->Kinds[result->OutputCount] = kind;
+    result->pBlobs[result->OutputCount++] = pBlob;
+    return S_OK;
+}
+
+static inline ULONG __stdcall DxcStandInObject_AddRef(DxcStandInObject *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcStandInObject_Release(DxcStandInObject *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        free(self);
+        atomic_fetch_sub(&DxcStandIn_State.LiveObjects, 1);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcStandInObject_QueryInterface(DxcStandInObject *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (!DxcStandIn_IsIid(riid, self->pIid) && !DxcStandIn_IsIid(riid, &DxcUtil_IID_IUnknown)) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcStandInObject_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline DxcStandInObject *DxcStandInObject_Create(void *const *pVtbl, const IID *pIid) {
+    DxcStandInObject *object = (DxcStandInObject*)malloc(sizeof(DxcStandInObject));
+    if (!object) {
+        return NULL;
+    }
+    object->v = pVtbl;
+    object->pIid = pIid;
+    atomic_init(&object->RefCount, 1);
+    atomic_fetch_add(&DxcStandIn_State.LiveObjects, 1);
+    return object;
+}
+
+static inline HRESULT DxcStandIn_LoadFile(LPCWSTR pFileName, UINT32 codePage, IDxcBlob **ppBlob) {
+    SIZE_T length = wcslen(pFileName);
+    char *path = (char*)malloc(length * 4 + 1);
+    if (!path) {
+        return E_OUTOFMEMORY;
+    }
+    path[DxcUtf8_FromWide(pFileName, length, path)] = 0;
+    FILE *file = fopen(path, "rb");
+    free(path);
+    if (!file) {
+        return E_INVALIDARG;
+    }
+
+    HRESULT hr = S_OK;
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    DxcStandInBlob *blob = size >= 0 && fseek(file, 0, SEEK_SET) == 0 ? DxcStandInBlob_Alloc((SIZE_T)size, codePage ? codePage : DXC_CP_UTF8, 1) : NULL;
+    if (!blob) {
+        hr = size >= 0 ? E_OUTOFMEMORY : E_FAIL;
+    } else if (fread(blob->Storage, 1, (SIZE_T)size, file) != (SIZE_T)size) {
+        DxcStandInBlob_Release(blob);
+        hr = E_FAIL;
+    }
+    fclose(file);
+
+    *ppBlob = SUCCEEDED(hr) ? (IDxcBlob*)blob : NULL;
+    return hr;
+}
+
+static inline HRESULT __stdcall DxcStandInInclude_LoadSource(DxcStandInObject *self, LPCWSTR pFilename, IDxcBlob **ppIncludeSource) {
+    (void)self;
+    if (!pFilename || !ppIncludeSource) {
+        return E_INVALIDARG;
+    }
+    return DxcStandIn_LoadFile(pFilename, 0, ppIncludeSource);
+}
+
+static void *const DxcStandInInclude_Vtbl[] = {
+    (void*)DxcStandInObject_QueryInterface,
+    (void*)DxcStandInObject_AddRef,
+    (void*)DxcStandInObject_Release,
+    (void*)DxcStandInInclude_LoadSource,
+};
+
+// DXIL shader kind from the -T profile prefix
+static inline UINT32 DxcStandIn_ShaderKind(LPCWSTR pProfile) {
+    static const struct { const wchar_t *pPrefix; UINT32 Kind; } kinds[] = {
+        { L"ps_", 0 }, { L"vs_", 1 }, { L"gs_", 2 }, { L"hs_", 3 }, { L"ds_", 4 },
+        { L"cs_", 5 }, { L"lib_", 6 }, { L"ms_", 13 }, { L"as_", 14 },
+    };
+    for (UINT32 i = 0; pProfile && i < sizeof(kinds) / sizeof(kinds[0]); ++i) {
+        if (wcsncmp(pProfile, kinds[i].pPrefix, wcslen(kinds[i].pPrefix)) == 0) {
+            return kinds[i].Kind;
+        }
+    }
+    return 0;
+}
+
+// Container bytes around the source in DxcStandIn_BuildContainer, plus bitcode padding
+#define DXC_STANDIN_CONTAINER_OVERHEAD \
+    (sizeof(DxcContainerHeader) + 2 * sizeof(UINT32) + 2 * sizeof(DxcPartHeader) + sizeof(DxcShaderHash) + sizeof(DxcProgramHeader) + 3)
+
+// A container with DXC_PART_SHADER_HASH and a DXC_PART_DXIL part whose
+// "bitcode" is the source, so dxc_c_container.h can walk it. The caller
+// keeps sourceSize + DXC_STANDIN_CONTAINER_OVERHEAD within UINT32_MAX.
+static inline IDxcBlob *DxcStandIn_BuildContainer(const DxcShaderHash *pHash, UINT32 shaderKind, const void *pSource, UINT32 sourceSize) {
+    UINT32 bitcodeSize = (sourceSize + 3) & ~3u;
+    UINT32 hashOffset = (UINT32)(sizeof(DxcContainerHeader) + 2 * sizeof(UINT32));
+    UINT32 dxilOffset = (UINT32)(hashOffset + sizeof(DxcPartHeader) + sizeof(DxcShaderHash));
+    UINT32 dxilSize = (UINT32)(sizeof(DxcProgramHeader) + bitcodeSize);
+    UINT32 size = (UINT32)(dxilOffset + sizeof(DxcPartHeader) + dxilSize);
+
+    DxcStandInBlob *blob = DxcStandInBlob_Alloc(size, DXC_CP_ACP, 0);
+    if (!blob) {
+        return NULL;
+    }
+
+    BYTE *data = blob->Storage;
+    DxcContainerHeader header = { DXC_CONTAINER_FOURCC, { 0 }, 1, 0, size, 2 };
+    UINT32 offsets[2] = { hashOffset, dxilOffset };
+    DxcPartHeader hashPart = { DXC_PART_SHADER_HASH, sizeof(DxcShaderHash) };
+    DxcPartHeader dxilPart = { DXC_PART_DXIL, dxilSize };
+    DxcProgramHeader program = { shaderKind << 16 | 6 << 4, dxilSize / 4, DXC_DXIL_MAGIC, 0x108,
+                                 sizeof(DxcProgramHeader) - offsetof(DxcProgramHeader, DxilMagic), sourceSize };
+
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), offsets, sizeof(offsets));
+    memcpy(data + hashOffset, &hashPart, sizeof(hashPart));
+    memcpy(data + hashOffset + sizeof(hashPart), pHash, sizeof(DxcShaderHash));
+    memcpy(data + dxilOffset, &dxilPart, sizeof(dxilPart));
+    memcpy(data + dxilOffset + sizeof(dxilPart), &program, sizeof(program));
+    memcpy(data + dxilOffset + sizeof(dxilPart) + sizeof(program), pSource, sourceSize);
+    return (IDxcBlob*)blob;
+}
+
+// Hashes every #include "..." target loaded through the handler. Fails with a
+// message in pError when one cannot be loaded.
+static inline BOOL DxcStandIn_ResolveIncludes(const BYTE *pSource, SIZE_T size, IDxcIncludeHandler *pIncludeHandler, DxcHasher *hasher,
+                                              UINT64 *pTotalSize, char *pError, SIZE_T errorSize) {
+    static const char directive[] = "#include \"";
+    const BYTE *cursor = pSource;
+    const BYTE *end = pSource + size;
+    const BYTE *match;
+
+    while ((match = DxcStandIn_Find(cursor, (SIZE_T)(end - cursor), directive)) != NULL) {
+        const BYTE *name = match + sizeof(directive) - 1;
+        const BYTE *close = (const BYTE*)memchr(name, '"', (SIZE_T)(end - name));
+        if (!close) {
+            break;
+        }
+        cursor = close + 1;
+
+        wchar_t path[1024];
+        SIZE_T length = (SIZE_T)(close - name) < 1023 ? (SIZE_T)(close - name) : 1023;
+        path[DxcUtf8_ToWide((const char*)name, length, path)] = 0;
+
+        IDxcBlob *include = NULL;
+        if (!pIncludeHandler || FAILED(IDxcIncludeHandler_LoadSource(pIncludeHandler, path, &include)) || !include) {
+            snprintf(pError, errorSize, "stand-in: cannot open include file '%.*s'\n", (int)length, (const char*)name);
+            return 0;
+        }
+        DxcHasher_Update(hasher, IDxcBlob_GetBufferPointer(include), IDxcBlob_GetBufferSize(include));
+        *pTotalSize += IDxcBlob_GetBufferSize(include);
+        IDxcBlob_Release(include);
+    }
+    return 1;
+}
+
+static inline HRESULT __stdcall DxcStandInCompiler_Compile(DxcStandInObject *self, const DxcBuffer *pSource, LPCWSTR *pArguments, UINT32 argCount,
+                                                           IDxcIncludeHandler *pIncludeHandler, REFIID riid, void **ppResult) {
+    (void)self;
+    if (!pSource || (!pSource->Ptr && pSource->Size) || (argCount && !pArguments) || !ppResult) {
+        return E_INVALIDARG;
+    }
+    *ppResult = NULL;
+    // The container header records its size in 32 bits
+    if (pSource->Size > UINT32_MAX - DXC_STANDIN_CONTAINER_OVERHEAD) {
+        return E_INVALIDARG;
+    }
+    if (!DxcStandIn_IsIid(riid, &IID_IDxcResult) && !DxcStandIn_IsIid(riid, &IID_IDxcOperationResult)) {
+        return E_NOINTERFACE;
+    }
+
+    UINT64 start = DxcUtil_Now();
+    atomic_fetch_add(&DxcStandIn_State.Compiles, 1);
+
+    const BYTE *source = (const BYTE*)pSource->Ptr;
+    DxcHasher hasher;
+    DxcHasher_Init(&hasher, 0);
+    DxcHasher_UpdateField(&hasher, source, pSource->Size);
+
+    BOOL debug = 0;
+    LPCWSTR profile = NULL;
+    for (UINT32 i = 0; i < argCount; ++i) {
+        DxcHasher_UpdateWide(&hasher, pArguments[i]);
+        debug = debug || wcscmp(pArguments[i], DXC_ARG_DEBUG) == 0;
+        if (wcscmp(pArguments[i], L"-T") == 0 && i + 1 < argCount) {
+            profile = pArguments[i + 1];
+        }
+    }
+
+    char error[1200] = { 0 };
+    UINT64 totalSize = pSource->Size;
+    BOOL ok = DxcStandIn_ResolveIncludes(source, pSource->Size, pIncludeHandler, &hasher, &totalSize, error, sizeof(error));
+    if (ok && DxcStandIn_Find(source, pSource->Size, "#error")) {
+        snprintf(error, sizeof(error), "stand-in: #error directive\n");
+        ok = 0;
+    }
+
+    DxcStandIn_Wait(start, DxcStandIn_State.Desc.CompileNanoseconds + DxcStandIn_State.Desc.NanosecondsPerKiB * totalSize / 1024);
+
+    DxcStandInResult *result = DxcStandInResult_Create(ok ? S_OK : E_FAIL);
+    if (!result) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = S_OK;
+    if (ok) {
+        DxcHash digest = DxcHasher_Final(&hasher);
+        DxcShaderHash hash = { 0, { 0 } };
+        memcpy(hash.HashDigest, digest.Digest, sizeof(hash.HashDigest));
+
+        hr = DxcStandInResult_Add(result, DXC_OUT_OBJECT,
+                                  DxcStandIn_BuildContainer(&hash, DxcStandIn_ShaderKind(profile), source, (UINT32)pSource->Size));
+        if (SUCCEEDED(hr)) { hr = DxcStandInResult_Add(result, DXC_OUT_ERRORS, DxcStandInBlob_Text("")); }
+        if (SUCCEEDED(hr)) { hr = DxcStandInResult_Add(result, DXC_OUT_SHADER_HASH, DxcStandInBlob_Copy(&hash, sizeof(hash), DXC_CP_ACP, 0)); }
+        if (SUCCEEDED(hr) && debug) { hr = DxcStandInResult_Add(result, DXC_OUT_PDB, DxcStandInBlob_Copy(source, pSource->Size, DXC_CP_ACP, 0)); }
+    } else {
+        hr = DxcStandInResult_Add(result, DXC_OUT_ERRORS, DxcStandInBlob_Text(error));
+    }
+
+    if (FAILED(hr)) {
+        DxcStandInResult_Release(result);
+        return hr;
+    }
+    *ppResult = result;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInCompiler_Disassemble(DxcStandInObject *self, const DxcBuffer *pObject, REFIID riid, void **ppResult) {
+    (void)self;
+    if (!pObject || !ppResult) {
+        return E_INVALIDARG;
+    }
+    *ppResult = NULL;
+    if (!DxcStandIn_IsIid(riid, &IID_IDxcResult) && !DxcStandIn_IsIid(riid, &IID_IDxcOperationResult)) {
+        return E_NOINTERFACE;
+    }
+
+    char text[96];
+    snprintf(text, sizeof(text), "; stand-in disassembly of %llu bytes\n", (unsigned long long)pObject->Size);
+    DxcStandInResult *result = DxcStandInResult_Create(S_OK);
+    HRESULT hr = result ? DxcStandInResult_Add(result, DXC_OUT_DISASSEMBLY, DxcStandInBlob_Text(text)) : E_OUTOFMEMORY;
+    if (FAILED(hr)) {
+        if (result) {
+            DxcStandInResult_Release(result);
+        }
+        return hr;
+    }
+    *ppResult = result;
+    return S_OK;
+}
+
+static void *const DxcStandInCompiler_Vtbl[] = {
+    (void*)DxcStandInObject_QueryInterface,
+    (void*)DxcStandInObject_AddRef,
+    (void*)DxcStandInObject_Release,
+    (void*)DxcStandInCompiler_Compile,
+    (void*)DxcStandInCompiler_Disassemble,
+};
+
+static inline HRESULT __stdcall DxcStandInUtils_CreateBlobFromBlob(DxcStandInObject *self, IDxcBlob *pBlob, UINT32 offset, UINT32 length,
+                                                                   IDxcBlob **ppResult) {
+    (void)self;
+    if (!pBlob || !ppResult || (UINT64)offset + length > IDxcBlob_GetBufferSize(pBlob)) {
+        return E_INVALIDARG;
+    }
+    *ppResult = DxcStandInBlob_View((const BYTE*)IDxcBlob_GetBufferPointer(pBlob) + offset, length, DXC_CP_ACP, 0, pBlob);
+    return *ppResult ? S_OK : E_OUTOFMEMORY;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_CreateBlobFromPinned(DxcStandInObject *self, LPCVOID pData, UINT32 size, UINT32 codePage,
+                                                                     IDxcBlobEncoding **ppBlobEncoding) {
+    (void)self;
+    if ((!pData && size) || !ppBlobEncoding) {
+        return E_INVALIDARG;
+    }
+    *ppBlobEncoding = (IDxcBlobEncoding*)DxcStandInBlob_View(pData, size, codePage, codePage != DXC_CP_ACP, NULL);
+    return *ppBlobEncoding ? S_OK : E_OUTOFMEMORY;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_MoveToBlob(DxcStandInObject *self, LPCVOID pData, IMalloc *pIMalloc, UINT32 size, UINT32 codePage,
+                                                           IDxcBlobEncoding **ppBlobEncoding) {
+    (void)self;
+    if ((!pData && size) || !ppBlobEncoding) {
+        return E_INVALIDARG;
+    }
+
+    DxcStandInBlob *blob = (DxcStandInBlob*)DxcStandInBlob_View(pData, size, codePage, codePage != DXC_CP_ACP, NULL);
+    if (!blob) {
+        return E_OUTOFMEMORY;
+    }
+    blob->Moved = 1;
+    blob->pMalloc = pIMalloc;
+    if (pIMalloc) {
+        IDxcBlob *allocator = (IDxcBlob*)pIMalloc;
+        COM_CALL(allocator, 1, ULONG(__stdcall*)(IDxcBlob*), allocator);
+    }
+    *ppBlobEncoding = (IDxcBlobEncoding*)blob;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_CreateBlob(DxcStandInObject *self, LPCVOID pData, UINT32 size, UINT32 codePage,
+                                                           IDxcBlobEncoding **ppBlobEncoding) {
+    (void)self;
+    if ((!pData && size) || !ppBlobEncoding) {
+        return E_INVALIDARG;
+    }
+    *ppBlobEncoding = (IDxcBlobEncoding*)DxcStandInBlob_Copy(pData, size, codePage, codePage != DXC_CP_ACP);
+    return *ppBlobEncoding ? S_OK : E_OUTOFMEMORY;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_LoadFile(DxcStandInObject *self, LPCWSTR pFileName, UINT32 *pCodePage, IDxcBlobEncoding **ppBlobEncoding) {
+    (void)self;
+    if (!pFileName || !ppBlobEncoding) {
+        return E_INVALIDARG;
+    }
+    return DxcStandIn_LoadFile(pFileName, pCodePage ? *pCodePage : 0, (IDxcBlob**)ppBlobEncoding);
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_CreateReadOnlyStreamFromBlob(DxcStandInObject *self, IDxcBlob *pBlob, IStream **ppStream) {
+    (void)self; (void)pBlob;
+    if (ppStream) {
+        *ppStream = NULL;
+    }
+    return E_NOTIMPL;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_CreateDefaultIncludeHandler(DxcStandInObject *self, IDxcIncludeHandler **ppResult) {
+    (void)self;
+    if (!ppResult) {
+        return E_INVALIDARG;
+    }
+    *ppResult = (IDxcIncludeHandler*)DxcStandInObject_Create(DxcStandInInclude_Vtbl, &IID_IDxcIncludeHandler);
+    return *ppResult ? S_OK : E_OUTOFMEMORY;
+}
+
+static inline UINT32 DxcStandIn_GetCodePage(IDxcBlob *pBlob, BOOL *pKnown) {
+    IDxcBlobEncoding *encoding = NULL;
+    UINT32 codePage = DXC_CP_ACP;
+    *pKnown = 0;
+    if (SUCCEEDED(IDxcBlob_QueryInterface(pBlob, &IID_IDxcBlobEncoding, (void**)&encoding))) {
+        IDxcBlobEncoding_GetEncoding(encoding, pKnown, &codePage);
+        IDxcBlobEncoding_Release(encoding);
+    }
+    return *pKnown ? codePage : DXC_CP_ACP;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_GetBlobAsUtf8(DxcStandInObject *self, IDxcBlob *pBlob, IDxcBlobUtf8 **ppBlobEncoding) {
+    (void)self;
+    if (!pBlob || !ppBlobEncoding) {
+        return E_INVALIDARG;
+    }
+
+    BOOL known;
+    const void *data = IDxcBlob_GetBufferPointer(pBlob);
+    SIZE_T size = IDxcBlob_GetBufferSize(pBlob);
+    if (DxcStandIn_GetCodePage(pBlob, &known) != DXC_CP_WIDE) {
+        *ppBlobEncoding = (IDxcBlobUtf8*)DxcStandInBlob_View(data, size, DXC_CP_UTF8, 1, pBlob);
+        return *ppBlobEncoding ? S_OK : E_OUTOFMEMORY;
+    }
+
+    SIZE_T length = size / sizeof(wchar_t);
+    DxcStandInBlob *blob = DxcStandInBlob_Alloc(length * 4 + 1, DXC_CP_UTF8, 1);
+    if (!blob) {
+        return E_OUTOFMEMORY;
+    }
+    blob->Size = DxcUtf8_FromWide((const wchar_t*)data, length, (char*)blob->Storage);
+    blob->Storage[blob->Size] = 0;
+    if (blob->Size == 0 || blob->Storage[blob->Size - 1] != 0) {
+        blob->Size++; // Keep the terminator, as DXC does
+    }
+    *ppBlobEncoding = (IDxcBlobUtf8*)blob;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_GetBlobAsWide(DxcStandInObject *self, IDxcBlob *pBlob, IDxcBlobWide **ppBlobEncoding) {
+    (void)self;
+    if (!pBlob || !ppBlobEncoding) {
+        return E_INVALIDARG;
+    }
+
+    BOOL known;
+    const void *data = IDxcBlob_GetBufferPointer(pBlob);
+    SIZE_T size = IDxcBlob_GetBufferSize(pBlob);
+    if (DxcStandIn_GetCodePage(pBlob, &known) == DXC_CP_WIDE) {
+        *ppBlobEncoding = (IDxcBlobWide*)DxcStandInBlob_View(data, size, DXC_CP_WIDE, 1, pBlob);
+        return *ppBlobEncoding ? S_OK : E_OUTOFMEMORY;
+    }
+
+    if (size && ((const char*)data)[size - 1] == 0) {
+        --size;
+    }
+    DxcStandInBlob *blob = DxcStandInBlob_Alloc((size + 1) * sizeof(wchar_t), DXC_CP_WIDE, 1);
+    if (!blob) {
+        return E_OUTOFMEMORY;
+    }
+    wchar_t *wide = (wchar_t*)blob->Storage;
+    SIZE_T length = DxcUtf8_ToWide((const char*)data, size, wide);
+    wide[length] = 0;
+    blob->Size = (length + 1) * sizeof(wchar_t);
+    *ppBlobEncoding = (IDxcBlobWide*)blob;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_GetDxilContainerPart(DxcStandInObject *self, const DxcBuffer *pShader, UINT32 dxcPart,
+                                                                     void **ppPartData, UINT32 *pPartSizeInBytes) {
+    (void)self;
+    if (!pShader || !ppPartData || !pPartSizeInBytes) {
+        return E_INVALIDARG;
+    }
+
+    DxcContainerView view;
+    DxcPartView part;
+    HRESULT hr = DxcContainer_Parse(pShader->Ptr, pShader->Size, &view);
+    if (SUCCEEDED(hr) && !DxcContainer_FindPart(&view, dxcPart, &part)) {
+        hr = E_FAIL;
+    }
+    if (FAILED(hr)) {
+        return hr;
+    }
+    *ppPartData = (void*)part.pData;
+    *pPartSizeInBytes = part.Size;
+    return S_OK;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_CreateReflection(DxcStandInObject *self, const DxcBuffer *pData, REFIID iid, void **ppvReflection) {
+    (void)self; (void)pData; (void)iid;
+    if (ppvReflection) {
+        *ppvReflection = NULL;
+    }
+    return E_NOTIMPL;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_BuildArguments(DxcStandInObject *self, LPCWSTR pSourceName, LPCWSTR pEntryPoint, LPCWSTR pTargetProfile,
+                                                               LPCWSTR *pArguments, UINT32 argCount, const DxcDefine *pDefines, UINT32 defineCount,
+                                                               IDxcCompilerArgs **ppArgs) {
+    (void)self; (void)pSourceName; (void)pEntryPoint; (void)pTargetProfile; (void)pArguments; (void)argCount; (void)pDefines; (void)defineCount;
+    if (ppArgs) {
+        *ppArgs = NULL;
+    }
+    return E_NOTIMPL;
+}
+
+static inline HRESULT __stdcall DxcStandInUtils_GetPDBContents(DxcStandInObject *self, IDxcBlob *pPDBBlob, IDxcBlob **ppHash, IDxcBlob **ppContainer) {
+    (void)self; (void)pPDBBlob;
+    if (ppHash) {
+        *ppHash = NULL;
+    }
+    if (ppContainer) {
+        *ppContainer = NULL;
+    }
+    return E_NOTIMPL;
+}
+
+static void *const DxcStandInUtils_Vtbl[] = {
+    (void*)DxcStandInObject_QueryInterface,
+    (void*)DxcStandInObject_AddRef,
+    (void*)DxcStandInObject_Release,
+    (void*)DxcStandInUtils_CreateBlobFromBlob,
+    (void*)DxcStandInUtils_CreateBlobFromPinned,
+    (void*)DxcStandInUtils_MoveToBlob,
+    (void*)DxcStandInUtils_CreateBlob,
+    (void*)DxcStandInUtils_LoadFile,
+    (void*)DxcStandInUtils_CreateReadOnlyStreamFromBlob,
+    (void*)DxcStandInUtils_CreateDefaultIncludeHandler,
+    (void*)DxcStandInUtils_GetBlobAsUtf8,
+    (void*)DxcStandInUtils_GetBlobAsWide,
+    (void*)DxcStandInUtils_GetDxilContainerPart,
+    (void*)DxcStandInUtils_CreateReflection,
+    (void*)DxcStandInUtils_BuildArguments,
+    (void*)DxcStandInUtils_GetPDBContents,
+};
+
+// --- Methods ----------------------------------------------------------------
+// Not synchronized with running compiles; configure before creating instances
+static inline void DxcStandIn_Configure(const DxcStandInDesc *pDesc) {
+    memset(&DxcStandIn_State.Desc, 0, sizeof(DxcStandIn_State.Desc));
+    if (pDesc) {
+        DxcStandIn_State.Desc = *pDesc;
+    }
+}
+
+// Applies DXC_STANDIN_COMPILE_NS, DXC_STANDIN_NS_PER_KIB and DXC_STANDIN_SLEEP
+static inline void DxcStandIn_ConfigureFromEnvironment(void) {
+    const char *compile = getenv("DXC_STANDIN_COMPILE_NS");
+    const char *perKiB = getenv("DXC_STANDIN_NS_PER_KIB");
+    const char *sleepFlag = getenv("DXC_STANDIN_SLEEP");
+
+    DxcStandInDesc desc = DxcStandIn_State.Desc;
+    if (compile)   { desc.CompileNanoseconds = strtoull(compile, NULL, 10); }
+    if (perKiB)    { desc.NanosecondsPerKiB = strtoull(perKiB, NULL, 10); }
+    if (sleepFlag) { desc.Sleep = atoi(sleepFlag) != 0; }
+    DxcStandIn_Configure(&desc);
+}
+
+static inline DxcStandInStats DxcStandIn_GetStats(void) {
+    DxcStandInStats stats;
+    stats.Compiles = atomic_load(&DxcStandIn_State.Compiles);
+    stats.BlobsCreated = atomic_load(&DxcStandIn_State.BlobsCreated);
+    stats.LiveObjects = atomic_load(&DxcStandIn_State.LiveObjects);
+    return stats;
+}
+
+// Supports CLSID_DxcCompiler with IID_IDxcCompiler3 and CLSID_DxcUtils with IID_IDxcUtils
+static inline HRESULT __stdcall DxcStandIn_CreateInstance(REFCLSID rclsid, REFIID riid, LPVOID *ppv) {
+    if (!rclsid || !riid || !ppv) {
+        return E_INVALIDARG;
+    }
+    *ppv = NULL;
+
+    DxcStandInObject *object = NULL;
+    if (DxcStandIn_IsIid(rclsid, &CLSID_DxcCompiler)) {
+        object = DxcStandInObject_Create(DxcStandInCompiler_Vtbl, &IID_IDxcCompiler3);
+    } else if (DxcStandIn_IsIid(rclsid, &CLSID_DxcUtils)) {
+        object = DxcStandInObject_Create(DxcStandInUtils_Vtbl, &IID_IDxcUtils);
+    } else {
+        return DXC_STANDIN_E_CLASSNOTAVAILABLE;
+    }
+    if (!object) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = DxcStandInObject_QueryInterface(object, riid, ppv);
+    DxcStandInObject_Release(object);
+    return hr;
+}
+
+#ifdef DXC_STANDIN_EXPORT
+    #ifdef _WIN32
+        #define DXC_STANDIN_API __declspec(dllexport)
+    #else
+        #define DXC_STANDIN_API __attribute__((visibility("default")))
+    #endif
+
+static pthread_once_t DxcStandIn_EnvironmentOnce = PTHREAD_ONCE_INIT;
+
+DXC_STANDIN_API HRESULT __stdcall DxcCreateInstance(REFCLSID rclsid, REFIID riid, LPVOID *ppv) {
+    pthread_once(&DxcStandIn_EnvironmentOnce, DxcStandIn_ConfigureFromEnvironment);
+    return DxcStandIn_CreateInstance(rclsid, riid, ppv);
+}
+
+// The allocator is ignored; every object uses malloc
+DXC_STANDIN_API HRESULT __stdcall DxcCreateInstance2(IMalloc *pMalloc, REFCLSID rclsid, REFIID riid, LPVOID *ppv) {
+    (void)pMalloc;
+    return DxcCreateInstance(rclsid, riid, ppv);
+}
+#endif
+
+#endif /* __DXC_STANDIN_C__ */
@@ -0,0 +1,1117 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_symbols.h                                                           //
+// Background PDB writer and compressed symbol store indexed by shader hash  //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_SYMBOLS_C__
+#define __DXC_SYMBOLS_C__
+
+#include "dxc_c.h"
+#include "dxc_c_args.h"
+#include "dxc_c_container.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX. A symbol store is one append-only file of PDB
+// records keyed by DxcShaderHash.HashDigest. DxcSymbolStore_Submit and
+// DxcSymbolStore_SubmitResult only take a reference on the DXC_OUT_PDB blob
+// and its -Zsb/-Zss name and queue them; a background thread compresses each
+// PDB (LZ4 block format) and appends it, so compile threads never wait on
+// compression or file I/O. PDBs whose shader hash is already stored are
+// skipped.
+//
+// Opening a store reads only the record headers to build the index. PDBs are
+// read, checked and decompressed on demand, either directly with
+// DxcSymbolStore_ReadPdb or through the IDxcPdbUtils2 returned by
+// DxcSymbolStore_CreatePdbUtils: its Load accepts a stripped DXIL container,
+// remembers the shader hash and only fetches the PDB when a getter needs it.
+//
+// One process may have a store open for writing at a time. Read-only opens do
+// not take the lock, and see the records that existed when they were opened.
+
+#define DXC_SYMBOLS_MAGIC          DXC_FOURCC('D', 'X', 'S', 'S')
+#define DXC_SYMBOLS_RECORD_MAGIC   DXC_FOURCC('D', 'X', 'S', 'R')
+#define DXC_SYMBOLS_VERSION        1
+
+#define DXC_SYMBOLS_RECORD_COMPRESSED 0x1 // Payload is an LZ4 block, otherwise the raw PDB
+
+#define DXC_SYMBOLS_E_QUEUE_FULL ((HRESULT)0x80DC0002) // MaxQueuedBytes would be exceeded; the PDB was not queued
+#define DXC_SYMBOLS_E_CORRUPT    ((HRESULT)0x80DC0003) // A record failed its checksum or did not decompress
+#define DXC_SYMBOLS_E_READ_ONLY  ((HRESULT)0x80DC0004) // The store was opened with ReadOnly
+#define DXC_SYMBOLS_E_LOCKED     ((HRESULT)0x80070020) // HRESULT_FROM_WIN32(ERROR_SHARING_VIOLATION)
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcSymbolStoreFileHeader {
+    UINT32 Magic;
+    UINT32 Version;
+    UINT64 Reserved;
+} DxcSymbolStoreFileHeader;
+
+// Followed by NameSize bytes of UTF-8 name and StoredSize bytes of payload
+typedef struct DxcSymbolRecordHeader {
+    UINT32 Magic;
+    UINT32 Flags;      // DXC_SYMBOLS_RECORD_*
+    BYTE   Key[16];    // DxcShaderHash.HashDigest
+    UINT32 NameSize;   // -Zsb/-Zss name, not NUL-terminated
+    UINT32 RawSize;    // PDB size
+    UINT32 StoredSize;
+    UINT32 Checksum;   // Low 32 bits of DxcHash over name and payload
+} DxcSymbolRecordHeader;
+
+typedef struct DxcSymbolStoreDesc {
+    const char *pPath;
+    UINT64      MaxQueuedBytes; // PDB bytes waiting for the writer; 0 is unlimited
+    BOOL        ReadOnly;       // No writer thread and no lock; Submit fails
+} DxcSymbolStoreDesc;
+
+typedef struct DxcSymbolStoreStats {
+    UINT64 Submitted;     // PDBs accepted into the queue
+    UINT64 Dropped;       // Rejected with DXC_SYMBOLS_E_QUEUE_FULL
+    UINT64 Written;
+    UINT64 Duplicates;    // Skipped because the shader hash was already stored
+    UINT64 WriteFailures; // Invalid PDBs, allocation or I/O failures
+    UINT64 RawBytes;      // PDB bytes written
+    UINT64 StoredBytes;   // Record bytes appended, including headers and names
+    UINT64 QueuedBytes;   // Currently waiting
+    UINT32 EntryCount;
+} DxcSymbolStoreStats;
+
+typedef struct DxcSymbolEntry {
+    BYTE   Key[16];
+    UINT64 Offset;     // Of the record header
+    UINT32 Flags;
+    UINT32 NameSize;
+    UINT32 RawSize;
+    UINT32 StoredSize;
+    UINT32 Checksum;
+} DxcSymbolEntry;
+
+typedef struct DxcSymbolQueueItem {
+    struct DxcSymbolQueueItem *pNext;
+    IDxcBlob                  *pPdb;
+    IDxcBlobWide              *pName;  // NULL stores an empty name
+    BYTE                       Key[16];
+    BOOL                       HasKey; // Otherwise read from the PDB's DXC_PART_SHADER_HASH
+} DxcSymbolQueueItem;
+
+typedef struct DxcSymbolStore {
+    int                  Fd;
+    BOOL                 ReadOnly;
+    UINT64               FileSize;       // Append offset, advanced by the writer thread only
+    DxcHashTable         Entries;        // DxcSymbolEntry keyed by Key
+    pthread_mutex_t      IndexLock;      // Guards Entries
+    DxcSymbolQueueItem  *pHead;
+    DxcSymbolQueueItem  *pTail;
+    UINT64               MaxQueuedBytes;
+    BOOL                 Busy;           // The writer holds a dequeued item
+    BOOL                 Shutdown;
+    BOOL                 ThreadStarted;
+    pthread_t            Thread;
+    DxcSymbolStoreStats  Stats;
+    pthread_mutex_t      Lock;           // Guards the queue, Busy, Shutdown and Stats
+    pthread_cond_t       WorkCond;
+    pthread_cond_t       IdleCond;
+} DxcSymbolStore;
+
+// --- Internals --------------------------------------------------------------
+#define DXC_SYMBOLS_HASH_BITS     12
+#define DXC_SYMBOLS_MIN_MATCH     4
+#define DXC_SYMBOLS_LAST_LITERALS 5     // LZ4 block format: the last 5 bytes are always literals
+#define DXC_SYMBOLS_MATCH_LIMIT   12    // and no match starts in the last 12
+#define DXC_SYMBOLS_MAX_OFFSET    65535
+
+static inline UINT32 DxcSymbols_Read32(const BYTE *p) {
+    UINT32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline SIZE_T DxcSymbols_CompressBound(SIZE_T size) { return size + size / 255 + 16; }
+
+static inline BYTE *DxcSymbols_WriteLength(BYTE *p, SIZE_T length) {
+    while (length >= 255) {
+        *p++ = 255;
+        length -= 255;
+    }
+    *p++ = (BYTE)length;
+    return p;
+}
+
+// A matchLength of 0 writes the final, literal-only sequence
+static inline BYTE *DxcSymbols_WriteSequence(BYTE *p, const BYTE *pLiterals, SIZE_T literalCount, UINT32 offset, SIZE_T matchLength) {
+    BYTE *token = p++;
+    *token = (BYTE)((literalCount >= 15 ? 15 : literalCount) << 4);
+    if (literalCount >= 15) {
+        p = DxcSymbols_WriteLength(p, literalCount - 15);
+    }
+    memcpy(p, pLiterals, literalCount);
+    p += literalCount;
+
+    if (matchLength) {
+        SIZE_T code = matchLength - DXC_SYMBOLS_MIN_MATCH;
+        *p++ = (BYTE)offset;
+        *p++ = (BYTE)(offset >> 8);
+        *token |= (BYTE)(code >= 15 ? 15 : code);
+        if (code >= 15) {
+            p = DxcSymbols_WriteLength(p, code - 15);
+        }
+    }
+    return p;
+}
+
+// Greedy single-probe LZ77 into an LZ4 block. pDst must hold
+// DxcSymbols_CompressBound(size) bytes.
+static inline SIZE_T DxcSymbols_Compress(const BYTE *pSrc, SIZE_T size, BYTE *pDst) {
+    UINT32 table[1 << DXC_SYMBOLS_HASH_BITS]; // Position + 1
+    memset(table, 0, sizeof(table));
+
+    BYTE *out = pDst;
+    SIZE_T anchor = 0;
+    SIZE_T ip = 0;
+
+    if (size > DXC_SYMBOLS_MATCH_LIMIT) {
+        SIZE_T limit = size - DXC_SYMBOLS_MATCH_LIMIT;
+        SIZE_T matchEnd = size - DXC_SYMBOLS_LAST_LITERALS;
+
+        while (ip < limit) {
+            UINT32 sequence = DxcSymbols_Read32(pSrc + ip);
+            UINT32 bucket = (sequence * 2654435761u) >> (32 - DXC_SYMBOLS_HASH_BITS);
+            SIZE_T candidate = table[bucket];
+            table[bucket] = (UINT32)(ip + 1);
+
+            if (!candidate || ip - (candidate - 1) > DXC_SYMBOLS_MAX_OFFSET || DxcSymbols_Read32(pSrc + candidate - 1) != sequence) {
+                // Step faster through data that keeps missing
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            SIZE_T ref = candidate - 1;
+            while (ip > anchor && ref > 0 && pSrc[ip - 1] == pSrc[ref - 1]) {
+                --ip;
+                --ref;
+            }
+
+            SIZE_T length = DXC_SYMBOLS_MIN_MATCH;
+            while (ip + length < matchEnd && pSrc[ip + length] == pSrc[ref + length]) {
+                ++length;
+            }
+
+            out = DxcSymbols_WriteSequence(out, pSrc + anchor, ip - anchor, (UINT32)(ip - ref), length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    out = DxcSymbols_WriteSequence(out, pSrc + anchor, size - anchor, 0, 0);
+    return (SIZE_T)(out - pDst);
+}
+
+static inline BOOL DxcSymbols_ReadLength(const BYTE **pIn, const BYTE *inEnd, SIZE_T *pLength) {
+    BYTE value;
+    do {
+        if (*pIn == inEnd) {
+            return 0;
+        }
+        value = *(*pIn)++;
+        *pLength += value;
+    } while (value == 255);
+    return 1;
+}
+
+// Decodes an LZ4 block that must expand to exactly dstSize bytes
+static inline BOOL DxcSymbols_Decompress(const BYTE *pSrc, SIZE_T srcSize, BYTE *pDst, SIZE_T dstSize) {
+    const BYTE *in = pSrc;
+    const BYTE *inEnd = pSrc + srcSize;
+    SIZE_T op = 0;
+
+    while (in < inEnd) {
+        BYTE token = *in++;
+
+        SIZE_T literals = token >> 4;
+        if (literals == 15 && !DxcSymbols_ReadLength(&in, inEnd, &literals)) {
+            return 0;
+        }
+        if (literals > (SIZE_T)(inEnd - in) || literals > dstSize - op) {
+            return 0;
+        }
+        memcpy(pDst + op, in, literals);
+        in += literals;
+        op += literals;
+
+        if (in == inEnd) {
+            break;
+        }
+        if (inEnd - in < 2) {
+            return 0;
+        }
+
+        SIZE_T offset = (SIZE_T)in[0] | ((SIZE_T)in[1] << 8);
+        in += 2;
+        SIZE_T length = token & 15;
+        if (length == 15 && !DxcSymbols_ReadLength(&in, inEnd, &length)) {
+            return 0;
+        }
+        length += DXC_SYMBOLS_MIN_MATCH;
+        if (offset == 0 || offset > op || length > dstSize - op) {
+            return 0;
+        }
+
+        if (offset >= length) {
+            memcpy(pDst + op, pDst + op - offset, length);
+        } else {
+            for (SIZE_T i = 0; i < length; ++i) {
+                pDst[op + i] = pDst[op - offset + i];
+            }
+        }
+        op += length;
+    }
+    return op == dstSize;
+}
+
+static inline UINT32 DxcSymbols_Checksum(const BYTE *pData, SIZE_T size) {
+    DxcHash hash = DxcHash_Compute(pData, size, 0);
+    UINT32 value;
+    memcpy(&value, hash.Digest, sizeof(value));
+    return value;
+}
+
+static inline HRESULT DxcSymbols_PreadAll(int fd, void *pData, SIZE_T size, UINT64 offset) {
+    BYTE *data = (BYTE*)pData;
+    while (size > 0) {
+        ssize_t count = pread(fd, data, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return E_FAIL;
+        }
+        data += count;
+        size -= (SIZE_T)count;
+        offset += (UINT64)count;
+    }
+    return S_OK;
+}
+
+static inline HRESULT DxcSymbols_PwriteAll(int fd, const void *pData, SIZE_T size, UINT64 offset) {
+    const BYTE *data = (const BYTE*)pData;
+    while (size > 0) {
+        ssize_t count = pwrite(fd, data, size, (off_t)offset);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return E_FAIL;
+        }
+        data += count;
+        size -= (SIZE_T)count;
+        offset += (UINT64)count;
+    }
+    return S_OK;
+}
+
+// Must be called with store->IndexLock held. Keeps the first record of a key.
+static inline HRESULT DxcSymbolStore_InsertLocked(DxcSymbolStore *store, const DxcSymbolEntry *pEntry) {
+    return DxcHashTable_Insert(&store->Entries, pEntry, NULL);
+}
+
+static inline BOOL DxcSymbolStore_FindEntry(DxcSymbolStore *store, const BYTE key[16], DxcSymbolEntry *pEntry) {
+    BOOL found = 0;
+    pthread_mutex_lock(&store->IndexLock);
+    const DxcSymbolEntry *entry = (const DxcSymbolEntry*)DxcHashTable_Find(&store->Entries, key);
+    if (entry) {
+        if (pEntry) {
+            *pEntry = *entry;
+        }
+        found = 1;
+    }
+    pthread_mutex_unlock(&store->IndexLock);
+    return found;
+}
+
+// Indexes every complete record. A torn record at the end of the file, left
+// by a crash mid-append, is cut off when the store is writable.
+static inline HRESULT DxcSymbolStore_Scan(DxcSymbolStore *store, UINT64 fileSize) {
+    UINT64 offset = sizeof(DxcSymbolStoreFileHeader);
+    while (offset < fileSize) {
+        DxcSymbolRecordHeader header;
+        if (fileSize - offset < sizeof(header) || FAILED(DxcSymbols_PreadAll(store->Fd, &header, sizeof(header), offset))) {
+            break;
+        }
+        UINT64 end = offset + sizeof(header) + header.NameSize + header.StoredSize;
+        if (header.Magic != DXC_SYMBOLS_RECORD_MAGIC || end > fileSize) {
+            break;
+        }
+
+        DxcSymbolEntry entry;
+        memcpy(entry.Key, header.Key, sizeof(entry.Key));
+        entry.Offset = offset;
+        entry.Flags = header.Flags;
+        entry.NameSize = header.NameSize;
+        entry.RawSize = header.RawSize;
+        entry.StoredSize = header.StoredSize;
+        entry.Checksum = header.Checksum;
+        if (FAILED(DxcSymbolStore_InsertLocked(store, &entry))) {
+            return E_OUTOFMEMORY;
+        }
+        offset = end;
+    }
+
+    if (offset < fileSize && !store->ReadOnly && ftruncate(store->Fd, (off_t)offset) != 0) {
+        return E_FAIL;
+    }
+    store->FileSize = offset;
+    return S_OK;
+}
+
+// Runs on the writer thread. Returns S_FALSE for a duplicate.
+static inline HRESULT DxcSymbolStore_WriteItem(DxcSymbolStore *store, DxcSymbolQueueItem *item, UINT64 *pStoredBytes) {
+    const BYTE *pdb = (const BYTE*)IDxcBlob_GetBufferPointer(item->pPdb);
+    SIZE_T pdbSize = IDxcBlob_GetBufferSize(item->pPdb);
+    if (!pdb || pdbSize == 0 || pdbSize > 0x7FFFFFFFu) {
+        return E_INVALIDARG;
+    }
+
+    if (!item->HasKey) {
+        DxcContainerView view;
+        DxcShaderHash hash;
+        if (FAILED(DxcContainer_Parse(pdb, pdbSize, &view)) || !DxcContainer_GetShaderHash(&view, &hash)) {
+            return E_INVALIDARG;
+        }
+        memcpy(item->Key, hash.HashDigest, sizeof(item->Key));
+    }
+    if (DxcSymbolStore_FindEntry(store, item->Key, NULL)) {
+        return S_FALSE;
+    }
+
+    const wchar_t *name = item->pName ? (const wchar_t*)IDxcBlobWide_GetStringPointer(item->pName) : NULL;
+    SIZE_T nameLength = name ? IDxcBlobWide_GetStringLength(item->pName) : 0;
+
+    SIZE_T capacity = sizeof(DxcSymbolRecordHeader) + nameLength * 4 + DxcSymbols_CompressBound(pdbSize);
+    BYTE *record = (BYTE*)malloc(capacity);
+    if (!record) {
+        return E_OUTOFMEMORY;
+    }
+
+    DxcSymbolRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = DXC_SYMBOLS_RECORD_MAGIC;
+    memcpy(header.Key, item->Key, sizeof(header.Key));
+    header.NameSize = (UINT32)DxcUtf8_FromWide(name, nameLength, (char*)record + sizeof(header));
+    header.RawSize = (UINT32)pdbSize;
+
+    BYTE *payload = record + sizeof(header) + header.NameSize;
+    SIZE_T storedSize = DxcSymbols_Compress(pdb, pdbSize, payload);
+    if (storedSize < pdbSize) {
+        header.Flags = DXC_SYMBOLS_RECORD_COMPRESSED;
+    } else {
+        memcpy(payload, pdb, pdbSize);
+        storedSize = pdbSize;
+    }
+    header.StoredSize = (UINT32)storedSize;
+    header.Checksum = DxcSymbols_Checksum(record + sizeof(header), header.NameSize + storedSize);
+    memcpy(record, &header, sizeof(header));
+
+    // Records are written past the last indexed one, so a failed write is
+    // simply overwritten by the next append
+    SIZE_T recordSize = sizeof(header) + header.NameSize + storedSize;
+    HRESULT hr = DxcSymbols_PwriteAll(store->Fd, record, recordSize, store->FileSize);
+    free(record);
+
+    if (SUCCEEDED(hr)) {
+        DxcSymbolEntry entry;
+        memcpy(entry.Key, header.Key, sizeof(entry.Key));
+        entry.Offset = store->FileSize;
+        entry.Flags = header.Flags;
+        entry.NameSize = header.NameSize;
+        entry.RawSize = header.RawSize;
+        entry.StoredSize = header.StoredSize;
+        entry.Checksum = header.Checksum;
+
+        pthread_mutex_lock(&store->IndexLock);
+        hr = DxcSymbolStore_InsertLocked(store, &entry);
+        pthread_mutex_unlock(&store->IndexLock);
+    }
+    if (SUCCEEDED(hr)) {
+        store->FileSize += recordSize;
+        *pStoredBytes = recordSize;
+    }
+    return hr;
+}
+
+static inline void *DxcSymbolStore_WriterMain(void *arg) {
+    DxcSymbolStore *store = (DxcSymbolStore*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&store->Lock);
+        while (!store->pHead && !store->Shutdown) {
+            pthread_cond_wait(&store->WorkCond, &store->Lock);
+        }
+        DxcSymbolQueueItem *item = store->pHead;
+        if (!item) {
+            pthread_mutex_unlock(&store->Lock);
+            break;
+        }
+        store->pHead = item->pNext;
+        if (!store->pHead) {
+            store->pTail = NULL;
+        }
+        store->Busy = 1;
+        pthread_mutex_unlock(&store->Lock);
+
+        UINT64 storedBytes = 0;
+        SIZE_T pdbSize = IDxcBlob_GetBufferSize(item->pPdb);
+        HRESULT hr = DxcSymbolStore_WriteItem(store, item, &storedBytes);
+
+        IDxcBlob_Release(item->pPdb);
+        if (item->pName) {
+            IDxcBlobWide_Release(item->pName);
+        }
+        free(item);
+
+        pthread_mutex_lock(&store->Lock);
+        store->Stats.QueuedBytes -= pdbSize;
+        if (hr == S_FALSE) {
+            store->Stats.Duplicates++;
+        } else if (SUCCEEDED(hr)) {
+            store->Stats.Written++;
+            store->Stats.RawBytes += pdbSize;
+            store->Stats.StoredBytes += storedBytes;
+        } else {
+            store->Stats.WriteFailures++;
+        }
+        store->Busy = 0;
+        if (!store->pHead) {
+            pthread_cond_broadcast(&store->IdleCond);
+        }
+        pthread_mutex_unlock(&store->Lock);
+    }
+    return NULL;
+}
+
+// Minimal IDxcBlob owning a malloc'd buffer
+typedef struct DxcSymbolBlob {
+    void *const *v;
+    BYTE        *pData;
+    SIZE_T       Size;
+    atomic_uint  RefCount;
+} DxcSymbolBlob;
+
+static inline ULONG __stdcall DxcSymbolBlob_AddRef(DxcSymbolBlob *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcSymbolBlob_Release(DxcSymbolBlob *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        free(self->pData);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcSymbolBlob_QueryInterface(DxcSymbolBlob *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcBlob, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcSymbolBlob_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+static inline LPVOID __stdcall DxcSymbolBlob_GetBufferPointer(DxcSymbolBlob *self) { return (LPVOID)self->pData; }
+static inline SIZE_T __stdcall DxcSymbolBlob_GetBufferSize(DxcSymbolBlob *self) { return self->Size; }
+
+static void *const DxcSymbolBlob_Vtbl[] = {
+    (void*)DxcSymbolBlob_QueryInterface,
+    (void*)DxcSymbolBlob_AddRef,
+    (void*)DxcSymbolBlob_Release,
+    (void*)DxcSymbolBlob_GetBufferPointer,
+    (void*)DxcSymbolBlob_GetBufferSize,
+};
+
+// Takes ownership of pData, which is freed on failure
+static inline IDxcBlob *DxcSymbolBlob_Create(BYTE *pData, SIZE_T size) {
+    DxcSymbolBlob *blob = (DxcSymbolBlob*)malloc(sizeof(DxcSymbolBlob));
+    if (!blob) {
+        free(pData);
+        return NULL;
+    }
+    blob->v = DxcSymbolBlob_Vtbl;
+    blob->pData = pData;
+    blob->Size = size;
+    atomic_init(&blob->RefCount, 1);
+    return (IDxcBlob*)blob;
+}
+
+// --- Methods ----------------------------------------------------------------
+// Waits for the queue to drain, then stops the writer thread
+static inline void DxcSymbolStore_Close(DxcSymbolStore *store) {
+    if (!store) {
+        return;
+    }
+
+    if (store->ThreadStarted) {
+        pthread_mutex_lock(&store->Lock);
+        store->Shutdown = 1;
+        pthread_cond_signal(&store->WorkCond);
+        pthread_mutex_unlock(&store->Lock);
+        pthread_join(store->Thread, NULL);
+    }
+
+    if (store->Fd >= 0) {
+        if (!store->ReadOnly) {
+            fdatasync(store->Fd);
+        }
+        close(store->Fd);
+    }
+    pthread_cond_destroy(&store->IdleCond);
+    pthread_cond_destroy(&store->WorkCond);
+    pthread_mutex_destroy(&store->Lock);
+    pthread_mutex_destroy(&store->IndexLock);
+    DxcHashTable_Destroy(&store->Entries);
+    free(store);
+}
+
+static inline HRESULT DxcSymbolStore_Open(const DxcSymbolStoreDesc *pDesc, DxcSymbolStore **ppStore) {
+    if (!pDesc || !pDesc->pPath || !ppStore) {
+        return E_INVALIDARG;
+    }
+    *ppStore = NULL;
+
+    DxcSymbolStore *store = (DxcSymbolStore*)calloc(1, sizeof(DxcSymbolStore));
+    if (!store) {
+        return E_OUTOFMEMORY;
+    }
+    store->Fd = -1;
+    store->ReadOnly = pDesc->ReadOnly;
+    DxcHashTable_Init(&store->Entries, sizeof(DxcSymbolEntry));
+    store->MaxQueuedBytes = pDesc->MaxQueuedBytes;
+    pthread_mutex_init(&store->IndexLock, NULL);
+    pthread_mutex_init(&store->Lock, NULL);
+    pthread_cond_init(&store->WorkCond, NULL);
+    pthread_cond_init(&store->IdleCond, NULL);
+
+    store->Fd = open(pDesc->pPath, store->ReadOnly ? O_RDONLY | O_CLOEXEC : O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store->Fd < 0) {
+        DxcSymbolStore_Close(store);
+        return E_FAIL;
+    }
+    if (!store->ReadOnly && flock(store->Fd, LOCK_EX | LOCK_NB) != 0) {
+        int error = errno; // Close may change errno
+        DxcSymbolStore_Close(store);
+        return error == EWOULDBLOCK ? DXC_SYMBOLS_E_LOCKED : E_FAIL;
+    }
+
+    HRESULT hr = S_OK;
+    off_t fileSize = lseek(store->Fd, 0, SEEK_END);
+    DxcSymbolStoreFileHeader header;
+    if (fileSize < 0) {
+        hr = E_FAIL;
+    } else if (fileSize == 0 && !store->ReadOnly) {
+        memset(&header, 0, sizeof(header));
+        header.Magic = DXC_SYMBOLS_MAGIC;
+        header.Version = DXC_SYMBOLS_VERSION;
+        hr = DxcSymbols_PwriteAll(store->Fd, &header, sizeof(header), 0);
+        store->FileSize = sizeof(header);
+    } else if ((UINT64)fileSize < sizeof(header) || FAILED(DxcSymbols_PreadAll(store->Fd, &header, sizeof(header), 0)) ||
+               header.Magic != DXC_SYMBOLS_MAGIC || header.Version != DXC_SYMBOLS_VERSION) {
+        hr = E_INVALIDARG;
+    } else {
+        hr = DxcSymbolStore_Scan(store, (UINT64)fileSize);
+    }
+
+    if (SUCCEEDED(hr) && !store->ReadOnly) {
+        if (pthread_create(&store->Thread, NULL, DxcSymbolStore_WriterMain, store) == 0) {
+            store->ThreadStarted = 1;
+        } else {
+            hr = E_FAIL;
+        }
+    }
+
+    if (FAILED(hr)) {
+        DxcSymbolStore_Close(store);
+        return hr;
+    }
+
+    *ppStore = store;
+    return S_OK;
+}
+
+// Queues pPdb for the writer without copying it. pName is the -Zsb/-Zss
+// name from IDxcResult_GetOutput and may be NULL. pHash NULL reads the key
+// from the PDB's DXC_PART_SHADER_HASH on the writer thread.
+static inline HRESULT DxcSymbolStore_Submit(DxcSymbolStore *store, IDxcBlob *pPdb, IDxcBlobWide *pName, const DxcShaderHash *pHash) {
+    if (!store || !pPdb) {
+        return E_INVALIDARG;
+    }
+    if (store->ReadOnly) {
+        return DXC_SYMBOLS_E_READ_ONLY;
+    }
+
+    SIZE_T pdbSize = IDxcBlob_GetBufferSize(pPdb);
+    DxcSymbolQueueItem *item = (DxcSymbolQueueItem*)calloc(1, sizeof(DxcSymbolQueueItem));
+    if (!item) {
+        return E_OUTOFMEMORY;
+    }
+    item->pPdb = pPdb;
+    item->pName = pName;
+    if (pHash) {
+        memcpy(item->Key, pHash->HashDigest, sizeof(item->Key));
+        item->HasKey = 1;
+    }
+
+    pthread_mutex_lock(&store->Lock);
+    if (store->MaxQueuedBytes && store->Stats.QueuedBytes + pdbSize > store->MaxQueuedBytes) {
+        store->Stats.Dropped++;
+        pthread_mutex_unlock(&store->Lock);
+        free(item);
+        return DXC_SYMBOLS_E_QUEUE_FULL;
+    }
+
+    IDxcBlob_AddRef(pPdb);
+    if (pName) {
+        IDxcBlobWide_AddRef(pName);
+    }
+    if (store->pTail) {
+        store->pTail->pNext = item;
+    } else {
+        store->pHead = item;
+    }
+    store->pTail = item;
+    store->Stats.QueuedBytes += pdbSize;
+    store->Stats.Submitted++;
+    pthread_cond_signal(&store->WorkCond);
+    pthread_mutex_unlock(&store->Lock);
+    return S_OK;
+}
+
+// Queues the DXC_OUT_PDB output of pResult under its DXC_OUT_SHADER_HASH.
+// Returns S_FALSE when the result has no PDB (compiled without -Zi).
+static inline HRESULT DxcSymbolStore_SubmitResult(DxcSymbolStore *store, IDxcResult *pResult) {
+    if (!store || !pResult) {
+        return E_INVALIDARG;
+    }
+    if (!IDxcResult_HasOutput(pResult, DXC_OUT_PDB)) {
+        return S_FALSE;
+    }
+
+    IDxcBlob *pdb = NULL;
+    IDxcBlobWide *name = NULL;
+    IDxcBlob *hashBlob = NULL;
+    DxcShaderHash hash;
+    BOOL hasHash = 0;
+
+    HRESULT hr = IDxcResult_GetOutput(pResult, DXC_OUT_PDB, &IID_IDxcBlob, (void**)&pdb, &name);
+    if (SUCCEEDED(hr) && !pdb) { hr = E_FAIL; }
+    if (SUCCEEDED(hr) && SUCCEEDED(IDxcResult_GetOutput(pResult, DXC_OUT_SHADER_HASH, &IID_IDxcBlob, (void**)&hashBlob, NULL)) && hashBlob) {
+        if (IDxcBlob_GetBufferSize(hashBlob) >= sizeof(DxcShaderHash)) {
+            memcpy(&hash, IDxcBlob_GetBufferPointer(hashBlob), sizeof(hash));
+            hasHash = 1;
+        }
+        IDxcBlob_Release(hashBlob);
+    }
+    if (SUCCEEDED(hr)) { hr = DxcSymbolStore_Submit(store, pdb, name, hasHash ? &hash : NULL); }
+
+    if (name) { IDxcBlobWide_Release(name); }
+    if (pdb)  { IDxcBlob_Release(pdb); }
+    return hr;
+}
+
+// Blocks until every PDB queued so far is written, then syncs the file
+static inline HRESULT DxcSymbolStore_Flush(DxcSymbolStore *store) {
+    if (!store) {
+        return E_INVALIDARG;
+    }
+    if (store->ReadOnly) {
+        return S_OK;
+    }
+
+    pthread_mutex_lock(&store->Lock);
+    while (store->pHead || store->Busy) {
+        pthread_cond_wait(&store->IdleCond, &store->Lock);
+    }
+    pthread_mutex_unlock(&store->Lock);
+    return fdatasync(store->Fd) == 0 ? S_OK : E_FAIL;
+}
+
+static inline DxcSymbolStoreStats DxcSymbolStore_GetStats(DxcSymbolStore *store) {
+    pthread_mutex_lock(&store->Lock);
+    DxcSymbolStoreStats stats = store->Stats;
+    pthread_mutex_unlock(&store->Lock);
+
+    pthread_mutex_lock(&store->IndexLock);
+    stats.EntryCount = store->Entries.EntryCount;
+    pthread_mutex_unlock(&store->IndexLock);
+    return stats;
+}
+
+static inline BOOL DxcSymbolStore_Contains(DxcSymbolStore *store, const BYTE pShaderHash[16]) {
+    return DxcSymbolStore_FindEntry(store, pShaderHash, NULL);
+}
+
+// Reads, verifies and decompresses the PDB for pShaderHash. ppName, if not
+// NULL, receives the stored name as a NUL-terminated UTF-8 string; free it
+// with free(). Returns S_FALSE if the store has no such PDB.
+static inline HRESULT DxcSymbolStore_ReadPdb(DxcSymbolStore *store, const BYTE pShaderHash[16], IDxcBlob **ppPdb, char **ppName) {
+    if (!store || !pShaderHash || !ppPdb) {
+        return E_INVALIDARG;
+    }
+    *ppPdb = NULL;
+    if (ppName) {
+        *ppName = NULL;
+    }
+
+    DxcSymbolEntry entry;
+    if (!DxcSymbolStore_FindEntry(store, pShaderHash, &entry)) {
+        return S_FALSE;
+    }
+
+    SIZE_T storedSize = (SIZE_T)entry.NameSize + entry.StoredSize;
+    BYTE *stored = (BYTE*)malloc(storedSize + 1);
+    BYTE *pdb = (BYTE*)malloc(entry.RawSize ? entry.RawSize : 1);
+    HRESULT hr = stored && pdb ? S_OK : E_OUTOFMEMORY;
+
+    if (SUCCEEDED(hr)) { hr = DxcSymbols_PreadAll(store->Fd, stored, storedSize, entry.Offset + sizeof(DxcSymbolRecordHeader)); }
+    if (SUCCEEDED(hr) && DxcSymbols_Checksum(stored, storedSize) != entry.Checksum) { hr = DXC_SYMBOLS_E_CORRUPT; }
+    if (SUCCEEDED(hr)) {
+        const BYTE *payload = stored + entry.NameSize;
+        if (entry.Flags & DXC_SYMBOLS_RECORD_COMPRESSED) {
+            if (!DxcSymbols_Decompress(payload, entry.StoredSize, pdb, entry.RawSize)) {
+                hr = DXC_SYMBOLS_E_CORRUPT;
+            }
+        } else if (entry.StoredSize == entry.RawSize) {
+            memcpy(pdb, payload, entry.RawSize);
+        } else {
+            hr = DXC_SYMBOLS_E_CORRUPT;
+        }
+    }
+    if (SUCCEEDED(hr)) {
+        *ppPdb = DxcSymbolBlob_Create(pdb, entry.RawSize);
+        pdb = NULL;
+        if (!*ppPdb) {
+            hr = E_OUTOFMEMORY;
+        }
+    }
+
+    // The name leads the buffer, so it is terminated and handed out in place
+    if (SUCCEEDED(hr) && ppName) {
+        stored[entry.NameSize] = '\0';
+        *ppName = (char*)stored;
+        stored = NULL;
+    }
+
+    free(pdb);
+    free(stored);
+    return hr;
+}
+
+// Writes the PDB for pShaderHash to <pDirectory>/<stored name>, for tools
+// that look symbols up by their -Zsb/-Zss file name. Returns S_FALSE if the
+// store has no such PDB.
+static inline HRESULT DxcSymbolStore_ExportPdb(DxcSymbolStore *store, const BYTE pShaderHash[16], const char *pDirectory) {
+    if (!pDirectory) {
+        return E_INVALIDARG;
+    }
+
+    IDxcBlob *pdb = NULL;
+    char *name = NULL;
+    HRESULT hr = DxcSymbolStore_ReadPdb(store, pShaderHash, &pdb, &name);
+    if (hr != S_OK) {
+        return hr;
+    }
+
+    // Stored names are file names; anything that would leave pDirectory is refused
+    char path[4096];
+    char tempPath[4096 + 32];
+    if (!name[0] || strchr(name, '/') || strcmp(name, ".") == 0 || strcmp(name, "..") == 0 ||
+        snprintf(path, sizeof(path), "%s/%s", pDirectory, name) >= (int)sizeof(path)) {
+        hr = E_INVALIDARG;
+    }
+
+    if (SUCCEEDED(hr)) {
+        FILE *file = DxcUtil_CreateTemp(path, tempPath, sizeof(tempPath));
+        if (!file) {
+            hr = E_FAIL;
+        } else {
+            hr = DxcUtil_WriteAll(file, IDxcBlob_GetBufferPointer(pdb), IDxcBlob_GetBufferSize(pdb));
+            hr = DxcUtil_FinishTemp(file, tempPath, path, hr);
+        }
+    }
+
+    free(name);
+    IDxcBlob_Release(pdb);
+    return hr;
+}
+
+// IDxcPdbUtils2 that resolves stripped DXIL containers through a symbol store
+typedef struct DxcSymbolPdbUtils {
+    void *const    *v;
+    atomic_uint     RefCount;
+    DxcSymbolStore *pStore;
+    IDxcPdbUtils2  *pInner;
+    BYTE            PendingKey[16];
+    BOOL            Pending;       // Load found the PDB in the store but has not read it yet
+    HRESULT         PendingStatus; // Outcome of the deferred load once resolved
+} DxcSymbolPdbUtils;
+
+static inline HRESULT DxcSymbolPdbUtils_Resolve(DxcSymbolPdbUtils *self) {
+    if (!self->Pending) {
+        return self->PendingStatus;
+    }
+    self->Pending = 0;
+
+    IDxcBlob *pdb = NULL;
+    HRESULT hr = DxcSymbolStore_ReadPdb(self->pStore, self->PendingKey, &pdb, NULL);
+    if (hr == S_FALSE) { hr = E_FAIL; }
+    if (SUCCEEDED(hr)) { hr = IDxcPdbUtils2_Load(self->pInner, pdb); }
+    if (pdb) { IDxcBlob_Release(pdb); }
+
+    self->PendingStatus = hr;
+    return hr;
+}
+
+static inline ULONG __stdcall DxcSymbolPdbUtils_AddRef(DxcSymbolPdbUtils *self) { return atomic_fetch_add(&self->RefCount, 1) + 1; }
+
+static inline ULONG __stdcall DxcSymbolPdbUtils_Release(DxcSymbolPdbUtils *self) {
+    ULONG count = atomic_fetch_sub(&self->RefCount, 1) - 1;
+    if (count == 0) {
+        IDxcPdbUtils2_Release(self->pInner);
+        free(self);
+    }
+    return count;
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_QueryInterface(DxcSymbolPdbUtils *self, REFIID riid, void **ppv) {
+    if (!ppv) {
+        return E_POINTER;
+    }
+    if (memcmp(riid, &IID_IDxcPdbUtils2, sizeof(IID)) != 0 && memcmp(riid, &DxcUtil_IID_IUnknown, sizeof(IID)) != 0) {
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+    DxcSymbolPdbUtils_AddRef(self);
+    *ppv = self;
+    return S_OK;
+}
+
+// A DXIL container without DXC_PART_PDB whose shader hash is in the store
+// is deferred; anything else goes straight to the real implementation
+static inline HRESULT __stdcall DxcSymbolPdbUtils_Load(DxcSymbolPdbUtils *self, IDxcBlob *pPdbOrDxil) {
+    if (!pPdbOrDxil) {
+        return E_POINTER;
+    }
+
+    DxcContainerView view;
+    DxcPartView part;
+    DxcShaderHash hash;
+    if (SUCCEEDED(DxcContainer_Parse(IDxcBlob_GetBufferPointer(pPdbOrDxil), IDxcBlob_GetBufferSize(pPdbOrDxil), &view)) &&
+        !DxcContainer_FindPart(&view, DXC_PART_PDB, &part) && DxcContainer_GetShaderHash(&view, &hash) &&
+        DxcSymbolStore_Contains(self->pStore, hash.HashDigest)) {
+        memcpy(self->PendingKey, hash.HashDigest, sizeof(self->PendingKey));
+        self->Pending = 1;
+        self->PendingStatus = S_OK;
+        return S_OK;
+    }
+
+    self->Pending = 0;
+    self->PendingStatus = S_OK;
+    return IDxcPdbUtils2_Load(self->pInner, pPdbOrDxil);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetSourceCount(DxcSymbolPdbUtils *self, UINT32 *pCount) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetSourceCount(self->pInner, pCount);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetSource(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcBlobEncoding **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetSource(self->pInner, uIndex, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetSourceName(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetSourceName(self->pInner, uIndex, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetLibraryPDBCount(DxcSymbolPdbUtils *self, UINT32 *pCount) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetLibraryPDBCount(self->pInner, pCount);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetLibraryPDB(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcPdbUtils2 **ppOutPdbUtils, IDxcBlobWide **ppLibraryName) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetLibraryPDB(self->pInner, uIndex, ppOutPdbUtils, ppLibraryName);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetFlagCount(DxcSymbolPdbUtils *self, UINT32 *pCount) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetFlagCount(self->pInner, pCount);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetFlag(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetFlag(self->pInner, uIndex, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetArgCount(DxcSymbolPdbUtils *self, UINT32 *pCount) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetArgCount(self->pInner, pCount);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetArg(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetArg(self->pInner, uIndex, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetArgPairCount(DxcSymbolPdbUtils *self, UINT32 *pCount) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetArgPairCount(self->pInner, pCount);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetArgPair(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcBlobWide **ppName, IDxcBlobWide **ppValue) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetArgPair(self->pInner, uIndex, ppName, ppValue);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetDefineCount(DxcSymbolPdbUtils *self, UINT32 *pCount) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetDefineCount(self->pInner, pCount);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetDefine(DxcSymbolPdbUtils *self, UINT32 uIndex, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetDefine(self->pInner, uIndex, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetTargetProfile(DxcSymbolPdbUtils *self, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetTargetProfile(self->pInner, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetEntryPoint(DxcSymbolPdbUtils *self, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetEntryPoint(self->pInner, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetMainFileName(DxcSymbolPdbUtils *self, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetMainFileName(self->pInner, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetHash(DxcSymbolPdbUtils *self, IDxcBlob **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetHash(self->pInner, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetName(DxcSymbolPdbUtils *self, IDxcBlobWide **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetName(self->pInner, ppResult);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetVersionInfo(DxcSymbolPdbUtils *self, IDxcVersionInfo **ppVersionInfo) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetVersionInfo(self->pInner, ppVersionInfo);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetCustomToolchainID(DxcSymbolPdbUtils *self, UINT32 *pID) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetCustomToolchainID(self->pInner, pID);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetCustomToolchainData(DxcSymbolPdbUtils *self, IDxcBlob **ppBlob) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetCustomToolchainData(self->pInner, ppBlob);
+}
+
+static inline HRESULT __stdcall DxcSymbolPdbUtils_GetWholeDxil(DxcSymbolPdbUtils *self, IDxcBlob **ppResult) {
+    HRESULT hr = DxcSymbolPdbUtils_Resolve(self);
+    return FAILED(hr) ? hr : IDxcPdbUtils2_GetWholeDxil(self->pInner, ppResult);
+}
+
+static inline BOOL __stdcall DxcSymbolPdbUtils_IsFullPDB(DxcSymbolPdbUtils *self) {
+    return SUCCEEDED(DxcSymbolPdbUtils_Resolve(self)) && IDxcPdbUtils2_IsFullPDB(self->pInner);
+}
+
+static inline BOOL __stdcall DxcSymbolPdbUtils_IsPDBRef(DxcSymbolPdbUtils *self) {
+    return SUCCEEDED(DxcSymbolPdbUtils_Resolve(self)) && IDxcPdbUtils2_IsPDBRef(self->pInner);
+}
+
+static void *const DxcSymbolPdbUtils_Vtbl[] = {
+    (void*)DxcSymbolPdbUtils_QueryInterface,
+    (void*)DxcSymbolPdbUtils_AddRef,
+    (void*)DxcSymbolPdbUtils_Release,
+    (void*)DxcSymbolPdbUtils_Load,
+    (void*)DxcSymbolPdbUtils_GetSourceCount,
+    (void*)DxcSymbolPdbUtils_GetSource,
+    (void*)DxcSymbolPdbUtils_GetSourceName,
+    (void*)DxcSymbolPdbUtils_GetLibraryPDBCount,
+    (void*)DxcSymbolPdbUtils_GetLibraryPDB,
+    (void*)DxcSymbolPdbUtils_GetFlagCount,
+    (void*)DxcSymbolPdbUtils_GetFlag,
+    (void*)DxcSymbolPdbUtils_GetArgCount,
+    (void*)DxcSymbolPdbUtils_GetArg,
+    (void*)DxcSymbolPdbUtils_GetArgPairCount,
+    (void*)DxcSymbolPdbUtils_GetArgPair,
+    (void*)DxcSymbolPdbUtils_GetDefineCount,
+    (void*)DxcSymbolPdbUtils_GetDefine,
+    (void*)DxcSymbolPdbUtils_GetTargetProfile,
+    (void*)DxcSymbolPdbUtils_GetEntryPoint,
+    (void*)DxcSymbolPdbUtils_GetMainFileName,
+    (void*)DxcSymbolPdbUtils_GetHash,
+    (void*)DxcSymbolPdbUtils_GetName,
+    (void*)DxcSymbolPdbUtils_GetVersionInfo,
+    (void*)DxcSymbolPdbUtils_GetCustomToolchainID,
+    (void*)DxcSymbolPdbUtils_GetCustomToolchainData,
+    (void*)DxcSymbolPdbUtils_GetWholeDxil,
+    (void*)DxcSymbolPdbUtils_IsFullPDB,
+    (void*)DxcSymbolPdbUtils_IsPDBRef,
+};
+
+// Creates an IDxcPdbUtils2 over CLSID_DxcPdbUtils from pfnCreateInstance.
+// The store must outlive it. Like DXC's own, the object is not thread-safe.
+static inline HRESULT DxcSymbolStore_CreatePdbUtils(DxcSymbolStore *store, DxcCreateInstanceProc pfnCreateInstance, IDxcPdbUtils2 **ppPdbUtils) {
+    if (!store || !pfnCreateInstance || !ppPdbUtils) {
+        return E_INVALIDARG;
+    }
+    *ppPdbUtils = NULL;
+
+    DxcSymbolPdbUtils *self = (DxcSymbolPdbUtils*)calloc(1, sizeof(DxcSymbolPdbUtils));
+    if (!self) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = pfnCreateInstance(&CLSID_DxcPdbUtils, &IID_IDxcPdbUtils2, (LPVOID*)&self->pInner);
+    if (FAILED(hr)) {
+        free(self);
+        return hr;
+    }
+
+    self->v = DxcSymbolPdbUtils_Vtbl;
+    atomic_init(&self->RefCount, 1);
+    self->pStore = store;
+    self->PendingStatus = S_OK;
+
+    *ppPdbUtils = (IDxcPdbUtils2*)self;
+    return S_OK;
+}
+
+#endif /* __DXC_SYMBOLS_C__ */
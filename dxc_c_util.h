@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_util.h                                                              //
+// Clock, atomic file replacement and IID_IUnknown for the companion headers //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_UTIL_C__
+#define __DXC_UTIL_C__
+
+#include "dxc_c.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX. Files are replaced atomically by writing a temporary
+// file next to the target and renaming it over the target. Temporary files
+// are created with O_EXCL, so writers that pick the same name, whether in
+// other processes or in other translation units of this one, retry with the
+// next name instead of truncating each other's output.
+
+#define DXC_UTIL_TEMP_ATTEMPTS 64
+
+// --- Interface IDs ----------------------------------------------------------
+// Not every platform header defines IID_IUnknown, which every QueryInterface
+// must accept alongside the object's own interfaces.
+static const IID DxcUtil_IID_IUnknown = { 0x00000000, 0x0000, 0x0000, { 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46 } };
+
+// --- Internals --------------------------------------------------------------
+static atomic_uint DxcUtil_TempCounter;
+
+// --- Methods ----------------------------------------------------------------
+// CLOCK_MONOTONIC in nanoseconds
+static inline UINT64 DxcUtil_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000ull + (UINT64)ts.tv_nsec;
+}
+
+static inline HRESULT DxcUtil_WriteAll(FILE *file, const void *pData, SIZE_T size) {
+    return fwrite(pData, 1, size, file) == size ? S_OK : E_FAIL;
+}
+
+// Creates a new temporary file for pPath and opens it for writing, or returns
+// NULL. pTempPath receives the name to pass to DxcUtil_FinishTemp.
+static inline FILE *DxcUtil_CreateTemp(const char *pPath, char *pTempPath, SIZE_T capacity) {
+    for (UINT32 attempt = 0; attempt < DXC_UTIL_TEMP_ATTEMPTS; ++attempt) {
+        int length = snprintf(pTempPath, capacity, "%s.tmp.%ld.%u", pPath, (long)getpid(), atomic_fetch_add(&DxcUtil_TempCounter, 1));
+        if (length < 0 || (SIZE_T)length >= capacity) {
+            return NULL;
+        }
+        int fd = open(pTempPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd < 0 && errno == EEXIST) {
+            continue;
+        }
+        FILE *file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+        if (fd >= 0 && !file) {
+            close(fd);
+            unlink(pTempPath);
+        }
+        return file;
+    }
+    return NULL;
+}
+
+// Closes file and, if hr succeeded, renames pTempPath over pPath. The
+// temporary file is removed on any failure.
+static inline HRESULT DxcUtil_FinishTemp(FILE *file, const char *pTempPath, const char *pPath, HRESULT hr) {
+    if (fclose(file) != 0 && SUCCEEDED(hr)) {
+        hr = E_FAIL;
+    }
+    if (SUCCEEDED(hr) && rename(pTempPath, pPath) != 0) {
+        hr = E_FAIL;
+    }
+    if (FAILED(hr)) {
+        unlink(pTempPath);
+    }
+    return hr;
+}
+
+#endif /* __DXC_UTIL_C__ */
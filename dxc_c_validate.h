@@ -0,0 +1,602 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// dxc_c_validate.h                                                          //
+// Pipelined codegen and IDxcValidator2 validation with a validated-hash set //
+//                                                                           //
+// Copyright (c) 2026 Jack Henrikson                                         //
+//                                                                           //
+// This file is licensed under the MIT License.                              //
+// See the LICENSE file for details.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DXC_VALIDATE_C__
+#define __DXC_VALIDATE_C__
+
+#include "dxc_c.h"
+#include "dxc_c_batch.h"
+#include "dxc_c_container.h"
+#include "dxc_c_hash.h"
+#include "dxc_c_util.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// NOTE: Requires POSIX threads. DxcValidatePipeline_Run compiles every job with
+// DXC_ARG_SKIP_VALIDATION on a pool of codegen threads and hands each
+// container to a separately sized pool of validation threads as soon as it is
+// produced, so validation of early shaders overlaps codegen of later ones.
+//
+// A validation thread re-serializes the container through
+// IDxcContainerBuilder into a private blob, validates it with
+// IDxcValidator2_Validate and DxcValidatorFlags_InPlaceEdit, which signs the
+// blob in place, and returns that blob as the final container.
+//
+// An optional DxcValidationSet remembers validated shaders by their
+// DXC_PART_SHADER_HASH digest. Because the shader hash only covers the
+// program, each entry also records a hash of the remaining container bytes
+// and the digest the validator signed them with. A container that matches
+// both is signed from the set without calling the validator; a container with
+// a known shader hash but different parts (for example another root
+// signature) is validated again. Sets are tied to the validator version and
+// can be saved to disk and reused across builds.
+
+#define DXC_VALIDATION_SET_MAGIC   DXC_FOURCC('D', 'X', 'V', 'S')
+#define DXC_VALIDATION_SET_VERSION 1
+
+// Bytes before this offset are the container FourCC and the signed digest
+#define DXC_VALIDATE_DIGEST_END 20
+
+// --- Structs ----------------------------------------------------------------
+typedef struct DxcValidationSetEntry {
+    BYTE    ShaderHash[16]; // DXC_PART_SHADER_HASH digest
+    DxcHash ContentHash;    // Container bytes after the digest
+    BYTE    Digest[16];     // Digest the validator signed the container with
+} DxcValidationSetEntry;
+
+typedef struct DxcValidationSetFileHeader {
+    UINT32 Magic;
+    UINT32 Version;
+    UINT32 EntryCount;
+    UINT32 Reserved;
+    UINT64 ValidatorVersion; // (Major << 32) | Minor
+} DxcValidationSetFileHeader;
+
+typedef struct DxcValidationSet {
+    DxcHashTable    Entries;          // DxcValidationSetEntry keyed by ShaderHash
+    UINT64          ValidatorVersion; // 0 until first used or loaded
+    pthread_mutex_t Lock;
+} DxcValidationSet;
+
+typedef struct DxcValidatePipelineDesc {
+    DxcCreateInstanceProc pfnCreateInstance;          // Compiler, utils and container builder
+    DxcCreateInstanceProc pfnValidatorCreateInstance; // NULL uses pfnCreateInstance
+    UINT32                CompileThreadCount;         // 0 uses the number of online CPUs
+    UINT32                ValidateThreadCount;        // 0 uses half the number of online CPUs
+    DxcValidationSet     *pValidationSet;             // Optional, consulted and extended by validation
+} DxcValidatePipelineDesc;
+
+typedef struct DxcValidateResult {
+    HRESULT           Status;            // First failure of compile call, compile, serialization or validation
+    IDxcResult       *pResult;           // Codegen result, its container is unsigned; release with IDxcResult_Release
+    IDxcBlob         *pContainer;        // Validated, signed container; NULL on failure
+    IDxcBlobEncoding *pValidationErrors; // Validator messages when the validator ran, may be NULL
+    BOOL              Skipped;           // Signed from the validation set without running the validator
+} DxcValidateResult;
+
+typedef struct DxcValidatePipelineStats {
+    UINT64 Compiles;
+    UINT64 Validations;         // Validator calls
+    UINT64 ValidationFailures;
+    UINT64 Skipped;             // Containers signed from the validation set
+    UINT64 CompileNanoseconds;  // Summed over codegen threads
+    UINT64 ValidateNanoseconds; // Summed over validation threads, including serialization
+} DxcValidatePipelineStats;
+
+typedef struct DxcValidatePipeline DxcValidatePipeline;
+
+typedef struct DxcValidateCompiler {
+    IDxcCompiler3      *pCompiler;
+    IDxcUtils          *pUtils;
+    IDxcIncludeHandler *pDefaultIncludeHandler;
+    pthread_t           Thread;
+    DxcValidatePipeline *pPipeline;
+} DxcValidateCompiler;
+
+typedef struct DxcValidateValidator {
+    IDxcValidator2      *pValidator;
+    pthread_t            Thread;
+    DxcValidatePipeline *pPipeline;
+} DxcValidateValidator;
+
+struct DxcValidatePipeline {
+    DxcCreateInstanceProc     pfnCreateInstance;
+    DxcValidateCompiler      *pCompilers;
+    UINT32                    CompilerCount;
+    DxcValidateValidator     *pValidators;
+    UINT32                    ValidatorCount;
+    DxcValidationSet         *pValidationSet;
+    UINT64                    ValidatorVersion;
+    const DxcBatchJob        *pJobs;
+    DxcValidateResult        *pResults;
+    UINT32                    JobCount;
+    atomic_uint               NextJob;
+    UINT32                   *pQueue;         // Compiled job indices awaiting validation
+    UINT32                    QueueHead;
+    UINT32                    QueueTail;
+    UINT32                    ActiveCompilers;
+    DxcValidatePipelineStats  Stats;
+    pthread_mutex_t           SubmitLock;     // Serializes DxcValidatePipeline_Run callers
+    pthread_mutex_t           Lock;           // Guards the queue, ActiveCompilers and Stats
+    pthread_cond_t            QueueCond;
+};
+
+// --- Internals --------------------------------------------------------------
+// Must be called with set->Lock held. Replaces the entry for the same shader hash.
+static inline HRESULT DxcValidationSet_InsertLocked(DxcValidationSet *set, const DxcValidationSetEntry *pEntry) {
+    void *existing = NULL;
+    HRESULT hr = DxcHashTable_Insert(&set->Entries, pEntry, &existing);
+    if (hr == S_FALSE) {
+        memcpy(existing, pEntry, sizeof(DxcValidationSetEntry));
+        hr = S_OK;
+    }
+    return hr;
+}
+
+// Must be called with set->Lock held. Entries signed by another validator
+// version are of no use, so a version change empties the set.
+static inline void DxcValidationSet_UseVersionLocked(DxcValidationSet *set, UINT64 validatorVersion) {
+    if (set->ValidatorVersion != validatorVersion) {
+        DxcHashTable_Clear(&set->Entries);
+        set->ValidatorVersion = validatorVersion;
+    }
+}
+
+static inline DxcHash DxcValidate_HashContent(const BYTE *pContainer, SIZE_T size) {
+    return DxcHash_Compute(pContainer + DXC_VALIDATE_DIGEST_END, size - DXC_VALIDATE_DIGEST_END, 0);
+}
+
+static inline void *DxcValidate_CompilerMain(void *arg) {
+    DxcValidateCompiler *compiler = (DxcValidateCompiler*)arg;
+    DxcValidatePipeline *pipeline = compiler->pPipeline;
+    LPCWSTR *arguments = NULL;
+    UINT32 argCapacity = 0;
+
+    for (;;) {
+        UINT32 jobIndex = atomic_fetch_add(&pipeline->NextJob, 1);
+        if (jobIndex >= pipeline->JobCount) {
+            break;
+        }
+
+        const DxcBatchJob *job = &pipeline->pJobs[jobIndex];
+        DxcValidateResult *result = &pipeline->pResults[jobIndex];
+        IDxcIncludeHandler *includeHandler = job->pIncludeHandler ? job->pIncludeHandler : compiler->pDefaultIncludeHandler;
+        HRESULT status = E_FAIL;
+
+        if (job->ArgCount + 1 > argCapacity) {
+            LPCWSTR *grown = (LPCWSTR*)realloc(arguments, (job->ArgCount + 1) * sizeof(LPCWSTR));
+            if (grown) {
+                arguments = grown;
+                argCapacity = job->ArgCount + 1;
+            }
+        }
+
+        UINT64 start = DxcUtil_Now();
+        if (job->ArgCount + 1 > argCapacity) {
+            result->Status = E_OUTOFMEMORY;
+        } else {
+            if (job->ArgCount) {
+                memcpy(arguments, job->pArguments, job->ArgCount * sizeof(LPCWSTR));
+            }
+            arguments[job->ArgCount] = DXC_ARG_SKIP_VALIDATION;
+            result->Status = IDxcCompiler3_Compile(compiler->pCompiler, &job->Source, arguments, job->ArgCount + 1, includeHandler,
+                                                   &IID_IDxcResult, (void**)&result->pResult);
+        }
+        if (SUCCEEDED(result->Status)) { result->Status = IDxcResult_GetStatus(result->pResult, &status); }
+        if (SUCCEEDED(result->Status)) { result->Status = status; }
+        UINT64 elapsed = DxcUtil_Now() - start;
+
+        pthread_mutex_lock(&pipeline->Lock);
+        pipeline->Stats.Compiles++;
+        pipeline->Stats.CompileNanoseconds += elapsed;
+        if (SUCCEEDED(result->Status)) {
+            pipeline->pQueue[pipeline->QueueTail++] = jobIndex;
+            pthread_cond_signal(&pipeline->QueueCond);
+        }
+        pthread_mutex_unlock(&pipeline->Lock);
+    }
+
+    pthread_mutex_lock(&pipeline->Lock);
+    if (--pipeline->ActiveCompilers == 0) {
+        pthread_cond_broadcast(&pipeline->QueueCond);
+    }
+    pthread_mutex_unlock(&pipeline->Lock);
+
+    free(arguments);
+    return NULL;
+}
+
+// Produces the signed container for one compiled job
+static inline void DxcValidate_RunJob(DxcValidateValidator *validator, DxcValidateResult *result) {
+    DxcValidatePipeline *pipeline = validator->pPipeline;
+    DxcValidationSet *set = pipeline->pValidationSet;
+    IDxcBlob *object = NULL;
+    IDxcContainerBuilder *builder = NULL;
+    IDxcOperationResult *serialized = NULL;
+    IDxcOperationResult *validated = NULL;
+    IDxcBlob *container = NULL;
+    HRESULT status = E_FAIL;
+
+    HRESULT hr = IDxcResult_GetOutput(result->pResult, DXC_OUT_OBJECT, &IID_IDxcBlob, (void**)&object, NULL);
+    if (SUCCEEDED(hr) && !object) { hr = E_FAIL; }
+
+    // The builder hands back a blob nobody else references, which the
+    // validator may then sign in place
+    if (SUCCEEDED(hr)) { hr = pipeline->pfnCreateInstance(&CLSID_DxcContainerBuilder, &IID_IDxcContainerBuilder, (LPVOID*)&builder); }
+    if (SUCCEEDED(hr)) { hr = IDxcContainerBuilder_Load(builder, object); }
+    if (SUCCEEDED(hr)) { hr = IDxcContainerBuilder_SerializeContainer(builder, &serialized); }
+    if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetStatus(serialized, &status); }
+    if (SUCCEEDED(hr)) { hr = status; }
+    if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetResult(serialized, &container); }
+    if (SUCCEEDED(hr) && (!container || IDxcBlob_GetBufferSize(container) < sizeof(DxcContainerHeader))) { hr = E_FAIL; }
+
+    DxcContainerView view;
+    DxcShaderHash shaderHash;
+    DxcValidationSetEntry entry;
+    BOOL keyed = 0;
+    BOOL skipped = 0;
+    if (SUCCEEDED(hr)) {
+        BYTE *data = (BYTE*)IDxcBlob_GetBufferPointer(container);
+        SIZE_T size = IDxcBlob_GetBufferSize(container);
+        keyed = set && SUCCEEDED(DxcContainer_Parse(data, size, &view)) && DxcContainer_GetShaderHash(&view, &shaderHash);
+
+        if (keyed) {
+            memcpy(entry.ShaderHash, shaderHash.HashDigest, 16);
+            entry.ContentHash = DxcValidate_HashContent(data, size);
+
+            pthread_mutex_lock(&set->Lock);
+            DxcValidationSet_UseVersionLocked(set, pipeline->ValidatorVersion);
+            const DxcValidationSetEntry *known = (const DxcValidationSetEntry*)DxcHashTable_Find(&set->Entries, entry.ShaderHash);
+            if (known && DxcHash_Equal(&known->ContentHash, &entry.ContentHash)) {
+                memcpy(data + 4, known->Digest, 16);
+                skipped = 1;
+            }
+            pthread_mutex_unlock(&set->Lock);
+        }
+    }
+
+    if (SUCCEEDED(hr) && !skipped) {
+        hr = IDxcValidator2_Validate(validator->pValidator, container, DxcValidatorFlags_InPlaceEdit, &validated);
+        if (SUCCEEDED(hr)) { hr = IDxcOperationResult_GetStatus(validated, &status); }
+        if (SUCCEEDED(hr)) {
+            IDxcOperationResult_GetErrorBuffer(validated, &result->pValidationErrors);
+            hr = status;
+        }
+
+        if (keyed && SUCCEEDED(hr)) {
+            memcpy(entry.Digest, (const BYTE*)IDxcBlob_GetBufferPointer(container) + 4, 16);
+            pthread_mutex_lock(&set->Lock);
+            DxcValidationSet_UseVersionLocked(set, pipeline->ValidatorVersion);
+            DxcValidationSet_InsertLocked(set, &entry); // A failed insert only costs a future validation
+            pthread_mutex_unlock(&set->Lock);
+        }
+    }
+
+    result->Status = hr;
+    result->Skipped = skipped;
+    if (SUCCEEDED(hr)) {
+        result->pContainer = container;
+        container = NULL;
+    }
+
+    pthread_mutex_lock(&pipeline->Lock);
+    pipeline->Stats.Validations += !skipped && validated;
+    pipeline->Stats.ValidationFailures += !skipped && validated && FAILED(hr);
+    pipeline->Stats.Skipped += skipped;
+    pthread_mutex_unlock(&pipeline->Lock);
+
+    if (container)  { IDxcBlob_Release(container); }
+    if (validated)  { IDxcOperationResult_Release(validated); }
+    if (serialized) { IDxcOperationResult_Release(serialized); }
+    if (builder)    { IDxcContainerBuilder_Release(builder); }
+    if (object)     { IDxcBlob_Release(object); }
+}
+
+static inline void *DxcValidate_ValidatorMain(void *arg) {
+    DxcValidateValidator *validator = (DxcValidateValidator*)arg;
+    DxcValidatePipeline *pipeline = validator->pPipeline;
+
+    pthread_mutex_lock(&pipeline->Lock);
+    for (;;) {
+        while (pipeline->QueueHead == pipeline->QueueTail && pipeline->ActiveCompilers > 0) {
+            pthread_cond_wait(&pipeline->QueueCond, &pipeline->Lock);
+        }
+        if (pipeline->QueueHead == pipeline->QueueTail) {
+            break;
+        }
+        UINT32 jobIndex = pipeline->pQueue[pipeline->QueueHead++];
+        pthread_mutex_unlock(&pipeline->Lock);
+
+        UINT64 start = DxcUtil_Now();
+        DxcValidate_RunJob(validator, &pipeline->pResults[jobIndex]);
+        UINT64 elapsed = DxcUtil_Now() - start;
+
+        pthread_mutex_lock(&pipeline->Lock);
+        pipeline->Stats.ValidateNanoseconds += elapsed;
+    }
+    pthread_mutex_unlock(&pipeline->Lock);
+
+    return NULL;
+}
+
+// --- Methods ----------------------------------------------------------------
+static inline HRESULT DxcValidationSet_Create(DxcValidationSet **ppSet) {
+    if (!ppSet) {
+        return E_INVALIDARG;
+    }
+
+    *ppSet = (DxcValidationSet*)calloc(1, sizeof(DxcValidationSet));
+    if (!*ppSet) {
+        return E_OUTOFMEMORY;
+    }
+    DxcHashTable_Init(&(*ppSet)->Entries, sizeof(DxcValidationSetEntry));
+    pthread_mutex_init(&(*ppSet)->Lock, NULL);
+    return S_OK;
+}
+
+static inline void DxcValidationSet_Destroy(DxcValidationSet *set) {
+    if (!set) {
+        return;
+    }
+    pthread_mutex_destroy(&set->Lock);
+    DxcHashTable_Destroy(&set->Entries);
+    free(set);
+}
+
+static inline UINT32 DxcValidationSet_GetCount(DxcValidationSet *set) {
+    pthread_mutex_lock(&set->Lock);
+    UINT32 count = set->Entries.EntryCount;
+    pthread_mutex_unlock(&set->Lock);
+    return count;
+}
+
+// Creates a set from a file written by DxcValidationSet_Save. A missing file
+// yields an empty set and S_FALSE; a damaged or foreign file fails.
+static inline HRESULT DxcValidationSet_Load(const char *pPath, DxcValidationSet **ppSet) {
+    if (!pPath || !ppSet) {
+        return E_INVALIDARG;
+    }
+
+    HRESULT hr = DxcValidationSet_Create(ppSet);
+    FILE *file = SUCCEEDED(hr) ? fopen(pPath, "rb") : NULL;
+    if (FAILED(hr) || !file) {
+        return FAILED(hr) ? hr : S_FALSE;
+    }
+
+    DxcValidationSet *set = *ppSet;
+    DxcValidationSetFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.Magic != DXC_VALIDATION_SET_MAGIC ||
+        header.Version != DXC_VALIDATION_SET_VERSION) {
+        hr = E_FAIL;
+    }
+
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < header.EntryCount; ++i) {
+        DxcValidationSetEntry entry;
+        hr = fread(&entry, sizeof(entry), 1, file) == 1 ? DxcValidationSet_InsertLocked(set, &entry) : E_FAIL;
+    }
+    fclose(file);
+
+    if (FAILED(hr)) {
+        DxcValidationSet_Destroy(set);
+        *ppSet = NULL;
+        return hr;
+    }
+
+    set->ValidatorVersion = header.ValidatorVersion;
+    return S_OK;
+}
+
+// Writes the set through a temporary file and an atomic rename
+static inline HRESULT DxcValidationSet_Save(DxcValidationSet *set, const char *pPath) {
+    if (!set || !pPath) {
+        return E_INVALIDARG;
+    }
+
+    char tempPath[4096];
+    FILE *file = DxcUtil_CreateTemp(pPath, tempPath, sizeof(tempPath));
+    if (!file) {
+        return E_FAIL;
+    }
+
+    pthread_mutex_lock(&set->Lock);
+    DxcValidationSetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = DXC_VALIDATION_SET_MAGIC;
+    header.Version = DXC_VALIDATION_SET_VERSION;
+    header.EntryCount = set->Entries.EntryCount;
+    header.ValidatorVersion = set->ValidatorVersion;
+    HRESULT hr = DxcUtil_WriteAll(file, &header, sizeof(header));
+    if (SUCCEEDED(hr)) {
+        hr = DxcUtil_WriteAll(file, set->Entries.pEntries, (SIZE_T)set->Entries.EntryCount * sizeof(DxcValidationSetEntry));
+    }
+    pthread_mutex_unlock(&set->Lock);
+
+    return DxcUtil_FinishTemp(file, tempPath, pPath, hr);
+}
+
+static inline void DxcValidatePipeline_Destroy(DxcValidatePipeline *pipeline) {
+    if (!pipeline) {
+        return;
+    }
+
+    for (UINT32 i = 0; i < pipeline->CompilerCount; ++i) {
+        DxcValidateCompiler *compiler = &pipeline->pCompilers[i];
+        if (compiler->pDefaultIncludeHandler) { IDxcIncludeHandler_Release(compiler->pDefaultIncludeHandler); }
+        if (compiler->pUtils)                 { IDxcUtils_Release(compiler->pUtils); }
+        if (compiler->pCompiler)              { IDxcCompiler3_Release(compiler->pCompiler); }
+    }
+    for (UINT32 i = 0; i < pipeline->ValidatorCount; ++i) {
+        if (pipeline->pValidators[i].pValidator) {
+            IDxcValidator2_Release(pipeline->pValidators[i].pValidator);
+        }
+    }
+
+    pthread_cond_destroy(&pipeline->QueueCond);
+    pthread_mutex_destroy(&pipeline->Lock);
+    pthread_mutex_destroy(&pipeline->SubmitLock);
+    free(pipeline->pValidators);
+    free(pipeline->pCompilers);
+    free(pipeline);
+}
+
+static inline HRESULT DxcValidatePipeline_Create(const DxcValidatePipelineDesc *pDesc, DxcValidatePipeline **ppPipeline) {
+    if (!pDesc || !pDesc->pfnCreateInstance || !ppPipeline) {
+        return E_INVALIDARG;
+    }
+
+    *ppPipeline = NULL;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    UINT32 compilerCount = pDesc->CompileThreadCount ? pDesc->CompileThreadCount : (cpus > 0 ? (UINT32)cpus : 1);
+    UINT32 validatorCount = pDesc->ValidateThreadCount ? pDesc->ValidateThreadCount : (cpus > 1 ? (UINT32)cpus / 2 : 1);
+    DxcCreateInstanceProc pfnValidatorCreateInstance = pDesc->pfnValidatorCreateInstance ? pDesc->pfnValidatorCreateInstance
+                                                                                         : pDesc->pfnCreateInstance;
+
+    DxcValidatePipeline *pipeline = (DxcValidatePipeline*)calloc(1, sizeof(DxcValidatePipeline));
+    DxcValidateCompiler *compilers = (DxcValidateCompiler*)calloc(compilerCount, sizeof(DxcValidateCompiler));
+    DxcValidateValidator *validators = (DxcValidateValidator*)calloc(validatorCount, sizeof(DxcValidateValidator));
+    if (!pipeline || !compilers || !validators) {
+        free(validators);
+        free(compilers);
+        free(pipeline);
+        return E_OUTOFMEMORY;
+    }
+
+    pipeline->pfnCreateInstance = pDesc->pfnCreateInstance;
+    pipeline->pCompilers = compilers;
+    pipeline->CompilerCount = compilerCount;
+    pipeline->pValidators = validators;
+    pipeline->ValidatorCount = validatorCount;
+    pipeline->pValidationSet = pDesc->pValidationSet;
+    pthread_mutex_init(&pipeline->SubmitLock, NULL);
+    pthread_mutex_init(&pipeline->Lock, NULL);
+    pthread_cond_init(&pipeline->QueueCond, NULL);
+
+    HRESULT hr = S_OK;
+    for (UINT32 i = 0; i < compilerCount && SUCCEEDED(hr); ++i) {
+        DxcValidateCompiler *compiler = &compilers[i];
+        compiler->pPipeline = pipeline;
+        hr = pDesc->pfnCreateInstance(&CLSID_DxcCompiler, &IID_IDxcCompiler3, (LPVOID*)&compiler->pCompiler);
+        if (SUCCEEDED(hr)) { hr = pDesc->pfnCreateInstance(&CLSID_DxcUtils, &IID_IDxcUtils, (LPVOID*)&compiler->pUtils); }
+        if (SUCCEEDED(hr)) { hr = IDxcUtils_CreateDefaultIncludeHandler(compiler->pUtils, &compiler->pDefaultIncludeHandler); }
+    }
+    for (UINT32 i = 0; i < validatorCount && SUCCEEDED(hr); ++i) {
+        validators[i].pPipeline = pipeline;
+        hr = pfnValidatorCreateInstance(&CLSID_DxcValidator, &IID_IDxcValidator2, (LPVOID*)&validators[i].pValidator);
+    }
+
+    IDxcVersionInfo *versionInfo = NULL;
+    UINT32 major = 0;
+    UINT32 minor = 0;
+    if (SUCCEEDED(hr)) { hr = pfnValidatorCreateInstance(&CLSID_DxcValidator, &IID_IDxcVersionInfo, (LPVOID*)&versionInfo); }
+    if (SUCCEEDED(hr)) { hr = IDxcVersionInfo_GetVersion(versionInfo, &major, &minor); }
+    if (versionInfo) {
+        IDxcVersionInfo_Release(versionInfo);
+    }
+    pipeline->ValidatorVersion = ((UINT64)major << 32) | minor;
+
+    if (FAILED(hr)) {
+        DxcValidatePipeline_Destroy(pipeline);
+        return hr;
+    }
+
+    *ppPipeline = pipeline;
+    return S_OK;
+}
+
+// Compiles and validates pJobs[0..jobCount), writing pResults[i] for
+// pJobs[i]. Blocks until every job has been validated. Per-job failures are
+// reported through pResults; the return value only covers invalid arguments
+// and thread creation.
+static inline HRESULT DxcValidatePipeline_Run(DxcValidatePipeline *pipeline, const DxcBatchJob *pJobs, UINT32 jobCount,
+                                              DxcValidateResult *pResults) {
+    if (!pipeline || (jobCount && (!pJobs || !pResults))) {
+        return E_INVALIDARG;
+    }
+    if (jobCount == 0) {
+        return S_OK;
+    }
+
+    UINT32 *queue = (UINT32*)malloc(jobCount * sizeof(UINT32));
+    if (!queue) {
+        return E_OUTOFMEMORY;
+    }
+    memset(pResults, 0, jobCount * sizeof(DxcValidateResult));
+
+    pthread_mutex_lock(&pipeline->SubmitLock);
+    pipeline->pJobs = pJobs;
+    pipeline->pResults = pResults;
+    pipeline->JobCount = jobCount;
+    pipeline->pQueue = queue;
+    pipeline->QueueHead = 0;
+    pipeline->QueueTail = 0;
+    atomic_store(&pipeline->NextJob, 0);
+
+    UINT32 compilers = pipeline->CompilerCount < jobCount ? pipeline->CompilerCount : jobCount;
+    UINT32 validators = pipeline->ValidatorCount < jobCount ? pipeline->ValidatorCount : jobCount;
+    pipeline->ActiveCompilers = compilers;
+
+    UINT32 startedCompilers = 0;
+    UINT32 startedValidators = 0;
+    for (; startedCompilers < compilers; ++startedCompilers) {
+        DxcValidateCompiler *compiler = &pipeline->pCompilers[startedCompilers];
+        if (pthread_create(&compiler->Thread, NULL, DxcValidate_CompilerMain, compiler) != 0) {
+            break;
+        }
+    }
+    if (startedCompilers < compilers) {
+        pthread_mutex_lock(&pipeline->Lock);
+        pipeline->ActiveCompilers -= compilers - startedCompilers;
+        pthread_cond_broadcast(&pipeline->QueueCond);
+        pthread_mutex_unlock(&pipeline->Lock);
+    }
+    for (; startedCompilers && startedValidators < validators; ++startedValidators) {
+        DxcValidateValidator *validator = &pipeline->pValidators[startedValidators];
+        if (pthread_create(&validator->Thread, NULL, DxcValidate_ValidatorMain, validator) != 0) {
+            break;
+        }
+    }
+
+    for (UINT32 i = 0; i < startedCompilers; ++i) {
+        pthread_join(pipeline->pCompilers[i].Thread, NULL);
+    }
+    if (startedCompilers && !startedValidators) {
+        DxcValidate_ValidatorMain(&pipeline->pValidators[0]); // Validate on the caller rather than drop the queue
+    }
+    for (UINT32 i = 0; i < startedValidators; ++i) {
+        pthread_join(pipeline->pValidators[i].Thread, NULL);
+    }
+
+    pipeline->pJobs = NULL;
+    pipeline->pResults = NULL;
+    pipeline->JobCount = 0;
+    pipeline->pQueue = NULL;
+    pthread_mutex_unlock(&pipeline->SubmitLock);
+
+    free(queue);
+    return startedCompilers ? S_OK : E_FAIL;
+}
+
+static inline DxcValidatePipelineStats DxcValidatePipeline_GetStats(DxcValidatePipeline *pipeline) {
+    pthread_mutex_lock(&pipeline->Lock);
+    DxcValidatePipelineStats stats = pipeline->Stats;
+    pthread_mutex_unlock(&pipeline->Lock);
+
+    return stats;
+}
+
+#endif /* __DXC_VALIDATE_C__ */